@@ -0,0 +1,371 @@
+#include <bots.hpp>
+#include <gameboard.hpp>
+#include <grid.hpp>
+#include <history.hpp>
+#include <packed_grid.hpp>
+#include <rules.hpp>
+#include <snapshot.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+using namespace smoothlife;
+
+// a sparse board of side x side cells, argument: side
+struct SparseGame
+{
+  Player player;
+  Log log{ config::log_length };
+  std::ranlux24 prng{ 42 };
+  SparseGameBoard<std::ranlux24> board;
+
+  explicit SparseGame(std::int64_t side)
+    : board{ prng, player, log, static_cast<std::size_t>(side), static_cast<std::size_t>(side) }
+  {
+    board.level = 20;
+    board.generate_level();
+  }
+};
+
+void report_memory(benchmark::State &state, const SparseGame &game)
+{
+  state.counters["tiles"] = static_cast<double>(game.board.state.allocated_tiles());
+  state.counters["kB"] = static_cast<double>(game.board.state.memory()) / 1024.0;
+}
+
+// cost of a level should not depend on the size of the board
+void BM_SparseGenerateLevel(benchmark::State &state)
+{
+  SparseGame game{ state.range(0) };
+  for (auto _ : state) {
+    game.board.generate_level();
+    benchmark::DoNotOptimize(game.player.surface);
+  }
+  state.SetItemsProcessed(state.iterations());
+  report_memory(state, game);
+}
+
+// a random walk with the rules applied, levels are left and generated anew on the way
+void random_walk(benchmark::State &state, Player &player, std::ranlux24 &prng)
+{
+  std::uniform_int_distribution<int> in_directions{ 0, 3 };
+  for (auto _ : state) {
+    player.energy = config::player_energy;
+    player.lives = config::player_lives;
+    benchmark::DoNotOptimize(player.move(static_cast<Direction>(in_directions(prng))));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// one keypress of the game: Player::move, the interaction with the field and the log events it posts
+void BM_Move(benchmark::State &state)
+{
+  Player player;
+  Log log{ config::log_length };
+  std::ranlux24 prng{ 42 };
+  GameBoard<config::board_width, config::board_height, std::ranlux24> board{ prng, player, log };
+  board.generate_level();
+  random_walk(state, player, prng);
+}
+
+// the same keypress on a board holding a field in a byte
+void BM_PackedMove(benchmark::State &state)
+{
+  Player player;
+  Log log{ config::log_length };
+  std::ranlux24 prng{ 42 };
+  PackedGameBoard<config::board_width, config::board_height, std::ranlux24> board{ prng, player, log };
+  board.generate_level();
+  random_walk(state, player, prng);
+}
+
+void BM_SparseMoves(benchmark::State &state)
+{
+  SparseGame game{ state.range(0) };
+  random_walk(state, game.player, game.prng);
+  report_memory(state, game);
+}
+
+// the autosave of every move, into a buffer that is reused like the autosaver's
+void BM_SaveSnapshot(benchmark::State &state)
+{
+  Player player;
+  Log log{ config::log_length };
+  std::ranlux24 prng{ 42 };
+  GameBoard<config::board_width, config::board_height, std::ranlux24> board{ prng, player, log };
+  board.generate_level();
+  std::vector<std::byte> bytes;
+  for (auto _ : state) {
+    save_snapshot(board, bytes);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(bytes.size()));
+}
+
+void BM_LoadSnapshot(benchmark::State &state)
+{
+  Player player;
+  Log log{ config::log_length };
+  std::ranlux24 prng{ 42 };
+  GameBoard<config::board_width, config::board_height, std::ranlux24> board{ prng, player, log };
+  board.generate_level();
+  const auto bytes = save_snapshot(board);
+  for (auto _ : state) {
+    load_snapshot(board, bytes);
+    benchmark::DoNotOptimize(player.surface);
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(bytes.size()));
+}
+
+// a turn of a bot looking one move ahead: branch(dir) tries every possible move and takes it back, then
+// play(dir) makes a random one, the player is kept alive
+template<class Branch, class Play>
+void look_ahead(benchmark::State &state, Player &player, Branch &&branch, Play &&play)
+{
+  std::minstd_rand walk{ 3 };
+  std::uniform_int_distribution<int> in_directions{ 0, 3 };
+  for (auto _ : state) {
+    for (const Direction dir : bots::directions) {
+      if (player.can_move(dir)) { branch(dir); }
+    }
+    player.energy = config::player_energy;
+    player.lives = config::player_lives;
+    play(static_cast<Direction>(in_directions(walk)));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+using Board = GameBoard<config::board_width, config::board_height, std::ranlux24>;
+
+// taking moves back without a history: the search copies everything a move may change and copies it back
+void BM_BranchCopy(benchmark::State &state)
+{
+  Player player;
+  Log log{ config::log_length };
+  std::ranlux24 prng{ 42 };
+  Board board{ prng, player, log };
+  board.generate_level();
+
+  struct Copy
+  {
+    Board::grid_type grid;
+    Player player;
+    int level = 0;
+    std::ranlux24 prng;
+    Log log{ config::log_length };
+  } copy;
+  look_ahead(
+    state,
+    player,
+    [&](Direction dir) {
+      copy.grid = board.state;
+      copy.player.x = player.x;
+      copy.player.y = player.y;
+      copy.player.surface = player.surface;
+      copy.player.score = player.score;
+      copy.player.steps = player.steps;
+      copy.player.energy = player.energy;
+      copy.player.lives = player.lives;
+      copy.level = board.level;
+      copy.prng = prng;
+      copy.log = log;
+      player.move(dir);
+      board.state = copy.grid;
+      player.x = copy.player.x;
+      player.y = copy.player.y;
+      player.surface = copy.player.surface;
+      player.score = copy.player.score;
+      player.steps = copy.player.steps;
+      player.energy = copy.player.energy;
+      player.lives = copy.player.lives;
+      board.level = copy.level;
+      prng = copy.prng;
+      log = copy.log;
+    },
+    [&](Direction dir) { player.move(dir); });
+}
+
+// the same with a snapshot, the copy of a game that works for every board
+void BM_BranchSnapshot(benchmark::State &state)
+{
+  Player player;
+  Log log{ config::log_length };
+  std::ranlux24 prng{ 42 };
+  Board board{ prng, player, log };
+  board.generate_level();
+  std::vector<std::byte> bytes;
+  look_ahead(
+    state,
+    player,
+    [&](Direction dir) {
+      save_snapshot(board, bytes);
+      player.move(dir);
+      load_snapshot(board, bytes);
+    },
+    [&](Direction dir) { player.move(dir); });
+}
+
+// moves recorded in a history, taken back by rewinding to the version before them
+template<class Game> void history_look_ahead(benchmark::State &state, Game &game)
+{
+  std::optional<BoardHistory<std::remove_reference_t<decltype(game.board)>>> history{ game.board };
+  look_ahead(
+    state,
+    game.player,
+    [&](Direction dir) {
+      const auto here = history->current();
+      history->move(dir);
+      history->rewind(here);
+    },
+    [&](Direction dir) {
+      history->amend();
+      history->move(dir);
+      // a game keeps its versions, a benchmark cannot keep them all
+      if (history->size() > 4096) { history.emplace(game.board); }
+    });
+}
+
+void BM_BranchHistory(benchmark::State &state)
+{
+  struct
+  {
+    Player player;
+    Log log{ config::log_length };
+    std::ranlux24 prng{ 42 };
+    Board board{ prng, player, log };
+  } game;
+  game.board.generate_level();
+  history_look_ahead(state, game);
+}
+
+void BM_SparseBranchSnapshot(benchmark::State &state)
+{
+  SparseGame game{ state.range(0) };
+  std::vector<std::byte> bytes;
+  look_ahead(
+    state,
+    game.player,
+    [&](Direction dir) {
+      save_snapshot(game.board, bytes);
+      game.player.move(dir);
+      load_snapshot(game.board, bytes);
+    },
+    [&](Direction dir) { game.player.move(dir); });
+}
+
+void BM_SparseBranchHistory(benchmark::State &state)
+{
+  SparseGame game{ state.range(0) };
+  history_look_ahead(state, game);
+}
+
+// one step back and forth in the versions of a long game, argument: the moves made before
+void BM_UndoRedo(benchmark::State &state)
+{
+  Player player;
+  Log log{ config::log_length };
+  std::ranlux24 prng{ 42 };
+  Board board{ prng, player, log };
+  board.generate_level();
+  BoardHistory<Board> history{ board };
+  std::minstd_rand walk{ 3 };
+  for (std::int64_t i = 0; i < state.range(0); ++i) {
+    player.energy = config::player_energy;
+    player.lives = config::player_lives;
+    history.amend();
+    history.move(bots::RandomBot{}(board, walk));
+  }
+  for (auto _ : state) {
+    history.undo();
+    history.redo();
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// the fields of a level 20 on a grid of the size
+template<class Grid> Grid level_grid()
+{
+  Grid grid;
+  std::ranlux24 prng{ 42 };
+  rules::generate_level<config::base>(
+    grid, 20, [&prng](auto lo, auto hi) { return std::uniform_int_distribution<decltype(lo)>{ lo, hi }(prng); });
+  return grid;
+}
+
+// what a bot or a search asks of a whole board: how many operations are left and which is the closest one,
+// field by field on a FixedGrid
+template<std::size_t Width, std::size_t Height> void BM_ScanOperations(benchmark::State &state)
+{
+  const auto grid = level_grid<FixedGrid<Width, Height>>();
+  for (auto _ : state) {
+    std::size_t count = 0;
+    std::size_t nearest = grid.size();
+    int best = static_cast<int>(Width + Height);
+    for (std::size_t i = 0; i < grid.size(); ++i) {
+      const Field::Type type = grid[i].type;
+      if (type == Field::Type::empty || type == Field::Type::exit) { continue; }
+      ++count;
+      const int steps = static_cast<int>(i % Width) + static_cast<int>(i / Width);
+      if (steps < best) {
+        best = steps;
+        nearest = i;
+      }
+    }
+    benchmark::DoNotOptimize(count);
+    benchmark::DoNotOptimize(nearest);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(grid.size()));
+  state.counters["bytes"] = sizeof(grid);
+}
+
+// the same answers from the masks of a PackedGrid, eight fields a word
+template<std::size_t Width, std::size_t Height> void BM_QueryOperations(benchmark::State &state)
+{
+  const auto grid = level_grid<PackedGrid<Width, Height>>();
+  for (auto _ : state) {
+    const auto operations = grid.operations();
+    std::size_t count = 0;
+    for (const std::uint64_t bits : operations) { count += static_cast<std::size_t>(std::popcount(bits)); }
+    benchmark::DoNotOptimize(count);
+    benchmark::DoNotOptimize(grid.nearest(0, 0, operations));
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(grid.size()));
+  state.counters["bytes"] = sizeof(grid);
+}
+
+void BM_PackedChecksum(benchmark::State &state)
+{
+  const auto grid = level_grid<PackedGrid<config::board_width, config::board_height>>();
+  for (auto _ : state) { benchmark::DoNotOptimize(grid.checksum()); }
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(sizeof(grid)));
+}
+
+}// namespace
+
+BENCHMARK(BM_SparseGenerateLevel)->Arg(64)->Arg(1000)->Arg(10000);
+BENCHMARK(BM_Move);
+BENCHMARK(BM_PackedMove);
+BENCHMARK(BM_SparseMoves)->Arg(64)->Arg(1000)->Arg(10000);
+BENCHMARK(BM_SaveSnapshot);
+BENCHMARK(BM_LoadSnapshot);
+BENCHMARK(BM_BranchCopy);
+BENCHMARK(BM_BranchSnapshot);
+BENCHMARK(BM_BranchHistory);
+BENCHMARK(BM_SparseBranchSnapshot)->Arg(64)->Arg(1000);
+BENCHMARK(BM_SparseBranchHistory)->Arg(64)->Arg(1000);
+BENCHMARK(BM_UndoRedo)->Arg(1000);
+BENCHMARK(BM_ScanOperations<config::board_width, config::board_height>);
+BENCHMARK(BM_QueryOperations<config::board_width, config::board_height>);
+BENCHMARK(BM_ScanOperations<32, 32>);
+BENCHMARK(BM_QueryOperations<32, 32>);
+BENCHMARK(BM_PackedChecksum);
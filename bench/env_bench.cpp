@@ -0,0 +1,63 @@
+#include <thread_pool.hpp>
+#include <vector_env.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+using namespace smoothlife;
+
+// random moves for every game, drawn before the loop so only the step is measured, argument: games
+std::vector<std::vector<std::uint8_t>> random_actions(std::size_t games)
+{
+  std::minstd_rand rnd{ 7 };
+  std::vector<std::vector<std::uint8_t>> batches(64, std::vector<std::uint8_t>(games));
+  for (auto &batch : batches) {
+    for (auto &action : batch) { action = static_cast<std::uint8_t>(rnd() % 4); }
+  }
+  return batches;
+}
+
+// one step of every game on this thread, items are env steps
+void BM_VectorEnvStep(benchmark::State &state)
+{
+  const auto games = static_cast<std::size_t>(state.range(0));
+  EnvOptions options;
+  options.tick_every = 4;
+  VectorEnv<> env{ games, options };
+  const auto batches = random_actions(games);
+  std::size_t batch = 0;
+  for (auto _ : state) {
+    env.step(batches[batch++ % batches.size()]);
+    benchmark::DoNotOptimize(env.rewards().data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// the same on a pool of every core, one chunk of games per worker
+void BM_VectorEnvStepPool(benchmark::State &state)
+{
+  const auto games = static_cast<std::size_t>(state.range(0));
+  EnvOptions options;
+  options.tick_every = 4;
+  VectorEnv<> env{ games, options };
+  ThreadPool pool;
+  const auto batches = random_actions(games);
+  std::size_t batch = 0;
+  for (auto _ : state) {
+    env.step(batches[batch++ % batches.size()], &pool);
+    benchmark::DoNotOptimize(env.rewards().data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["threads"] = static_cast<double>(pool.size());
+}
+
+}// namespace
+
+BENCHMARK(BM_VectorEnvStep)->Arg(64)->Arg(4096);
+BENCHMARK(BM_VectorEnvStepPool)->Arg(4096)->Arg(65536)->UseRealTime();
@@ -0,0 +1,101 @@
+#include <field.hpp>
+#include <log.hpp>
+#include <trace.hpp>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <utility>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+using namespace smoothlife;
+
+// operations the way generated levels hold them, with small surfaces so none of them overflows
+std::array<Field, 256> operations()
+{
+  std::mt19937 rnd{ 42 };
+  std::uniform_int_distribution<int> types{ static_cast<int>(Field::Type::add), static_cast<int>(Field::Type::div) };
+  std::uniform_int_distribution<int> values{ 1, config::base - 1 };
+  std::array<Field, 256> fields{};
+  for (auto &field : fields) { field = { static_cast<Field::Type>(types(rnd)), values(rnd) }; }
+  return fields;
+}
+
+// applies each operation and its inverse to the same surface, multiplying first keeps the division exact
+template<class Number> void run_apply(benchmark::State &state, Number surface, Log *log)
+{
+  const auto fields = operations();
+  std::size_t i = 0;
+  for (auto _ : state) {
+    Field field = fields[i++ % fields.size()];
+    Field inverse = field.inverse();
+    if (field.type == Field::Type::div) { std::swap(field, inverse); }
+    field.apply(surface, log);
+    inverse.apply(surface, log);
+    benchmark::DoNotOptimize(surface);
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// argument: 1 posts the events to a log like the game does, 0 applies silently like the solver
+void BM_FieldApply(benchmark::State &state)
+{
+  Log log{ config::log_length };
+  run_apply(state, 5000L, state.range(0) != 0 ? &log : nullptr);
+}
+
+// the player's surface the way the game applies to it, argument: the representation it is in
+void BM_FieldApplySurface(benchmark::State &state)
+{
+  Log log{ config::log_length };
+  Surface surface = 5000;
+  for (std::int64_t i = 0; i < state.range(0); ++i) { surface *= 1 << 30; }
+  state.SetLabel(surface.representation() == Surface::Representation::small  ? "long"
+                 : surface.representation() == Surface::Representation::wide ? "wide"
+                                                                              : "big");
+  run_apply(state, surface, &log);
+}
+
+void BM_FieldInverse(benchmark::State &state)
+{
+  const auto fields = operations();
+  std::size_t i = 0;
+  for (auto _ : state) { benchmark::DoNotOptimize(fields[i++ % fields.size()].inverse()); }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_LogPostEvent(benchmark::State &state)
+{
+  Log log{ config::log_length };
+  int score = 0;
+  for (auto _ : state) {
+    log.post_event(Log::Message::okay_polish, ++score, 10);
+    benchmark::DoNotOptimize(log);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// a span around a tiny piece of work, argument: 1 records it, 0 is the cost of tracing switched off
+void BM_TraceSpan(benchmark::State &state)
+{
+  if (state.range(0) != 0) { trace::start(); }
+  long work = 0;
+  for (auto _ : state) {
+    const trace::Span span{ "bench" };
+    benchmark::DoNotOptimize(++work);
+  }
+  trace::stop();
+  state.SetItemsProcessed(state.iterations());
+}
+
+}// namespace
+
+BENCHMARK(BM_FieldApply)->Arg(0)->Arg(1);
+// 0 keeps the surface a long, 2 and 5 multiplications by 2^30 make it wide and big
+BENCHMARK(BM_FieldApplySurface)->Arg(0)->Arg(2)->Arg(5);
+BENCHMARK(BM_FieldInverse);
+BENCHMARK(BM_LogPostEvent);
+BENCHMARK(BM_TraceSpan)->Arg(0)->Arg(1);
@@ -0,0 +1,147 @@
+#include <gameboard.hpp>
+#include <random.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+using namespace smoothlife;
+
+// generate_level() as it was before the constructive generator, it never returns once the chain outgrows the board
+template<std::size_t Width, std::size_t Height, class Prng>
+void legacy_generate_level(GameBoard<Width, Height, Prng> &board)
+{
+  using enum Field::Type;
+  using Grid = FixedGrid<Width, Height>;
+  using uni = std::uniform_int_distribution<int>;
+  uni in_board_width{ 0, Width - 1 };
+  uni in_board_height{ 0, Height - 1 };
+  uni in_field_types{ static_cast<int>(add), static_cast<int>(div) };
+  uni in_one_to_nine{ 1, config::base - 1 };
+  // start surfaces of that time
+  constexpr int surface_size = 100;
+  constexpr int max_surface_factor = 10000;
+
+  long surface;
+  do {
+    board.state.clear();
+
+    surface = in_one_to_nine(board.rnd)
+              * std::min(surface_size * static_cast<int>(std::pow(10, board.level / 2)), max_surface_factor);
+
+    std::array<bool, Width * Height> occupied{};
+    occupied.at(Grid::index(0, 0)) = true;
+    board.player.x = 0;
+    board.player.y = 0;
+    occupied.at(Grid::index(Width - 1, Height - 1)) = true;
+    board.set_field(Width - 1, Height - 1, { exit });
+
+    for (int i = 0; i < config::chain_length + board.level / 2; ++i) {
+      Field rnd_f;
+      rnd_f.type = static_cast<Field::Type>(in_field_types(board.rnd));
+      rnd_f.value = in_one_to_nine(board.rnd);
+
+      if (rnd_f.type == mul) {
+        long rem = surface % rnd_f.value;
+        while (rem != 0) {
+          rnd_f.value = in_one_to_nine(board.rnd);
+          rem = surface % rnd_f.value;
+        }
+      }
+
+      int rnd_x, rnd_y;
+      do {
+        rnd_x = in_board_width(board.rnd);
+        rnd_y = in_board_height(board.rnd);
+      } while (occupied.at(Grid::index(rnd_x, rnd_y)));
+
+      board.set_field(rnd_x, rnd_y, rnd_f);
+      occupied.at(Grid::index(rnd_x, rnd_y)) = true;
+      rnd_f.inverse().apply(surface);
+    }
+  } while (roundness(surface) > 0);
+
+  board.player.surface = surface;
+}
+
+// times every single generation and reports the latency distribution next to the mean
+template<std::size_t Width, std::size_t Height, class Prng = std::ranlux24, class Generate>
+void run_generator(benchmark::State &state, Generate generate)
+{
+  Player player;
+  Log log{ config::log_length };
+  Prng prng;
+  seed_prng(prng, 1);
+  GameBoard<Width, Height, Prng> board{ prng, player, log };
+  board.level = static_cast<int>(state.range(0));
+
+  std::vector<double> latencies;
+  for (auto _ : state) {
+    const auto start = std::chrono::steady_clock::now();
+    generate(board);
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    latencies.push_back(elapsed.count());
+    benchmark::DoNotOptimize(player.surface);
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  const auto at = [&](double q) {
+    return latencies[static_cast<std::size_t>(q * static_cast<double>(latencies.size() - 1))];
+  };
+  state.counters["p50_ns"] = at(0.50);
+  state.counters["p99_ns"] = at(0.99);
+  state.counters["p999_ns"] = at(0.999);
+  state.counters["max_ns"] = latencies.back();
+}
+
+void BM_GenerateLevel(benchmark::State &state)
+{
+  run_generator<config::board_width, config::board_height>(state, [](auto &board) { board.generate_level(); });
+}
+
+void BM_GenerateLevelLegacy(benchmark::State &state)
+{
+  run_generator<config::board_width, config::board_height>(state, [](auto &board) { legacy_generate_level(board); });
+}
+
+void BM_GenerateLevel64x64(benchmark::State &state)
+{
+  run_generator<64, 64>(state, [](auto &board) { board.generate_level(); });
+}
+
+// the same levels drawn from another engine, the generator spends most of its time drawing
+template<class Prng> void BM_GenerateLevelWith(benchmark::State &state)
+{
+  run_generator<config::board_width, config::board_height, Prng>(state, [](auto &board) { board.generate_level(); });
+}
+
+// one draw of a value like the generator's
+template<class Prng> void BM_EngineDraw(benchmark::State &state)
+{
+  Prng prng;
+  seed_prng(prng, 1);
+  std::uniform_int_distribution<int> in_one_to_nine{ 1, 9 };
+  for (auto _ : state) { benchmark::DoNotOptimize(in_one_to_nine(prng)); }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}// namespace
+
+// argument: level, the default board is full from level 60 on, where the legacy generator never returns
+BENCHMARK(BM_GenerateLevel)->DenseRange(0, 50, 5)->Arg(60)->Arg(1000);
+BENCHMARK(BM_GenerateLevelLegacy)->Arg(0)->Arg(10)->Arg(30);
+BENCHMARK(BM_GenerateLevel64x64)->Arg(0)->Arg(100)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_GenerateLevelWith, Xoshiro256)->Arg(0)->Arg(30)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_GenerateLevelWith, Pcg32)->Arg(0)->Arg(30)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_GenerateLevelWith, Philox4x32)->Arg(0)->Arg(30)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_EngineDraw, std::ranlux24);
+BENCHMARK_TEMPLATE(BM_EngineDraw, std::mt19937);
+BENCHMARK_TEMPLATE(BM_EngineDraw, Xoshiro256);
+BENCHMARK_TEMPLATE(BM_EngineDraw, Pcg32);
+BENCHMARK_TEMPLATE(BM_EngineDraw, Philox4x32);
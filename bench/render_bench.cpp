@@ -0,0 +1,148 @@
+#include <gameboard.hpp>
+#include <ui.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+// counts heap allocations, for the allocations per frame
+#if defined(__GNUC__) && !defined(__clang__)
+// gcc does not know that these operators replace the default ones and takes free() for a mismatch
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace {
+std::atomic<std::size_t> allocations{ 0 };
+}// namespace
+
+// NOLINTNEXTLINE(cert-dcl54-cpp,hicpp-new-delete-operators,misc-new-delete-overloads)
+void *operator new(std::size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  // NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+  if (void *memory = std::malloc(size == 0 ? 1 : size)) { return memory; }
+  throw std::bad_alloc{};
+}
+
+// NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+void operator delete(void *memory) noexcept { std::free(memory); }
+
+// NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+void operator delete(void *memory, std::size_t /*size*/) noexcept { std::free(memory); }
+
+namespace {
+
+using namespace smoothlife;
+
+// a generated level with the player walking back and forth over the first row, boards can be too big for the stack
+template<std::size_t Width, std::size_t Height> struct Game
+{
+  Player player;
+  Log log{ config::log_length };
+  std::ranlux24 prng{ 42 };
+  GameBoard<Width, Height, std::ranlux24> board{ prng, player, log };
+
+  Game()
+  {
+    board.level = 6;
+    board.generate_level();
+  }
+
+  // moves the player like a keypress would, without any rules
+  void step()
+  {
+    player.x = player.x + 1 < static_cast<int>(Width) ? player.x + 1 : 0;
+  }
+};
+
+void report(benchmark::State &state, std::size_t allocated)
+{
+  state.counters["allocs/frame"] =
+    benchmark::Counter(static_cast<double>(allocated), benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations());
+}
+
+// every frame builds the whole board, as every frame did before BoardView
+template<std::size_t Width, std::size_t Height> void BM_RenderBoard(benchmark::State &state)
+{
+  auto game = std::make_unique<Game<Width, Height>>();
+  const std::size_t before = allocations.load();
+  for (auto _ : state) {
+    game->step();
+    benchmark::DoNotOptimize(render(game->board));
+  }
+  report(state, allocations.load() - before);
+}
+
+// a frame after a move, two cells changed
+template<std::size_t Width, std::size_t Height> void BM_BoardViewMove(benchmark::State &state)
+{
+  auto game = std::make_unique<Game<Width, Height>>();
+  BoardView view{ Width, Height };
+  benchmark::DoNotOptimize(view.render(game->board));
+  const std::size_t before = allocations.load();
+  for (auto _ : state) {
+    game->step();
+    benchmark::DoNotOptimize(view.render(game->board));
+  }
+  report(state, allocations.load() - before);
+}
+
+// a frame without changes, like the ones the energy timer causes
+template<std::size_t Width, std::size_t Height> void BM_BoardViewUnchanged(benchmark::State &state)
+{
+  auto game = std::make_unique<Game<Width, Height>>();
+  BoardView view{ Width, Height };
+  benchmark::DoNotOptimize(view.render(game->board));
+  const std::size_t before = allocations.load();
+  for (auto _ : state) { benchmark::DoNotOptimize(view.render(game->board)); }
+  report(state, allocations.load() - before);
+}
+
+// the game window on a sparse board of side x side cells, the player walks the first row and the view scrolls
+void BM_BoardViewScroll(benchmark::State &state)
+{
+  const auto side = static_cast<std::size_t>(state.range(0));
+  Player player;
+  Log log{ config::log_length };
+  std::ranlux24 prng{ 42 };
+  SparseGameBoard<std::ranlux24> board{ prng, player, log, side, side };
+  board.level = 6;
+  board.generate_level();
+
+  BoardView view{ config::viewport_width, config::viewport_height };
+  benchmark::DoNotOptimize(view.render(board));
+  const std::size_t before = allocations.load();
+  for (auto _ : state) {
+    player.x = player.x + 1 < static_cast<int>(side) ? player.x + 1 : 0;
+    benchmark::DoNotOptimize(view.render(board));
+  }
+  report(state, allocations.load() - before);
+}
+
+// the log panel of a full log, rebuilt by the game whenever an event was posted
+void BM_RenderLog(benchmark::State &state)
+{
+  Log log{ config::log_length };
+  for (int i = 0; i < static_cast<int>(config::log_length); ++i) {
+    log.post_event(Log::Message::fine_polish, 100 * i, 20);
+  }
+  const std::size_t before = allocations.load();
+  for (auto _ : state) { benchmark::DoNotOptimize(render(log)); }
+  report(state, allocations.load() - before);
+}
+
+}// namespace
+
+BENCHMARK_TEMPLATE(BM_RenderBoard, config::board_width, config::board_height);
+BENCHMARK_TEMPLATE(BM_BoardViewMove, config::board_width, config::board_height);
+BENCHMARK_TEMPLATE(BM_BoardViewUnchanged, config::board_width, config::board_height);
+BENCHMARK_TEMPLATE(BM_RenderBoard, 64, 64);
+BENCHMARK_TEMPLATE(BM_BoardViewMove, 64, 64);
+BENCHMARK_TEMPLATE(BM_BoardViewUnchanged, 64, 64);
+BENCHMARK(BM_BoardViewScroll)->Arg(64)->Arg(1000)->Arg(10000);
+BENCHMARK(BM_RenderLog);
@@ -0,0 +1,121 @@
+#include <util.hpp>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+// roundness as it was before the division free kernels, int places overflows beyond 10^9
+int legacy_roundness(long number)
+{
+  if (number == 0) { return 1; }
+
+  int roundness = 0;
+  int places = smoothlife::config::base;
+
+  while (true) {
+    if (number % places == 0) {
+      ++roundness;
+    } else {
+      break;
+    }
+    places *= smoothlife::config::base;
+  }
+
+  return roundness;
+}
+
+// surfaces as the game produces them, percent_round of them end in 1 to 5 zeros in the base
+template<int Base = smoothlife::config::base> std::vector<long> surfaces(std::int64_t percent_round)
+{
+  static constexpr std::size_t count = 4096;
+  std::mt19937_64 rnd{ 42 };
+  std::uniform_int_distribution<long> value{ -50000, 50000 };
+  std::uniform_int_distribution<int> zeros{ 1, 5 };
+  std::uniform_int_distribution<std::int64_t> percent{ 0, 99 };
+
+  std::vector<long> numbers(count);
+  for (auto &number : numbers) {
+    number = value(rnd);
+    if (percent(rnd) >= percent_round) {
+      // keep the last digit nonzero
+      if (number % Base == 0) { ++number; }
+      continue;
+    }
+    for (int i = zeros(rnd); i > 0; --i) { number *= Base; }
+  }
+  return numbers;
+}
+
+template<int Base = smoothlife::config::base, class Kernel> void run_scalar(benchmark::State &state, Kernel kernel)
+{
+  const auto numbers = surfaces<Base>(state.range(0));
+  std::vector<int> result(numbers.size());
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < numbers.size(); ++i) { result[i] = kernel(numbers[i]); }
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(numbers.size()));
+}
+
+void BM_RoundnessLegacy(benchmark::State &state) { run_scalar(state, legacy_roundness); }
+
+void BM_RoundnessScalar(benchmark::State &state)
+{
+  run_scalar(state, [](long number) { return smoothlife::roundness(number); });
+}
+
+void BM_RoundnessBatch(benchmark::State &state)
+{
+  const auto numbers = surfaces(state.range(0));
+  std::vector<int> result(numbers.size());
+  for (auto _ : state) {
+    smoothlife::roundness(numbers, result);
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(numbers.size()));
+}
+
+// the kernel compiled for one base, what with_base() dispatches to
+template<int Base> void BM_RoundnessInBase(benchmark::State &state)
+{
+  const auto numbers = surfaces<Base>(state.range(0));
+  std::vector<int> result(numbers.size());
+  for (auto _ : state) {
+    smoothlife::roundness<Base>(numbers, result);
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(numbers.size()));
+}
+
+// base 12 only known at runtime, a division per digit
+void BM_RoundnessRuntimeBase(benchmark::State &state)
+{
+  long base = 12;
+  benchmark::DoNotOptimize(base);
+  run_scalar<12>(state, [&base](long number) {
+    if (number == 0) { return 1; }
+    int zeros = 0;
+    for (; number % base == 0; number /= base) { ++zeros; }
+    return zeros;
+  });
+}
+
+}// namespace
+
+// argument: percentage of round numbers in the input
+BENCHMARK(BM_RoundnessLegacy)->Arg(0)->Arg(10)->Arg(50)->Arg(100);
+BENCHMARK(BM_RoundnessScalar)->Arg(0)->Arg(10)->Arg(50)->Arg(100);
+BENCHMARK(BM_RoundnessBatch)->Arg(0)->Arg(10)->Arg(50)->Arg(100);
+BENCHMARK_TEMPLATE(BM_RoundnessInBase, 2)->Arg(0)->Arg(10)->Arg(50)->Arg(100);
+BENCHMARK_TEMPLATE(BM_RoundnessInBase, 8)->Arg(0)->Arg(10)->Arg(50)->Arg(100);
+BENCHMARK_TEMPLATE(BM_RoundnessInBase, 10)->Arg(0)->Arg(10)->Arg(50)->Arg(100);
+BENCHMARK_TEMPLATE(BM_RoundnessInBase, 12)->Arg(0)->Arg(10)->Arg(50)->Arg(100);
+BENCHMARK_TEMPLATE(BM_RoundnessInBase, 16)->Arg(0)->Arg(10)->Arg(50)->Arg(100);
+BENCHMARK(BM_RoundnessRuntimeBase)->Arg(0)->Arg(10)->Arg(50)->Arg(100);
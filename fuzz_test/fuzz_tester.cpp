@@ -1,22 +1,150 @@
+#include <config.hpp>
+#include <field.hpp>
+#include <gameboard.hpp>
+#include <player.hpp>
+#include <random.hpp>
+#include <surface.hpp>
+#include <util.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <span>
+
 #include <fmt/format.h>
-#include <iterator>
-#include <utility>
 
-[[nodiscard]] auto sum_values(const uint8_t *Data, size_t Size)
+/*
+ * Plays the input as a game of the real rules, headless. An input is
+ *
+ *   bytes 0 to 7   seed of the random engine, little endian
+ *   byte 8         level the game starts at modulo 64, the board is full and the surface widest from there on
+ *   byte 9         base, an index into config::bases
+ *   every byte on  an event, its value modulo 5: the directions 0 to 3 like Direction and the replay events,
+ *                  4 an energy tick
+ *
+ * Missing header bytes count as zero. Any broken invariant aborts with a message, undefined behaviour of the
+ * surface arithmetic is caught by the sanitizers the fuzzer is built with.
+ */
+
+namespace {
+
+using namespace smoothlife;
+
+struct Input
 {
-  constexpr auto scale = 1000;
+  std::uint64_t seed = 0;
+  int level = 0;
+  int base = config::base;
+  std::span<const std::uint8_t> events;
+};
 
-  int value = 0;
-  for (std::size_t offset = 0; offset < Size; ++offset) {
-    value += static_cast<int>(*std::next(Data, static_cast<long>(offset))) * scale;
+Input parse(std::span<const std::uint8_t> data)
+{
+  static constexpr std::size_t header_size = 10;
+  static constexpr int max_level = 64;
+  std::array<std::uint8_t, header_size> header{};
+  const std::size_t used = std::min(data.size(), header_size);
+  std::copy_n(data.begin(), used, header.begin());
+
+  Input input;
+  for (std::size_t i = 0; i < 8; ++i) { input.seed |= std::uint64_t{ header.at(i) } << (8 * i); }
+  input.level = header[8] % max_level;
+  input.base = config::bases.at(header[9] % config::bases.size());
+  input.events = data.subspan(used);
+  return input;
+}
+
+void check(bool invariant, const char *what)
+{
+  if (!invariant) {
+    fmt::print(stderr, "broken invariant: {}\n", what);
+    std::abort();
   }
-  return value;
 }
 
-// Fuzzer that attempts to invoke undefined behavior for signed integer overflow
+// one game per base, reset in place for every input instead of constructed, so an input costs its moves only
+template<int Base> class Game
+{
+public:
+  void play(const Input &input)
+  {
+    seed_prng(prng, input.seed);
+    player.reset();
+    log.clear();
+    board.level = input.level;
+    board.stage = GameStage::game;
+    board.next_level();
+    check_level(true);
+
+    for (const std::uint8_t byte : input.events) {
+      if (board.stage != GameStage::game) { return; }
+      const int event = byte % 5;
+      if (event == 4) {
+        // the simulator's tick, the game is over once a move finds no energy left
+        if (player.energy > 0) { player.energy -= 1; }
+        continue;
+      }
+
+      const int energy = player.energy;
+      const int lives = player.lives;
+      const int level = board.level;
+      if (!player.move(static_cast<Direction>(event))) { continue; }
+
+      check(player.lives >= 0 && player.lives <= lives, "lives only go down");
+      check(player.lives > 0 || board.stage != GameStage::game, "the game ends with the last life");
+      check(player.energy >= 0 && player.energy <= energy - 1 + config::master_energy_gain,
+        "a move costs one energy and an exit gains at most a masterpiece");
+      check(player.energy > 0 || board.stage != GameStage::game, "the game ends without energy");
+      // only the exit puts up a new level, any other move changes the field under the player
+      if (board.stage == GameStage::game) { check_level(board.level != level || player.lives != lives); }
+    }
+  }
+
+private:
+  Player player;
+  Log log{ config::log_length };
+  Xoshiro256 prng;
+  GameBoard<config::board_width, config::board_height, Xoshiro256, Base> board{ prng, player, log };
+
+  // what every level has to keep until the player leaves it, the whole board only when it is new
+  void check_level(bool whole) const
+  {
+    const auto width = static_cast<int>(board.width());
+    const auto height = static_cast<int>(board.height());
+    check(player.x >= 0 && player.x < width && player.y >= 0 && player.y < height, "the player stays on the board");
+    check(board.get_field(width - 1, height - 1).type == Field::Type::exit, "the exit stays in its corner");
+    check(roundness<Base>(player.surface) >= 0, "the surface has a roundness");
+    if (!whole) {
+      check(board.get_field(player.x, player.y).type == Field::Type::empty, "operations are used up");
+      return;
+    }
+
+    int exits = 0;
+    board.for_each_field([&](int /*x*/, int /*y*/, const Field &field) {
+      if (field.type == Field::Type::exit) {
+        ++exits;
+      } else {
+        // a zero would divide by zero or lose the surface
+        check(field.value >= 1 && field.value < Base, "operations take a nonzero digit of the base");
+      }
+    });
+    check(exits == 1, "a level has one exit");
+  }
+};
+
+}// namespace
+
 // cppcheck-suppress unusedFunction symbolName=LLVMFuzzerTestOneInput
-extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size)
 {
-  fmt::print("Value sum: {}, len{}\n", sum_values(Data, Size), Size);
+  const Input input = parse({ data, size });
+  with_base(input.base, [&](auto base) {
+    static Game<decltype(base)::value> game;
+    game.play(input);
+  });
   return 0;
 }
@@ -0,0 +1,141 @@
+#ifndef SMOOTHLIFE_BOTS_HPP
+#define SMOOTHLIFE_BOTS_HPP
+
+#include "config.hpp"
+#include "field.hpp"
+#include "player.hpp"
+#include "util.hpp"
+
+#include <cstdlib>
+#include <limits>
+#include <string_view>
+
+namespace smoothlife::bots {
+
+/*
+ * Bot policies for headless games.
+ *
+ * A bot is called with the board and a randomness provider and returns the next direction.
+ * It must only return directions for which player.can_move() holds.
+ */
+
+static constexpr std::array<Direction, 4> directions{
+  Direction::up, Direction::left, Direction::down, Direction::right
+};
+
+[[nodiscard]] constexpr std::pair<int, int> step(int x, int y, Direction dir)
+{
+  switch (dir) {
+  case Direction::up:
+    return { x, y + 1 };
+  case Direction::left:
+    return { x - 1, y };
+  case Direction::down:
+    return { x, y - 1 };
+  case Direction::right:
+    return { x + 1, y };
+  }
+  return { x, y };
+}
+
+// picks any possible move
+struct RandomBot
+{
+  static constexpr std::string_view name = "random";
+
+  template<class Board, class Prng> Direction operator()(const Board &board, Prng &rnd) const
+  {
+    std::array<Direction, 4> possible{};
+    std::size_t count = 0;
+    for (Direction dir : directions) {
+      if (board.player.can_move(dir)) { possible.at(count++) = dir; }
+    }
+    return possible.at(std::uniform_int_distribution<std::size_t>{ 0, count - 1 }(rnd));
+  }
+};
+
+// walks the shortest way to the exit, ignoring everything on the way
+struct ExitBot
+{
+  static constexpr std::string_view name = "exit";
+
+  template<class Board, class Prng> Direction operator()(const Board &board, Prng & /*rnd*/) const
+  {
+    return board.player.can_move(Direction::right) ? Direction::right : Direction::up;
+  }
+};
+
+// collects the operation with the best immediate roundness gain and leaves as soon as the surface is round
+struct GreedyBot
+{
+  static constexpr std::string_view name = "greedy";
+
+  template<class Board, class Prng> Direction operator()(const Board &board, Prng &rnd) const
+  {
+    using enum Field::Type;
+    const Player &player = board.player;
+    const int current = roundness<Board::base>(player.surface);
+
+    // head for the exit once round, otherwise for the closest operation
+    auto [target_x, target_y] = find_exit(board);
+    bool operations_left = false;
+    if (current == 0) {
+      int best_distance = std::numeric_limits<int>::max();
+      board.for_each_field([&](int x, int y, const Field &field) {
+        const int distance = std::abs(x - player.x) + std::abs(y - player.y);
+        if (field.type != exit && distance < best_distance) {
+          operations_left = true;
+          best_distance = distance;
+          target_x = x;
+          target_y = y;
+        }
+      });
+    }
+
+    Direction best = Direction::up;
+    int best_value = std::numeric_limits<int>::min();
+    for (Direction dir : directions) {
+      if (!player.can_move(dir)) { continue; }
+
+      auto [x, y] = step(player.x, player.y, dir);
+      Field field = board.get_field(x, y);
+      int value = -4 * (std::abs(x - target_x) + std::abs(y - target_y));
+
+      if (field.type == exit) {
+        // a rough surface costs a life, only accept that when nothing is left to polish
+        value += current > 0 || !operations_left ? 1000 : -1000;
+      } else if (field.type != empty) {
+        Surface surface = player.surface;
+        field.apply<Board::base>(surface);
+        value += 8 * (roundness<Board::base>(surface) - current);
+      }
+
+      // break ties randomly so the bot does not get stuck oscillating
+      value = value * 4 + std::uniform_int_distribution<int>{ 0, 3 }(rnd);
+      if (value > best_value) {
+        best_value = value;
+        best = dir;
+      }
+    }
+    return best;
+  }
+
+private:
+  template<class Board> static std::pair<int, int> find_exit(const Board &board)
+  {
+    const Bounds &bounds = board.player.bounds;
+    std::pair<int, int> found{ bounds.x_max, bounds.y_max };
+    bool searching = true;
+    board.for_each_field([&](int x, int y, const Field &field) {
+      if (searching && field.type == Field::Type::exit) {
+        found = { x, y };
+        searching = false;
+      }
+    });
+    return found;
+  }
+};
+
+}// namespace smoothlife::bots
+
+#endif// SMOOTHLIFE_BOTS_HPP
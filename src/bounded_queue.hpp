@@ -0,0 +1,87 @@
+#ifndef SMOOTHLIFE_BOUNDED_QUEUE_HPP
+#define SMOOTHLIFE_BOUNDED_QUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace smoothlife {
+
+/**
+ * @brief first in first out queue between the threads of a pipeline, holding at most capacity items
+ *
+ * push() waits while the queue is full, so a fast stage cannot run ahead of a slow one and memory stays
+ * bounded. close() ends the stream: pushes fail from then on, pops return what is left and then nothing.
+ */
+template<class T> class BoundedQueue
+{
+public:
+  explicit BoundedQueue(std::size_t max_items) : capacity{ max_items }
+  {
+    if (capacity == 0) { throw std::invalid_argument("a queue needs room for at least one item"); }
+  }
+
+  // false if the queue was closed, the item is dropped then
+  bool push(T item)
+  {
+    {
+      std::unique_lock lock{ mutex };
+      not_full.wait(lock, [this] { return items.size() < capacity || closed; });
+      if (closed) { return false; }
+      items.push_back(std::move(item));
+    }
+    not_empty.notify_one();
+    return true;
+  }
+
+  // waits for the next item, nothing once the queue is closed and empty
+  std::optional<T> pop()
+  {
+    std::optional<T> item;
+    {
+      std::unique_lock lock{ mutex };
+      not_empty.wait(lock, [this] { return !items.empty() || closed; });
+      if (items.empty()) { return item; }
+      item = std::move(items.front());
+      items.pop_front();
+    }
+    not_full.notify_one();
+    return item;
+  }
+
+  void close()
+  {
+    {
+      const std::scoped_lock lock{ mutex };
+      closed = true;
+    }
+    not_full.notify_all();
+    not_empty.notify_all();
+  }
+
+  // drops every item still queued, for consumers that stop early
+  void clear()
+  {
+    {
+      const std::scoped_lock lock{ mutex };
+      items.clear();
+    }
+    not_full.notify_all();
+  }
+
+private:
+  std::size_t capacity;
+  std::mutex mutex;
+  std::condition_variable not_full;
+  std::condition_variable not_empty;
+  std::deque<T> items;
+  bool closed = false;
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_BOUNDED_QUEUE_HPP
@@ -0,0 +1,226 @@
+#ifndef SMOOTHLIFE_BUILTIN_LEVELS_HPP
+#define SMOOTHLIFE_BUILTIN_LEVELS_HPP
+
+#include "config.hpp"
+#include "field.hpp"
+#include "gameboard.hpp"
+#include "grid.hpp"
+#include "level_pack.hpp"
+#include "random.hpp"
+#include "roundness.hpp"
+#include "rules.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace smoothlife {
+
+/**
+ * @brief the level (seed, level), built in a constant expression
+ *
+ * Drawn like a pack record of the philox engine, the seed is the key and the level a stream of its own, but
+ * through uniform_int(), so it is not the record smoothlife_pack writes for the same seed and engine.
+ */
+template<std::size_t Width, std::size_t Height>
+constexpr LevelRecord<Width, Height> builtin_record(std::uint64_t seed, int level)
+{
+  Philox4x32 prng{ seed };
+  prng.seek(static_cast<std::uint32_t>(level));
+  FixedGrid<Width, Height> grid;
+
+  LevelRecord<Width, Height> record;
+  record.seed = seed;
+  record.level = level;
+  record.surface = rules::generate_level<config::base>(
+    grid, level, [&prng](auto lo, auto hi) { return uniform_int(prng, lo, hi); });
+  for (std::size_t i = 0; i < record.fields.size(); ++i) {
+    record.fields[i] = { static_cast<std::uint8_t>(grid[i].type), static_cast<std::uint8_t>(grid[i].value) };
+  }
+  return record;
+}
+
+namespace detail {
+
+  // steps of the shortest walks from the cell to every other one, walking over cells open is true for only,
+  // -1 for cells out of reach
+  template<std::size_t Width, std::size_t Height>
+  constexpr std::array<int, Width * Height> walk_lengths(std::size_t from, const std::array<bool, Width * Height> &open)
+  {
+    std::array<int, Width * Height> steps{};
+    std::array<std::size_t, Width * Height> queue{};
+    steps.fill(-1);
+    steps[from] = 0;
+    std::size_t head = 0;
+    std::size_t tail = 0;
+    queue[tail++] = from;
+    while (head < tail) {
+      const std::size_t cell = queue[head++];
+      // a field that is not open ends the walk on it
+      if (cell != from && !open[cell]) { continue; }
+      const std::size_t x = cell % Width;
+      const std::size_t y = cell / Width;
+      const std::array<bool, 4> has{ y + 1 < Height, x > 0, y > 0, x + 1 < Width };
+      const std::array<std::size_t, 4> next{ cell + Width, cell - 1, cell - Width, cell + 1 };
+      for (std::size_t d = 0; d < next.size(); ++d) {
+        if (has[d] && steps[next[d]] < 0) {
+          steps[next[d]] = steps[cell] + 1;
+          queue[tail++] = next[d];
+        }
+      }
+    }
+    return steps;
+  }
+
+  // true if the exit can be left with a round surface from the cell after the steps, taking the operations in any
+  // order: walking over one applies it, so the walks in between only cross empty cells and taken operations
+  template<std::size_t Width, std::size_t Height>
+  constexpr bool winnable_from(const LevelRecord<Width, Height> &record,
+    std::array<bool, Width * Height> &open,
+    std::size_t cell,
+    long surface,
+    int steps)
+  {
+    const std::size_t exit = Width * Height - 1;
+    const auto walks = walk_lengths<Width, Height>(cell, open);
+    // the exit is entered with energy left, a move taking the last one ends the game instead
+    if (walks[exit] >= 0 && steps + walks[exit] < config::player_energy && roundness<config::base>(surface) > 0) {
+      return true;
+    }
+
+    for (std::size_t next = 0; next < exit; ++next) {
+      if (open[next] || walks[next] < 0 || steps + walks[next] >= config::player_energy) { continue; }
+      Field field{ static_cast<Field::Type>(record.fields[next].type), record.fields[next].value };
+      // surfaces leaving a long widen in the game, no level needs them
+      if (!field.fits(surface)) { continue; }
+      long result = surface;
+      field.apply(result);
+      open[next] = true;
+      const bool won = winnable_from(record, open, next, result, steps + walks[next]);
+      open[next] = false;
+      if (won) { return true; }
+    }
+    return false;
+  }
+
+}// namespace detail
+
+/**
+ * @brief true if the record holds a level the rules could have built and a fresh player can win it
+ *
+ * The player's cell is empty, the exit is in the opposite corner, the operations are as many as the level has
+ * and the surface starts rough. Winning is an exhaustive search over the orders of taking operations, with the
+ * shortest walk in between, so it is meant for the short chains of the first levels.
+ */
+template<std::size_t Width, std::size_t Height> constexpr bool verify_level(const LevelRecord<Width, Height> &record)
+{
+  const std::size_t exit = Width * Height - 1;
+  std::array<bool, Width * Height> open{};
+  std::size_t operations = 0;
+  for (std::size_t i = 0; i < record.fields.size(); ++i) {
+    const auto type = static_cast<Field::Type>(record.fields[i].type);
+    const int value = record.fields[i].value;
+    if (type == Field::Type::empty) {
+      open[i] = true;
+    } else if (type == Field::Type::exit) {
+      if (i != exit) { return false; }
+    } else if (type > Field::Type::div || value < 1 || value >= config::base || i == 0) {
+      return false;
+    } else {
+      ++operations;
+    }
+  }
+  if (static_cast<Field::Type>(record.fields[exit].type) != Field::Type::exit
+      || operations != rules::chain_length(record.level, Width * Height)
+      || roundness<config::base>(record.surface) != 0) {
+    return false;
+  }
+  return detail::winnable_from(record, open, 0, record.surface, 0);
+}
+
+namespace detail {
+
+  // every record and its check are constant expressions of their own, all levels in one would run into the limits
+  // compilers put on the steps of a single one
+  template<std::size_t Width, std::size_t Height, std::uint64_t Seed, int Level>
+  inline constexpr LevelRecord<Width, Height> builtin_record_of = builtin_record<Width, Height>(Seed, Level);
+
+  template<const auto &Levels, std::size_t Index>
+  inline constexpr bool level_verified = verify_level(Levels.records[Index]);
+
+}// namespace detail
+
+/**
+ * @brief levels compiled into the game
+ *
+ * The records of the seeds [FirstSeed, FirstSeed + Seeds) and levels [0, Levels), seed major like a pack.
+ * They are built while compiling and a static_assert on levels_verified() keeps a broken one out of the binary,
+ * so playing them costs neither generation nor a file.
+ */
+template<std::size_t Width, std::size_t Height, std::uint64_t FirstSeed, std::size_t Seeds, std::size_t Levels>
+struct BuiltinLevels
+{
+  static constexpr std::uint64_t first_seed = FirstSeed;
+
+  std::array<LevelRecord<Width, Height>, Seeds * Levels> records =
+    []<std::size_t... Index>(std::index_sequence<Index...>) {
+      return std::array{ detail::builtin_record_of<Width,
+        Height,
+        FirstSeed + Index / Levels,
+        static_cast<int>(Index % Levels)>... };
+    }(std::make_index_sequence<Seeds * Levels>{});
+
+  static constexpr std::size_t seeds() { return Seeds; }
+
+  // record of (seed, level), nullptr if there is none
+  [[nodiscard]] constexpr const LevelRecord<Width, Height> *find(std::uint64_t seed, int level) const
+  {
+    if (seed - first_seed >= Seeds || level < 0 || static_cast<std::size_t>(level) >= Levels) { return nullptr; }
+    return &records[(seed - first_seed) * Levels + static_cast<std::size_t>(level)];
+  }
+};
+
+// true if verify_level() holds for every one of the built-in levels
+template<const auto &Levels> constexpr bool levels_verified()
+{
+  return []<std::size_t... Index>(std::index_sequence<Index...>) {
+    return (detail::level_verified<Levels, Index> && ...);
+  }(std::make_index_sequence<Levels.records.size()>{});
+}
+
+// the first levels of a game that shows the tutorial, the same in every game
+inline constexpr BuiltinLevels<config::board_width, config::board_height, 0x5475746f7269616cU, 1, 2> tutorial_levels{};
+static_assert(levels_verified<tutorial_levels>(), "a tutorial level cannot be won, pick another seed");
+
+// the first levels of the daily challenge, one seed for every day of the week
+inline constexpr BuiltinLevels<config::board_width, config::board_height, 0x4461696c79U, 7, 4> daily_levels{};
+static_assert(levels_verified<daily_levels>(), "a daily level cannot be won, pick another seed");
+
+// seed of the daily challenge of the day, the same for every player on that day in UTC
+inline std::uint64_t daily_seed(std::chrono::system_clock::time_point now = std::chrono::system_clock::now())
+{
+  const auto days = std::chrono::floor<std::chrono::days>(now).time_since_epoch().count();
+  return daily_levels.first_seed + static_cast<std::uint64_t>(days) % daily_levels.seeds();
+}
+
+/**
+ * @brief makes the board take its first levels from built-in ones
+ *
+ * Level n of the game is the record (seed, n), the levels after them are generated as usual.
+ */
+template<std::size_t Width, std::size_t Height, class Prng, class Levels>
+void use_builtin_levels(GameBoard<Width, Height, Prng> &board, const Levels &levels, std::uint64_t seed)
+{
+  board.load_level = [&board, &levels, seed] {
+    const auto *record = levels.find(seed, board.level);
+    if (record == nullptr) { return false; }
+    load_record(board, *record);
+    return true;
+  };
+}
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_BUILTIN_LEVELS_HPP
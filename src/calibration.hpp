@@ -0,0 +1,208 @@
+#ifndef SMOOTHLIFE_CALIBRATION_HPP
+#define SMOOTHLIFE_CALIBRATION_HPP
+
+#include "bounded_queue.hpp"
+#include "config.hpp"
+#include "gameboard.hpp"
+#include "level_pack.hpp"
+#include "player.hpp"
+#include "solver.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace smoothlife {
+
+// how hard a level is for a player starting it with full energy
+struct Difficulty
+{
+  // false if no way out leaves the surface round in time
+  bool solved = false;
+  // best roundness and steps of the optimal path
+  int roundness = 0;
+  int steps = 0;
+  // winning ways, counted up to config::counted_ways, see Solver::winning_ways()
+  std::size_t ways = 0;
+};
+
+// measures a generated level with the exact solver, throws std::length_error if it is too large to solve
+[[nodiscard]] inline Difficulty evaluate_difficulty(Solver::Level level, const std::atomic<bool> *stop = nullptr)
+{
+  Solver solver{ std::move(level) };
+  const Solution optimum = solver.solve(nullptr, { stop, {} });
+  if (!optimum.solved) { return {}; }
+  return { true, optimum.roundness, optimum.steps, solver.winning_ways(config::counted_ways) };
+}
+
+// the difficulties a level is accepted with, all bounds inclusive
+struct DifficultyBand
+{
+  int min_roundness = 1;
+  int min_steps = 0;
+  int max_steps = std::numeric_limits<int>::max();
+  std::size_t min_ways = 1;
+  std::size_t max_ways = std::numeric_limits<std::size_t>::max();
+
+  [[nodiscard]] bool contains(const Difficulty &difficulty) const
+  {
+    return difficulty.solved && difficulty.roundness >= min_roundness && difficulty.steps >= min_steps
+           && difficulty.steps <= max_steps && difficulty.ways >= min_ways && difficulty.ways <= max_ways;
+  }
+
+  /**
+   * @brief the band of a level of the game
+   *
+   * Every level can be finished with half the energy of a fresh player and allows at least a fine polish.
+   * The first levels are short and leave several ways to win, later ones take one more detour from the
+   * shortest way to the exit every four levels.
+   */
+  template<std::size_t Width, std::size_t Height> [[nodiscard]] static DifficultyBand for_level(int level)
+  {
+    static constexpr int shortest = static_cast<int>(Width + Height) - 2;
+
+    DifficultyBand band;
+    band.min_roundness = 2;
+    band.max_steps = config::player_energy / 2;
+    if (level < config::easy_levels) {
+      band.min_ways = config::easy_level_ways;
+      band.max_steps = shortest + config::easy_level_detour;
+    }
+    band.min_steps = std::min(shortest + std::max(level, 0) / 4, band.max_steps);
+    return band;
+  }
+};
+
+// a level accepted by the calibration, generate_record(board, record.seed, record.level) makes it again
+template<std::size_t Width, std::size_t Height> struct CalibratedLevel
+{
+  LevelRecord<Width, Height> record;
+  Difficulty difficulty;
+};
+
+template<std::size_t Width, std::size_t Height> struct Calibration
+{
+  std::vector<CalibratedLevel<Width, Height>> levels;
+  // seeds looked at until the last accepted one, levels.size() / candidates is the acceptance rate
+  std::uint64_t candidates = 0;
+};
+
+/**
+ * @brief generates levels for the seeds from first_seed on and keeps the first count inside the band
+ *
+ * A pipeline over all threads: generators draw candidate levels, evaluators solve them and the calling
+ * thread selects, each stage handing its results to the next over a bounded queue. Evaluation costs far
+ * more than generation, so most threads evaluate. Candidates are selected in seed order, the result does
+ * not depend on the threads. At most max_candidates seeds are tried, a band no level falls into ends
+ * there with fewer levels.
+ */
+template<std::size_t Width, std::size_t Height, class Prng = std::ranlux24>
+Calibration<Width, Height> calibrate_levels(int level,
+  std::uint64_t count,
+  std::uint64_t first_seed,
+  std::uint64_t max_candidates,
+  const DifficultyBand &band,
+  std::size_t threads = 0)
+{
+  struct Candidate
+  {
+    LevelRecord<Width, Height> record;
+    Solver::Level level;
+  };
+
+  if (threads == 0) { threads = std::max<std::size_t>(1, std::thread::hardware_concurrency()); }
+  const std::size_t generators = std::max<std::size_t>(1, threads / 4);
+  const std::size_t evaluators = std::max<std::size_t>(1, threads - generators);
+
+  // a few items per thread keep every stage busy without running far ahead
+  BoundedQueue<Candidate> generated{ 4 * threads };
+  BoundedQueue<CalibratedLevel<Width, Height>> evaluated{ 4 * threads };
+  std::atomic<std::uint64_t> next_candidate = 0;
+  std::atomic<std::size_t> generators_left = generators;
+  std::atomic<std::size_t> evaluators_left = evaluators;
+  std::atomic<bool> done = false;
+
+  Calibration<Width, Height> result;
+  {
+    std::vector<std::jthread> workers;
+    for (std::size_t i = 0; i < generators; ++i) {
+      workers.emplace_back([&] {
+        Player player;
+        Log log{ config::log_length };
+        Prng prng;
+        GameBoard<Width, Height, Prng> board{ prng, player, log };
+        for (std::uint64_t index = next_candidate++; index < max_candidates && !done; index = next_candidate++) {
+          player.reset();
+          Candidate candidate{ generate_record(board, first_seed + index, level), Solver::capture(board) };
+          if (!generated.push(std::move(candidate))) { break; }
+        }
+        if (--generators_left == 0) { generated.close(); }
+      });
+    }
+    for (std::size_t i = 0; i < evaluators; ++i) {
+      workers.emplace_back([&] {
+        while (auto candidate = generated.pop()) {
+          if (done) { break; }
+          Difficulty difficulty;
+          try {
+            difficulty = evaluate_difficulty(std::move(candidate->level), &done);
+          } catch (const std::length_error &) {
+            // too many operations to solve, such a level is rejected
+          }
+          if (!evaluated.push({ candidate->record, difficulty })) { break; }
+        }
+        if (--evaluators_left == 0) { evaluated.close(); }
+      });
+    }
+
+    // evaluators finish out of order, the selection waits for the next seed
+    std::map<std::uint64_t, CalibratedLevel<Width, Height>> waiting;
+    std::uint64_t next_seed = first_seed;
+    while (result.levels.size() < count) {
+      auto candidate = evaluated.pop();
+      if (!candidate) { break; }
+      waiting.emplace(candidate->record.seed, *candidate);
+      for (auto it = waiting.begin(); it != waiting.end() && it->first == next_seed; it = waiting.erase(it)) {
+        ++next_seed;
+        ++result.candidates;
+        if (band.contains(it->second.difficulty)) { result.levels.push_back(it->second); }
+        if (result.levels.size() == count) { break; }
+      }
+    }
+
+    // stops the other stages, solves still running return early
+    done = true;
+    generated.close();
+    evaluated.close();
+    generated.clear();
+    evaluated.clear();
+  }
+  return result;
+}
+
+// calibrates count levels of the game's board against the band of their level
+template<class Prng = std::ranlux24>
+Calibration<config::board_width, config::board_height>
+  calibrate_levels(int level, std::uint64_t count, std::uint64_t first_seed, std::size_t threads = 0)
+{
+  static constexpr std::uint64_t max_candidates_per_level = 1000;
+  if (count > std::numeric_limits<std::uint64_t>::max() / max_candidates_per_level) {
+    throw std::invalid_argument("too many levels to calibrate");
+  }
+  return calibrate_levels<config::board_width, config::board_height, Prng>(level,
+    count,
+    first_seed,
+    count * max_candidates_per_level,
+    DifficultyBand::for_level<config::board_width, config::board_height>(level),
+    threads);
+}
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_CALIBRATION_HPP
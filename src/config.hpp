@@ -2,28 +2,27 @@
 #define SMOOTHLIFE_CONFIG_HPP
 
 #include <array>
+#include <chrono>
+#include <cstddef>
 #include <deque>
+#include <functional>
 #include <random>
-#include <thread>
+#include <string>
 #include <utility>
 #include <vector>
 
-#include <ftxui/component/component.hpp>
-#include <ftxui/component/screen_interactive.hpp>
-#include <ftxui/dom/elements.hpp>
-
-#include <docopt/docopt.h>
-#include <spdlog/spdlog.h>
-
 namespace smoothlife::config {
 
 using namespace std::chrono_literals;
 
 // gameplay config
 static constexpr int base = 10;
+// every base the game can be played in, see with_base()
+static constexpr std::array bases{ 2, 8, 10, 12, 16 };
 static constexpr int chain_length = 3;
-static constexpr int surface_size = 100;
-static constexpr int max_surface_factor = 10000;
+// a level starts from a digit followed by this many zeros, one more every two levels up to the max
+static constexpr int surface_zeros = 2;
+static constexpr int max_surface_zeros = 4;
 static constexpr int min_win_score = 2000;
 static constexpr int player_lives = 5;
 static constexpr int player_energy = 100;
@@ -32,6 +31,12 @@ static constexpr int fine_energy_gain = 20;
 static constexpr int master_energy_gain = 30;
 static constexpr auto energy_decrement_time = 5s;
 
+// calibrated levels, see calibration.hpp: the first ones are short and can be won in several ways
+static constexpr std::size_t counted_ways = 16;
+static constexpr int easy_levels = 4;
+static constexpr std::size_t easy_level_ways = 3;
+static constexpr int easy_level_detour = 4;
+
 // ui config
 static constexpr std::size_t log_length = 4;
 
@@ -41,6 +46,10 @@ static constexpr std::size_t panel_height = 9;
 static constexpr std::size_t board_width = 7;
 static constexpr std::size_t board_height = 5;
 
+// largest part of a board shown at once, larger boards scroll
+static constexpr std::size_t viewport_width = 12;
+static constexpr std::size_t viewport_height = 7;
+
 }// namespace smoothlife::config
 
-#endif// SMOOTHLIFE_CONFIG_HPP
\ No newline at end of file
+#endif// SMOOTHLIFE_CONFIG_HPP
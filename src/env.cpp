@@ -0,0 +1,121 @@
+#include "smoothlife_env.h"
+#include "thread_pool.hpp"
+#include "vector_env.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace {
+
+using Env = smoothlife::VectorEnv<>;
+
+thread_local std::string last_error;
+
+// no exception may cross into C, every entry point runs through here
+template<class Fail, class Call> auto guarded(Fail fail, Call &&call) noexcept -> decltype(fail)
+{
+  try {
+    return call();
+  } catch (const std::exception &e) {
+    last_error = e.what();
+  } catch (...) {
+    last_error = "unknown error";
+  }
+  return fail;
+}
+
+}// namespace
+
+struct smoothlife_env
+{
+  Env env;
+  std::optional<smoothlife::ThreadPool> pool;
+
+  smoothlife_env(std::size_t count, const smoothlife::EnvOptions &options, std::uint32_t threads)
+    : env{ count, options }
+  {
+    if (threads != 1) { pool.emplace(threads); }
+  }
+};
+
+extern "C" {
+
+smoothlife_env_options smoothlife_env_default_options(void)
+{
+  const smoothlife::EnvOptions defaults;
+  return { defaults.first_seed, defaults.tick_every, defaults.max_moves, 1 };
+}
+
+smoothlife_env *smoothlife_env_create(uint32_t count, const smoothlife_env_options *options)
+{
+  return guarded(static_cast<smoothlife_env *>(nullptr), [&] {
+    const smoothlife_env_options chosen = options != nullptr ? *options : smoothlife_env_default_options();
+    smoothlife::EnvOptions env_options;
+    env_options.first_seed = chosen.first_seed;
+    env_options.tick_every = chosen.tick_every;
+    env_options.max_moves = chosen.max_moves;
+    return std::make_unique<smoothlife_env>(count, env_options, chosen.threads).release();
+  });
+}
+
+void smoothlife_env_destroy(smoothlife_env *env) { delete env; }
+
+uint32_t smoothlife_env_size(const smoothlife_env *env) { return static_cast<uint32_t>(env->env.size()); }
+
+uint32_t smoothlife_env_observation_size(void) { return static_cast<uint32_t>(Env::cells); }
+
+uint32_t smoothlife_env_width(void) { return static_cast<uint32_t>(Env::Grid::width()); }
+
+uint32_t smoothlife_env_height(void) { return static_cast<uint32_t>(Env::Grid::height()); }
+
+int smoothlife_env_step(smoothlife_env *env, const uint8_t *actions)
+{
+  return guarded(-1, [&] {
+    env->env.step(std::span{ actions, env->env.size() }, env->pool ? &*env->pool : nullptr);
+    return 0;
+  });
+}
+
+const uint8_t *smoothlife_env_observations(const smoothlife_env *env) { return env->env.observations().data(); }
+
+const float *smoothlife_env_rewards(const smoothlife_env *env) { return env->env.rewards().data(); }
+
+const uint8_t *smoothlife_env_dones(const smoothlife_env *env)
+{
+  // EnvStatus is a byte
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return reinterpret_cast<const uint8_t *>(env->env.dones().data());
+}
+
+const int32_t *smoothlife_env_state(const smoothlife_env *env, smoothlife_env_column column)
+{
+  switch (column) {
+  case SMOOTHLIFE_ENV_X:
+    return env->env.x().data();
+  case SMOOTHLIFE_ENV_Y:
+    return env->env.y().data();
+  case SMOOTHLIFE_ENV_ENERGY:
+    return env->env.energy().data();
+  case SMOOTHLIFE_ENV_LIVES:
+    return env->env.lives().data();
+  case SMOOTHLIFE_ENV_SCORE:
+    return env->env.scores().data();
+  case SMOOTHLIFE_ENV_LEVEL:
+    return env->env.levels().data();
+  case SMOOTHLIFE_ENV_STEPS:
+    return env->env.steps().data();
+  }
+  return nullptr;
+}
+
+const long *smoothlife_env_surfaces(const smoothlife_env *env) { return env->env.surfaces().data(); }
+
+const uint64_t *smoothlife_env_seeds(const smoothlife_env *env) { return env->env.seeds().data(); }
+
+const char *smoothlife_env_last_error(void) { return last_error.c_str(); }
+}
@@ -5,6 +5,8 @@
 #include "log.hpp"
 #include "util.hpp"
 
+#include <limits>
+
 namespace smoothlife {
 
 struct Field
@@ -15,7 +17,9 @@ struct Field
   Type type = empty;
   int value = 0;
 
-  [[nodiscard]] Field inverse() const
+  [[nodiscard]] bool operator==(const Field &) const = default;
+
+  [[nodiscard]] constexpr Field inverse() const
   {
     switch (type) {
     case add:
@@ -31,53 +35,68 @@ struct Field
     }
   }
 
-  void apply(long &surface, Log *log = nullptr)
+  // false if apply would overflow the surface or divide by zero
+  [[nodiscard]] constexpr bool fits(long surface) const
   {
-    int prev = 0;
-    int change = 0;
-
+    constexpr long max = std::numeric_limits<long>::max();
+    constexpr long min = std::numeric_limits<long>::min();
+    const long v = value;
+    const long magnitude = v < 0 ? -v : v;
     switch (type) {
     case add:
-      prev = roundness(surface);
+      return (v <= 0 || surface <= max - v) && (v >= 0 || surface >= min - v);
+    case sub:
+      return (v <= 0 || surface >= min + v) && (v >= 0 || surface <= max + v);
+    case mul:
+      return v == 0 || (surface <= max / magnitude && surface >= min / magnitude);
+    case div:
+      return v != 0 && (v != -1 || surface != min);
+    default:
+      return true;
+    }
+  }
+
+  // applies to a long, which needs fits() first, or to a Surface, which widens instead of overflowing,
+  // the log tells how the roundness in Base changed
+  template<int Base = config::base, class Number> constexpr void apply(Number &surface, Log *log = nullptr)
+  {
+    // the roundness is only needed for the log
+    const int prev = log != nullptr && type >= Type::add ? roundness<Base>(surface) : 0;
+
+    switch (type) {
+    case Type::add:
       surface += value;
-      change = roundness(surface) - prev;
-      if (log) { log->post_event("Add polishing paste."); }
+      if (log) { log->post_event(Log::Message::add_paste); }
       break;
-    case sub:
-      prev = roundness(surface);
+    case Type::sub:
       surface -= value;
-      change = roundness(surface) - prev;
-      if (log) { log->post_event("Remove burrs."); }
+      if (log) { log->post_event(Log::Message::remove_burrs); }
       break;
-    case mul:
-      prev = roundness(surface);
+    case Type::mul:
       surface *= value;
-      change = roundness(surface) - prev;
-      if (log) { log->post_event("Use finer sanding."); }
+      if (log) { log->post_event(Log::Message::finer_sanding); }
       break;
-    case div:
-      prev = roundness(surface);
+    case Type::div:
       surface /= value;
-      change = roundness(surface) - prev;
-      if (log) { log->post_event("Disassemble parts."); }
+      if (log) { log->post_event(Log::Message::disassemble); }
       break;
     default:
       return;
     }
 
     if (log) {
-      using enum Log::Type;
+      const int change = roundness<Base>(surface) - prev;
       if (change == 1) {
-        log->post_event("Nice, it's getting smooth!", good);
+        log->post_event(Log::Message::smoother);
       } else if (change > 1) {
-        log->post_event("Great, so smooth and shiny!", good);
+        log->post_event(Log::Message::smooth_and_shiny);
       } else if (change < -1) {
-        log->post_event("Damn, what a mess!", bad);
+        log->post_event(Log::Message::mess);
       }
     }
 
     // reset field if it was applied
-    type = empty;
+    type = Type::empty;
     value = 0;
   }
 };
@@ -3,28 +3,60 @@
 
 #include "config.hpp"
 #include "field.hpp"
+#include "grid.hpp"
 #include "log.hpp"
+#include "packed_grid.hpp"
 #include "player.hpp"
+#include "rules.hpp"
+#include "trace.hpp"
 #include "util.hpp"
 
-namespace smoothlife {
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-enum struct GameStage : int { intro = 1, tutorial_1 = 2, tutorial_2 = 3, game = 4, ending = 5 };
+namespace smoothlife {
 
-// Make GameStage incrementable
-GameStage &operator++(GameStage &stage)
+/**
+ * @brief what happens in a game, for whoever records it, see telemetry.hpp
+ *
+ * Every hook is optional and called from inside the rules by the thread that moves the player, under
+ * whatever guards the board.
+ */
+struct GameEvents
 {
-  using IntType = typename std::underlying_type<GameStage>::type;
-  if (stage != GameStage::ending) { stage = static_cast<GameStage>(static_cast<IntType>(stage) + 1); }
-  return stage;
-}
+  // a level is ready, the player starts it with the surface
+  std::function<void(int level, const Surface &surface)> level_started;
+  // the player entered a field of the type, the surface went from before to the player's
+  std::function<void(Field::Type type, const Surface &before)> moved;
+  // the player left level through the exit, score is 0 for a failed level, steps, energy and lives are still
+  // those of the player
+  std::function<void(int level, int roundness, int score)> level_finished;
+};
 
-template<std::size_t Width, std::size_t Height, class Prng> struct GameBoard
+/**
+ * @brief rules of the game on a grid of fields
+ *
+ * Grid is FixedGrid for the boards of the game, ChunkedGrid for boards sized at runtime, see grid.hpp, or
+ * PackedGrid for boards of the game in a byte per field, see packed_grid.hpp.
+ * Base is the base the surface is polished in, one of config::bases, every rule is compiled for it.
+ */
+template<class Grid, class Prng, int Base = config::base> struct BasicGameBoard
 {
   using enum Field::Type;
 
+  // false if the size of the board is chosen at runtime
+  static constexpr bool fixed_size = Grid::fixed_size;
+  static constexpr int base = Base;
+  using random_engine = Prng;
+  using grid_type = Grid;
+
   GameStage stage = GameStage::intro;
-  std::array<Field, Width * Height> state;
+  Grid state;
 
   Player &player;
   Prng &rnd;
@@ -32,176 +64,151 @@ template<std::size_t Width, std::size_t Height, class Prng> struct GameBoard
 
   int level = 0;
 
-  GameBoard(Prng &randomness_provider, Player &p, Log &l) : player{ p }, rnd{ randomness_provider }, log{ l }
+  // when set, the next level comes from here instead of generate_level(), returning false falls back to it
+  std::function<bool()> load_level;
+
+  // when set, generate_level() takes its level from here instead of building it, e.g. from a LevelPrefetcher
+  // that built it ahead: it has to leave state and rnd as build_level() would and return the surface
+  std::function<long()> level_source;
+
+  GameEvents events;
+
+  BasicGameBoard(Prng &randomness_provider, Player &p, Log &l)
+    requires std::is_default_constructible_v<Grid>
+    : player{ p }, rnd{ randomness_provider }, log{ l }
+  {
+    init();
+  }
+
+  BasicGameBoard(Prng &randomness_provider, Player &p, Log &l, std::size_t width, std::size_t height)
+    : state{ width, height }, player{ p }, rnd{ randomness_provider }, log{ l }
+  {
+    init();
+  }
+
+  // the interaction keeps a reference to the board
+  BasicGameBoard(const BasicGameBoard &) = delete;
+  BasicGameBoard(BasicGameBoard &&) = delete;
+  BasicGameBoard &operator=(const BasicGameBoard &) = delete;
+  BasicGameBoard &operator=(BasicGameBoard &&) = delete;
+  ~BasicGameBoard() = default;
+
+  [[nodiscard]] std::size_t width() const { return state.width(); }
+
+  [[nodiscard]] std::size_t height() const { return state.height(); }
+
+  void next_level()
+  {
+    if (!load_level || !load_level()) { generate_level(); }
+    if (events.level_started) { events.level_started(level, player.surface); }
+  }
+
+  // builds the next level, see rules::generate_level()
+  void generate_level()
+  {
+    const trace::Span span{ "generate_level" };
+    const long surface = level_source ? level_source() : build_level(state, rnd, level);
+    player.x = 0;
+    player.y = 0;
+    player.surface = surface;
+  }
+
+  // the level generate_level() builds on a board whose grid and engine are these, returns the surface
+  static long build_level(Grid &grid, Prng &prng, int level)
+  {
+    return rules::generate_level<Base>(grid, level, draw(prng));
+  }
+
+  // the next operation of the chain, see rules::random_operation()
+  Field random_operation(long surface, bool rough) { return rules::random_operation<Base>(surface, rough, draw(rnd)); }
+
+  void set_field(int x, int y, Field field) { state.set(x, y, field); }
+
+  // a reference into the grid, a copy for grids that hold no Field objects
+  [[nodiscard]] decltype(auto) get_field(int x, int y) const { return state.get(x, y); }
+
+  // calls visit(x, y, field) for every field that is not empty
+  template<class Visit> void for_each_field(Visit &&visit) const { state.for_each_field(std::forward<Visit>(visit)); }
+
+private:
+  // draws of the engine in the distributions the levels were always drawn with
+  static auto draw(Prng &prng)
   {
-    player.bounds.x_max = Width - 1;
+    return [&prng](auto lo, auto hi) { return std::uniform_int_distribution<decltype(lo)>{ lo, hi }(prng); };
+  }
+
+  // the interaction captures this board
+  void init()
+  {
+    player.bounds.x_max = static_cast<int>(width()) - 1;
     player.bounds.x_min = 0;
-    player.bounds.y_max = Height - 1;
+    player.bounds.y_max = static_cast<int>(height()) - 1;
     player.bounds.y_min = 0;
 
     player.interaction = [&] {
+      const trace::Span span{ "interaction" };
       if (player.energy == 0) {
         ++stage;
         return;
       }
 
-      Field &f = get_field(player.x, player.y);
+      Field f = get_field(player.x, player.y);
       ++player.steps;
 
       if (f.type == empty) {
+        if (events.moved) { events.moved(empty, player.surface); }
         return;
       } else if (f.type == exit) {
-        using enum Log::Type;
-        int r = roundness(player.surface);
-        int score = (r + level) * (config::player_energy - player.steps);
+        if (events.moved) { events.moved(exit, player.surface); }
+        const int finished = level;
+        const int r = roundness<Base>(player.surface);
+        const int score = rules::exit_score(r, level, player.steps);
         if (r == 0) {
-          log.post_event("You failed this time :(", bad);
-          if (--player.lives == 0) {
-            ++stage;
-            return;
-          }
-        } else if (r == 1) {
-          log.post_event(fmt::format("An okay polish. score +{}, energy +{}", score, config::ok_energy_gain), neutral);
-          player.energy += config::ok_energy_gain;
-          player.score += score;
-          ++level;
-        } else if (r == 2) {
-          log.post_event(
-            fmt::format("A really fine polish ^.^ score +{}, energy +{}", score, config::fine_energy_gain), good);
-          player.energy += config::fine_energy_gain;
-          player.score += score;
-          ++level;
-        } else if (r > 2) {
-          log.post_event(
-            fmt::format("Truly a masterpiece *.* score +{}, energy +{}", score, config::master_energy_gain), amazing);
-          player.energy += config::master_energy_gain;
+          log.post_event(Log::Message::failed);
+          --player.lives;
+        } else {
+          log.post_event(rules::exit_message(r), score, rules::energy_gain(r));
+          player.energy += rules::energy_gain(r);
           player.score += score;
           ++level;
         }
+        if (events.level_finished) { events.level_finished(finished, r, r == 0 ? 0 : score); }
+        if (player.lives == 0) {
+          ++stage;
+          return;
+        }
         player.steps = 0;
-        generate_level();
+        // a failed level is replaced by a fresh one, only reaching a new level takes it from load_level
+        if (r == 0) {
+          generate_level();
+          if (events.level_started) { events.level_started(level, player.surface); }
+        } else {
+          next_level();
+        }
+      } else if (events.moved) {
+        const Surface before = player.surface;
+        const Field::Type type = f.type;
+        f.apply<Base>(player.surface, &log);
+        set_field(player.x, player.y, f);
+        events.moved(type, before);
       } else {
-        f.apply(player.surface, &log);
+        f.apply<Base>(player.surface, &log);
+        set_field(player.x, player.y, f);
       }
     };
   }
+};
 
-  void generate_level()
-  {
-    using uni = std::uniform_int_distribution<int>;
-    uni in_board_width{ 0, Width - 1 };
-    uni in_board_height{ 0, Height - 1 };
-    uni in_field_types{ static_cast<int>(Field::Type::add), static_cast<int>(Field::Type::div) };
-    uni in_one_to_nine{ 1, config::base - 1 };
-
-    // generate a surface and operation chain until roundness is zero
-    long surface;
-    do {
-      // clear field
-      state = std::array<Field, Width * Height>{};
-
-      surface =
-        in_one_to_nine(rnd)
-        * std::min(config::surface_size * static_cast<int>(std::pow(10, level / 2)), config::max_surface_factor);
-
-      std::array<bool, Width * Height> occupied{};
-
-      // player
-      occupied.at(pack2d(0, 0)) = true;
-      player.x = 0;
-      player.y = 0;
-
-      // exit
-      occupied.at(pack2d(Width - 1, Height - 1)) = true;
-      set_field(Width - 1, Height - 1, { exit });
-
-      // generate field chain, increase length every two levels
-      for (int i = 0; i < config::chain_length + level / 2; ++i) {
-        // random operation field
-        Field rnd_f;
-
-        rnd_f.type = static_cast<Field::Type>(in_field_types(rnd));
-        rnd_f.value = in_one_to_nine(rnd);
-
-        // search for op to result in a whole number
-        if (rnd_f.type == mul) {
-          long rem = surface % rnd_f.value;
-          while (rem != 0) {
-            rnd_f.value = in_one_to_nine(rnd);
-            rem = surface % rnd_f.value;
-          }
-        }
-
-        // search for empty field
-        int rnd_x, rnd_y;
-        do {
-          rnd_x = in_board_width(rnd);
-          rnd_y = in_board_height(rnd);
-        } while (occupied.at(pack2d(rnd_x, rnd_y)));
-
-        // place operation field
-        set_field(rnd_x, rnd_y, rnd_f);
-        occupied.at(pack2d(rnd_x, rnd_y)) = true;
-
-        // make surface rough
-        rnd_f.inverse().apply(surface);
-      }
-    } while (roundness(surface) > 0);
-
-    player.surface = surface;
-  }
-
-  static size_t pack2d(int x, int y) { return static_cast<std::size_t>(x) + Width * static_cast<std::size_t>(y); }
-
-  void set_field(int x, int y, Field field) { state.at(pack2d(x, y)) = field; }
-
-  [[nodiscard]] const Field &get_field(int x, int y) const { return state.at(pack2d(x, y)); }
+// the boards of the game, sized at compile time
+template<std::size_t Width, std::size_t Height, class Prng, int Base = config::base>
+using GameBoard = BasicGameBoard<FixedGrid<Width, Height>, Prng, Base>;
 
-  [[nodiscard]] Field &get_field(int x, int y) { return state.at(pack2d(x, y)); }
+// boards of any size, storing only the parts holding fields
+template<class Prng, int Base = config::base> using SparseGameBoard = BasicGameBoard<ChunkedGrid, Prng, Base>;
 
-  [[nodiscard]] ftxui::Element render() const
-  {
-    using enum ftxui::Color::Palette16;
-    ftxui::Elements rows;
-
-    for (int y = Height - 1; y >= 0; --y) {
-      ftxui::Elements row;
-
-      for (int x = 0; x < static_cast<int>(Width); ++x) {
-        std::string repr = " ";
-        ftxui::Color color = White;
-        const Field &field = get_field(x, y);
-
-        if (field.type != empty && field.type != exit) {
-          repr = std::to_string(field.value);
-          switch (field.type) {
-          case add:
-            color = RedLight;
-            break;
-          case sub:
-            color = BlueLight;
-            break;
-          case mul:
-            color = GreenLight;
-            break;
-          case div:
-            color = YellowLight;
-            break;
-          default:
-            break;
-          }
-        } else if (field.type == exit) {
-          repr = "⋒";
-        }
-        if (x == player.x && y == player.y) { repr = "🯅"; }
-        row.push_back(ftxui::text(fmt::format(" {} ", repr)) | ftxui::border | ftxui::color(color));
-      }
-      rows.push_back(ftxui::hbox(std::move(row)));
-    }
-
-    return ftxui::vbox(std::move(rows));
-  }
-};
+// the boards of the game in a byte per field, for searches and batches that keep many of them
+template<std::size_t Width, std::size_t Height, class Prng, int Base = config::base>
+using PackedGameBoard = BasicGameBoard<PackedGrid<Width, Height>, Prng, Base>;
 
 }// namespace smoothlife
 
@@ -0,0 +1,232 @@
+#ifndef SMOOTHLIFE_GRID_HPP
+#define SMOOTHLIFE_GRID_HPP
+
+#include "field.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace smoothlife {
+
+/*
+ * Storage of the fields of a board.
+ *
+ * A grid has get(x, y), set(x, y, field), clear(), width(), height() and for_each_field(fn), which calls
+ * fn(x, y, field) for every field that is not empty. fixed_size tells if the size is part of the type.
+ */
+
+// all fields in one array, the size is fixed at compile time
+template<std::size_t Width, std::size_t Height> struct FixedGrid
+{
+  static constexpr bool fixed_size = true;
+
+  std::array<Field, Width * Height> fields{};
+
+  FixedGrid() = default;
+
+  // for code that sizes every kind of grid at runtime
+  FixedGrid(std::size_t width, std::size_t height)
+  {
+    if (width != Width || height != Height) { throw std::invalid_argument("the grid size is fixed"); }
+  }
+
+  static constexpr std::size_t index(int x, int y)
+  {
+    return static_cast<std::size_t>(x) + Width * static_cast<std::size_t>(y);
+  }
+
+  [[nodiscard]] static constexpr std::size_t width() { return Width; }
+
+  [[nodiscard]] static constexpr std::size_t height() { return Height; }
+
+  [[nodiscard]] constexpr const Field &get(int x, int y) const { return fields.at(index(x, y)); }
+
+  constexpr void set(int x, int y, Field field) { fields.at(index(x, y)) = field; }
+
+  constexpr void clear() { fields = {}; }
+
+  // row by row
+  template<class Visit> constexpr void for_each_field(Visit &&visit) const
+  {
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+      if (fields[i].type != Field::Type::empty) {
+        visit(static_cast<int>(i % Width), static_cast<int>(i / Width), fields[i]);
+      }
+    }
+  }
+
+  // the fields as one array, row by row
+  [[nodiscard]] constexpr auto begin() const { return fields.begin(); }
+  [[nodiscard]] constexpr auto end() const { return fields.end(); }
+  [[nodiscard]] static constexpr std::size_t size() { return Width * Height; }
+  [[nodiscard]] constexpr const Field &operator[](std::size_t i) const { return fields[i]; }
+  [[nodiscard]] constexpr Field &operator[](std::size_t i) { return fields[i]; }
+};
+
+/**
+ * @brief runtime sized grid that only stores the tiles holding fields
+ *
+ * The board is cut into tiles of 64x64 cells. A tile is allocated when a field is set on it and released
+ * when its last field is cleared, a lookup is a directory index and an offset. Released tiles are kept for
+ * reuse, so memory grows with the most tiles ever in use plus one pointer per tile of the whole board: a
+ * 10k x 10k board with a few fields costs about 200 kB and its tiles. Visiting and clearing only touch the
+ * tiles in use.
+ */
+class ChunkedGrid
+{
+public:
+  static constexpr bool fixed_size = false;
+  static constexpr int tile_bits = 6;
+  static constexpr int tile_size = 1 << tile_bits;
+
+  ChunkedGrid(std::size_t width, std::size_t height)
+    : grid_width{ width }, grid_height{ height }, tiles_x{ (width + tile_size - 1) / tile_size },
+      tiles((height + tile_size - 1) / tile_size * tiles_x)
+  {
+    if (width == 0 || height == 0) { throw std::invalid_argument("a grid needs at least one cell"); }
+    if (width > max_side || height > max_side) { throw std::invalid_argument("grid too large"); }
+  }
+
+  [[nodiscard]] std::size_t width() const { return grid_width; }
+
+  [[nodiscard]] std::size_t height() const { return grid_height; }
+
+  [[nodiscard]] const Field &get(int x, int y) const
+  {
+    check(x, y);
+    const Tile *tile = tiles[tile_index(x, y)].get();
+    return tile == nullptr ? empty_field : tile->fields[cell_index(x, y)];
+  }
+
+  void set(int x, int y, Field field)
+  {
+    check(x, y);
+    auto &tile = tiles[tile_index(x, y)];
+    const bool occupied = field.type != Field::Type::empty;
+    if (!tile) {
+      if (!occupied) { return; }
+      if (spare.empty()) {
+        tile = std::make_unique<Tile>();
+      } else {
+        tile = std::move(spare.back());
+        spare.pop_back();
+      }
+      tile->slot = in_use.size();
+      in_use.push_back(tile_index(x, y));
+    }
+
+    const std::size_t cell = cell_index(x, y);
+    std::uint64_t &row = tile->rows[cell >> tile_bits];
+    const std::uint64_t bit = std::uint64_t{ 1 } << (cell & (tile_size - 1));
+    if (occupied && (row & bit) == 0) {
+      row |= bit;
+      ++tile->count;
+    } else if (!occupied && (row & bit) != 0) {
+      row &= ~bit;
+      if (--tile->count == 0) {
+        // the last tile in use takes the place of this one
+        in_use[tile->slot] = in_use.back();
+        tiles[in_use.back()]->slot = tile->slot;
+        in_use.pop_back();
+        tile->fields[cell] = {};
+        spare.push_back(std::move(tile));
+        return;
+      }
+    }
+    tile->fields[cell] = field;
+  }
+
+  void clear()
+  {
+    for (const std::size_t t : in_use) {
+      // only the occupied cells need to be emptied for the tile to be reused
+      Tile &tile = *tiles[t];
+      for (std::size_t r = 0; r < tile.rows.size(); ++r) {
+        for (std::uint64_t row = tile.rows[r]; row != 0; row &= row - 1) {
+          tile.fields[(r << tile_bits) | static_cast<std::size_t>(std::countr_zero(row))] = {};
+        }
+        tile.rows[r] = 0;
+      }
+      tile.count = 0;
+      spare.push_back(std::move(tiles[t]));
+    }
+    in_use.clear();
+  }
+
+  // tile by tile, in them only the occupied cells
+  template<class Visit> void for_each_field(Visit &&visit) const
+  {
+    for (const std::size_t t : in_use) {
+      const Tile *tile = tiles[t].get();
+      const auto x0 = static_cast<int>(t % tiles_x) * tile_size;
+      const auto y0 = static_cast<int>(t / tiles_x) * tile_size;
+      for (std::size_t r = 0; r < tile->rows.size(); ++r) {
+        for (std::uint64_t row = tile->rows[r]; row != 0; row &= row - 1) {
+          const auto column = static_cast<std::size_t>(std::countr_zero(row));
+          visit(x0 + static_cast<int>(column), y0 + static_cast<int>(r), tile->fields[(r << tile_bits) | column]);
+        }
+      }
+    }
+  }
+
+  // tiles holding fields, the spare ones not counted
+  [[nodiscard]] std::size_t allocated_tiles() const { return in_use.size(); }
+
+  // heap memory in use, directory included
+  [[nodiscard]] std::size_t memory() const
+  {
+    return tiles.capacity() * sizeof(tiles[0]) + in_use.capacity() * sizeof(in_use[0])
+           + spare.capacity() * sizeof(spare[0]) + (in_use.size() + spare.size()) * sizeof(Tile);
+  }
+
+private:
+  // coordinates stay far from int overflow
+  static constexpr std::size_t max_side = std::size_t{ 1 } << 24U;
+
+  struct Tile
+  {
+    std::array<Field, tile_size * tile_size> fields{};
+    // bit x of row y is set if the field at x, y is not empty
+    std::array<std::uint64_t, tile_size> rows{};
+    int count = 0;
+    // position in in_use
+    std::size_t slot = 0;
+  };
+
+  static inline const Field empty_field{};
+
+  std::size_t grid_width;
+  std::size_t grid_height;
+  std::size_t tiles_x;
+  std::vector<std::unique_ptr<Tile>> tiles;
+  // directory indices of the allocated tiles
+  std::vector<std::size_t> in_use;
+  // empty tiles released earlier, the next level takes them instead of allocating and zeroing new ones
+  std::vector<std::unique_ptr<Tile>> spare;
+
+  void check(int x, int y) const
+  {
+    if (x < 0 || y < 0 || static_cast<std::size_t>(x) >= grid_width || static_cast<std::size_t>(y) >= grid_height) {
+      throw std::out_of_range("cell outside of the grid");
+    }
+  }
+
+  [[nodiscard]] std::size_t tile_index(int x, int y) const
+  {
+    return static_cast<std::size_t>(x >> tile_bits) + tiles_x * static_cast<std::size_t>(y >> tile_bits);
+  }
+
+  static std::size_t cell_index(int x, int y)
+  {
+    return static_cast<std::size_t>(x & (tile_size - 1)) | (static_cast<std::size_t>(y & (tile_size - 1)) << tile_bits);
+  }
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_GRID_HPP
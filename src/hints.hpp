@@ -0,0 +1,173 @@
+#ifndef SMOOTHLIFE_HINTS_HPP
+#define SMOOTHLIFE_HINTS_HPP
+
+#include "gameboard.hpp"
+#include "player.hpp"
+#include "solver.hpp"
+#include "trace.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace smoothlife {
+
+// the suggested next move for one position of a game
+struct Hint
+{
+  enum struct Status : std::uint8_t {
+    // nothing found yet
+    searching,
+    // the best move found so far, the search goes on
+    improving,
+    // the first move of an optimal path
+    optimal,
+    // every way out leaves the surface rough, or the level is too large to search
+    none
+  };
+
+  // of the position the hint belongs to, see HintEngine::update()
+  std::uint32_t revision = 0;
+  Status status = Status::searching;
+  std::uint8_t move = 0;
+
+  [[nodiscard]] Direction direction() const { return static_cast<Direction>(move); }
+
+  [[nodiscard]] bool operator==(const Hint &) const = default;
+};
+
+/**
+ * @brief suggests the next move of a running game from a background thread
+ *
+ * update() copies the level and hands it to the worker, a search still running on an older position stops at
+ * its next state. The worker runs the exact solver and publishes every better path as soon as it is found, so
+ * a first hint shows up after a few expansions and improves until it is optimal. Each one is a single atomic
+ * store followed by a call to notify, hint() is a single atomic load: neither side ever waits for the search.
+ * The mutex only guards the handover of a new position, which the worker holds for a move.
+ */
+class HintEngine
+{
+public:
+  // notify is called by the worker after every new hint, e.g. to wake up the ui
+  explicit HintEngine(std::function<void()> notify)
+    : published_hint{ std::move(notify) }, worker{ [this](const std::stop_token &stop) { work(stop); } }
+  {}
+
+  HintEngine(const HintEngine &) = delete;
+  HintEngine(HintEngine &&) = delete;
+  HintEngine &operator=(const HintEngine &) = delete;
+  HintEngine &operator=(HintEngine &&) = delete;
+
+  ~HintEngine()
+  {
+    cancelled = true;
+    worker.request_stop();
+  }
+
+  // starts over on the current position of the board, returns the revision its hints will carry
+  template<std::size_t Width, std::size_t Height, class Prng>
+  std::uint32_t update(const GameBoard<Width, Height, Prng> &board)
+  {
+    const std::uint32_t revision = requested.load(std::memory_order_relaxed) + 1;
+    std::optional<Solver::Level> level;
+    try {
+      level = Solver::capture(board);
+    } catch (const std::overflow_error &) {
+      // the solver works on longs, a surface that outgrew them gets no hint
+    }
+
+    {
+      const std::scoped_lock lock{ mutex };
+      pending = Request{ revision, std::move(level) };
+      requested.store(revision, std::memory_order_release);
+      cancelled = true;
+    }
+    wake.notify_one();
+    return revision;
+  }
+
+  // the newest hint for the position of the last update(), searching until the worker got to it
+  [[nodiscard]] Hint hint() const
+  {
+    const std::uint32_t revision = requested.load(std::memory_order_acquire);
+    const Hint latest = current.load(std::memory_order_acquire);
+    return latest.revision == revision ? latest : Hint{ revision };
+  }
+
+private:
+  struct Request
+  {
+    std::uint32_t revision = 0;
+    std::optional<Solver::Level> level;
+  };
+
+  void work(const std::stop_token &stop)
+  {
+    trace::name_thread("hints");
+    while (true) {
+      Request request;
+      {
+        std::unique_lock lock{ mutex };
+        if (!wake.wait(lock, stop, [this] { return pending.has_value(); })) { return; }
+        request = std::move(*pending);
+        pending.reset();
+        cancelled = false;
+      }
+      search(request);
+    }
+  }
+
+  void search(Request &request)
+  {
+    const trace::Span span{ "hint search" };
+    const auto hint = [&](Hint::Status status, Direction direction = Direction::up) {
+      return Hint{ request.revision, status, static_cast<std::uint8_t>(direction) };
+    };
+
+    if (!request.level) {
+      publish(hint(Hint::Status::none));
+      return;
+    }
+
+    try {
+      Solver solver{ std::move(*request.level) };
+      const Solution solution = solver.solve(nullptr,
+        { &cancelled, [&](const Solution &better) { publish(hint(Hint::Status::improving, better.path.front())); } });
+      if (cancelled) { return; }
+      publish(solution.solved ? hint(Hint::Status::optimal, solution.path.front()) : hint(Hint::Status::none));
+    } catch (const std::length_error &) {
+      publish(hint(Hint::Status::none));
+    }
+  }
+
+  void publish(Hint hint)
+  {
+    current.store(hint, std::memory_order_release);
+    if (published_hint) { published_hint(); }
+  }
+
+  static_assert(std::atomic<Hint>::is_always_lock_free, "the ui reads hints without locking");
+
+  std::function<void()> published_hint;
+  std::atomic<Hint> current{};
+  std::atomic<std::uint32_t> requested = 0;
+  std::atomic<bool> cancelled = false;
+
+  std::mutex mutex;
+  std::condition_variable_any wake;
+  std::optional<Request> pending;
+
+  // searches the pending request until a newer one arrives, declared last so that ~HintEngine() joins it while
+  // the request, the hint it publishes and the callback are still there
+  std::jthread worker;
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_HINTS_HPP
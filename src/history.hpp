@@ -0,0 +1,261 @@
+#ifndef SMOOTHLIFE_HISTORY_HPP
+#define SMOOTHLIFE_HISTORY_HPP
+
+#include "bots.hpp"
+#include "field.hpp"
+#include "log.hpp"
+#include "player.hpp"
+#include "rules.hpp"
+#include "surface.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace smoothlife {
+
+/**
+ * @brief every position of a game as a tree of versions, for undo and redo and for searches that branch
+ *
+ * A version is the position after a move. It keeps the player, level and stage, the fields the move changed
+ * and, only if the move changed them, the random engine and the log. Everything else is shared with the
+ * versions before it, so a move costs the fields it changes instead of a copy of the board: one field for
+ * most moves, the fields of both levels for leaving through the exit.
+ *
+ * The board is at one version at a time. checkout() goes to any other one by undoing the changes up the tree
+ * and redoing them down to it, so every version stays readable for as long as the history lives. A move
+ * from an older version starts a new branch next to the ones already there, redo() follows the branch that
+ * was visited last. A search backtracks with rewind(), which also forgets the versions it explored.
+ *
+ * Every move has to go through move(). Changes to the player, level or stage between moves, like energy
+ * ticks, are taken into the current version with amend(). The board has to outlive the history.
+ */
+template<class Board> class BoardHistory
+{
+public:
+  using Version = std::size_t;
+  using Prng = typename Board::random_engine;
+
+  static constexpr Version none = std::numeric_limits<Version>::max();
+
+  // the board as it is now becomes the first version
+  explicit BoardHistory(Board &b) : board{ b } { versions.push_back({ position() }); }
+
+  [[nodiscard]] Version current() const { return at; }
+
+  // versions in the tree, the first one included
+  [[nodiscard]] std::size_t size() const { return versions.size(); }
+
+  [[nodiscard]] Version parent(Version v) const
+  {
+    if (v >= versions.size()) { throw std::out_of_range("unknown version"); }
+    return versions[v].parent;
+  }
+
+  // moves the player like Player::move() and records the position after it as a child of the current version
+  bool move(Direction dir)
+  {
+    Player &player = board.player;
+    if (!player.can_move(dir)) { return false; }
+
+    const auto [x, y] = bots::step(player.x, player.y, dir);
+    const Field before = board.get_field(x, y);
+    // the exit builds the next level, the engine and all fields may change
+    const bool leaving = before.type == Field::Type::exit;
+    if (leaving) {
+      engines.push_back(board.rnd);
+      board.for_each_field([this](int fx, int fy, const Field &field) { changes.push_back({ fx, fy, field, {} }); });
+    }
+    log_before = board.log;
+
+    player.move(dir);
+
+    if (leaving) {
+      engines.push_back(board.rnd);
+      board.for_each_field([this](int fx, int fy, const Field &field) { changes.push_back({ fx, fy, {}, field }); });
+    } else if (const Field after = board.get_field(x, y); after != before) {
+      changes.push_back({ x, y, before, after });
+    }
+    if (board.log.revision != log_before.revision) {
+      logs.push_back(log_before);
+      logs.push_back(board.log);
+    }
+
+    const Version made = versions.size();
+    versions.push_back({ position(), at, none, versions[at].depth + 1, changes.size(), engines.size(), logs.size() });
+    versions[at].next = made;
+    at = made;
+    return true;
+  }
+
+  // takes the player, level and stage of the board into the current version
+  void amend() { versions[at].position = position(); }
+
+  // back to the version before the current one, false at the first version
+  bool undo()
+  {
+    if (at == 0) { return false; }
+    checkout(versions[at].parent);
+    return true;
+  }
+
+  // forward to the version undo() came from or the last one made from here, false if there is none
+  bool redo()
+  {
+    const Version next = versions[at].next;
+    // rewind() may have dropped it, or given its number to another version
+    if (next >= versions.size() || versions[next].parent != at) { return false; }
+    checkout(next);
+    return true;
+  }
+
+  // puts the board into the position of version v
+  void checkout(Version v)
+  {
+    if (v >= versions.size()) { throw std::out_of_range("unknown version"); }
+    Version up = at;
+    Version down = v;
+    path.clear();
+    while (versions[up].depth > versions[down].depth) { up = revert(up); }
+    while (versions[down].depth > versions[up].depth) {
+      path.push_back(down);
+      down = versions[down].parent;
+    }
+    while (up != down) {
+      up = revert(up);
+      path.push_back(down);
+      down = versions[down].parent;
+    }
+    for (auto it = path.rbegin(); it != path.rend(); ++it) { replay(*it); }
+    restore(versions[v].position);
+    at = v;
+  }
+
+  // checks out version v and forgets every version made after it, the way back of a search
+  void rewind(Version v)
+  {
+    checkout(v);
+    const Node &last = versions[v];
+    changes.resize(last.changes_end);
+    engines.erase(engines.begin() + static_cast<std::ptrdiff_t>(last.engines_end), engines.end());
+    logs.erase(logs.begin() + static_cast<std::ptrdiff_t>(last.logs_end), logs.end());
+    versions.resize(v + 1);
+  }
+
+private:
+  // the player, level and stage, everything a version keeps whole
+  struct Position
+  {
+    int x = 0;
+    int y = 0;
+    Surface surface = 0;
+    int score = 0;
+    int steps = 0;
+    int energy = 0;
+    int lives = 0;
+    int level = 0;
+    GameStage stage = GameStage::intro;
+  };
+
+  struct Change
+  {
+    int x = 0;
+    int y = 0;
+    Field before;
+    Field after;
+  };
+
+  struct Node
+  {
+    Position position;
+    Version parent = none;
+    // the child redo() goes to
+    Version next = none;
+    std::size_t depth = 0;
+    // the changes, engines and logs of a version follow those of the version made before it, up to these
+    std::size_t changes_end = 0;
+    std::size_t engines_end = 0;
+    std::size_t logs_end = 0;
+  };
+
+  Board &board;
+  std::vector<Node> versions;
+  std::vector<Change> changes;
+  // the engine before and after every move that changed it, in pairs, the same for logs
+  std::vector<Prng> engines;
+  std::vector<Log> logs;
+  Version at = 0;
+  // kept to not allocate on every move and checkout
+  Log log_before{ config::log_length };
+  std::vector<Version> path;
+
+  [[nodiscard]] Position position() const
+  {
+    const Player &player = board.player;
+    return { player.x,
+      player.y,
+      player.surface,
+      player.score,
+      player.steps,
+      player.energy,
+      player.lives,
+      board.level,
+      board.stage };
+  }
+
+  void restore(const Position &p)
+  {
+    Player &player = board.player;
+    player.x = p.x;
+    player.y = p.y;
+    player.surface = p.surface;
+    player.score = p.score;
+    player.steps = p.steps;
+    player.energy = p.energy;
+    player.lives = p.lives;
+    board.level = p.level;
+    board.stage = p.stage;
+  }
+
+  // the events of the log, its revision goes on counting so that views of the log made since are outdated
+  void restore(const Log &log)
+  {
+    const std::size_t revision = board.log.revision;
+    board.log = log;
+    board.log.revision = revision + 1;
+  }
+
+  // undoes the changes of version v, returns its parent
+  Version revert(Version v)
+  {
+    const Node &version = versions[v];
+    const Node &before = versions[v - 1];
+    for (std::size_t i = version.changes_end; i > before.changes_end; --i) {
+      const Change &change = changes[i - 1];
+      board.set_field(change.x, change.y, change.before);
+    }
+    if (version.engines_end != before.engines_end) { board.rnd = engines[before.engines_end]; }
+    if (version.logs_end != before.logs_end) { restore(logs[before.logs_end]); }
+    versions[version.parent].next = v;
+    return version.parent;
+  }
+
+  // redoes the changes of version v on its parent
+  void replay(Version v)
+  {
+    const Node &version = versions[v];
+    const Node &before = versions[v - 1];
+    for (std::size_t i = before.changes_end; i < version.changes_end; ++i) {
+      const Change &change = changes[i];
+      board.set_field(change.x, change.y, change.after);
+    }
+    if (version.engines_end != before.engines_end) { board.rnd = engines[before.engines_end + 1]; }
+    if (version.logs_end != before.logs_end) { restore(logs[before.logs_end + 1]); }
+    versions[version.parent].next = v;
+  }
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_HISTORY_HPP
@@ -0,0 +1,300 @@
+#ifndef SMOOTHLIFE_LEVEL_PACK_HPP
+#define SMOOTHLIFE_LEVEL_PACK_HPP
+
+#include "config.hpp"
+#include "field.hpp"
+#include "gameboard.hpp"
+#include "log.hpp"
+#include "mapped_file.hpp"
+#include "player.hpp"
+#include "random.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace smoothlife {
+
+/**
+ * @brief seed of the generator for one level of a pack
+ *
+ * Every (seed, level) pair gets its own well mixed stream (splitmix64), so a record does not depend on the
+ * levels generated before it and any record can be rebuilt on its own.
+ */
+constexpr std::uint64_t level_seed(std::uint64_t seed, int level)
+{
+  std::uint64_t z = seed + 0x9e3779b97f4a7c15U * (static_cast<std::uint64_t>(static_cast<std::uint32_t>(level)) + 1);
+  z = (z ^ (z >> 30U)) * 0xbf58476d1ce4e5b9U;
+  z = (z ^ (z >> 27U)) * 0x94d049bb133111ebU;
+  return z ^ (z >> 31U);
+}
+
+// a Field in two bytes, values of a base up to 256 fit
+struct PackedField
+{
+  std::uint8_t type = 0;
+  std::uint8_t value = 0;
+};
+
+template<std::size_t Width, std::size_t Height> struct LevelRecord
+{
+  std::uint64_t seed = 0;
+  std::int64_t surface = 0;
+  std::int32_t level = 0;
+  std::uint32_t reserved = 0;
+  std::array<PackedField, Width * Height> fields{};
+};
+
+/**
+ * @brief file header of a level pack, followed by the records
+ *
+ * A pack holds one record for every seed in [first_seed, first_seed + seeds) and every level in
+ * [first_level, first_level + levels), seed major. All records have the same size, so the record of
+ * (seed, level) sits at a computed offset and the file is used as mapped, without parsing.
+ * Integers are little endian.
+ */
+struct LevelPackHeader
+{
+  static constexpr std::array<char, 8> signature{ 'S', 'M', 'L', 'E', 'V', 'E', 'L', 'S' };
+  static constexpr std::uint32_t current_version = 1;
+
+  std::array<char, 8> magic = signature;
+  std::uint32_t version = current_version;
+  std::uint32_t record_size = 0;
+  std::uint32_t width = 0;
+  std::uint32_t height = 0;
+  std::uint64_t first_seed = 0;
+  std::uint64_t seeds = 0;
+  std::int32_t first_level = 0;
+  std::int32_t levels = 0;
+  std::array<std::uint8_t, 16> reserved{};
+};
+
+static_assert(sizeof(LevelPackHeader) == 64);
+static_assert(std::is_trivially_copyable_v<LevelPackHeader>);
+static_assert(std::is_trivially_copyable_v<LevelRecord<config::board_width, config::board_height>>);
+static_assert(std::endian::native == std::endian::little, "level packs are read in place as little endian");
+
+// header of a pack holding the given seeds and levels of Width x Height boards
+template<std::size_t Width, std::size_t Height>
+LevelPackHeader level_pack_header(std::uint64_t first_seed, std::uint64_t seeds, int first_level, int levels)
+{
+  LevelPackHeader header;
+  header.record_size = sizeof(LevelRecord<Width, Height>);
+  header.width = Width;
+  header.height = Height;
+  header.first_seed = first_seed;
+  header.seeds = seeds;
+  header.first_level = first_level;
+  header.levels = levels;
+  return header;
+}
+
+/**
+ * @brief read only view of a memory mapped level pack
+ *
+ * find() is a bounds check and an offset computation, records are read where they lie in the mapping.
+ */
+class LevelPack
+{
+public:
+  explicit LevelPack(const std::filesystem::path &path) : file{ path }
+  {
+    const auto bytes = file.bytes();
+    if (bytes.size() < sizeof(LevelPackHeader)) { throw std::runtime_error("not a level pack: " + path.string()); }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    header = *reinterpret_cast<const LevelPackHeader *>(bytes.data());
+
+    if (header.magic != LevelPackHeader::signature) { throw std::runtime_error("not a level pack: " + path.string()); }
+    if (header.version != LevelPackHeader::current_version) {
+      throw std::runtime_error("unsupported level pack version " + std::to_string(header.version));
+    }
+    if (header.record_size == 0 || header.levels < 0) {
+      throw std::runtime_error("corrupt level pack: " + path.string());
+    }
+    const std::uint64_t records = (bytes.size() - sizeof(LevelPackHeader)) / header.record_size;
+    if (records / std::max<std::uint64_t>(1, static_cast<std::uint64_t>(header.levels)) < header.seeds) {
+      throw std::runtime_error("truncated level pack: " + path.string());
+    }
+  }
+
+  [[nodiscard]] const LevelPackHeader &info() const { return header; }
+
+  // true if the records are Width x Height boards
+  template<std::size_t Width, std::size_t Height> [[nodiscard]] bool holds() const
+  {
+    return header.width == Width && header.height == Height && header.record_size == sizeof(LevelRecord<Width, Height>);
+  }
+
+  // record of (seed, level), nullptr if the pack does not contain it or holds other boards
+  template<std::size_t Width, std::size_t Height>
+  [[nodiscard]] const LevelRecord<Width, Height> *find(std::uint64_t seed, int level) const
+  {
+    // the difference of two ints can overflow one
+    const std::int64_t offset = std::int64_t{ level } - header.first_level;
+    if (!holds<Width, Height>() || seed - header.first_seed >= header.seeds || offset < 0 || offset >= header.levels) {
+      return nullptr;
+    }
+    const std::uint64_t index = (seed - header.first_seed) * static_cast<std::uint64_t>(header.levels)
+                                + static_cast<std::uint64_t>(offset);
+    const std::byte *record = file.bytes().data() + sizeof(LevelPackHeader) + index * header.record_size;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return reinterpret_cast<const LevelRecord<Width, Height> *>(record);
+  }
+
+private:
+  MappedFile file;
+  LevelPackHeader header;
+};
+
+// generates the level (seed, level) with the board, the way every pack record is made
+template<std::size_t Width, std::size_t Height, class Prng>
+LevelRecord<Width, Height> generate_record(GameBoard<Width, Height, Prng> &board, std::uint64_t seed, int level)
+{
+  if constexpr (SeekablePrng<Prng>) {
+    // the seed is the key and the level a stream of its own, nothing needs mixing
+    seed_prng(board.rnd, seed);
+    board.rnd.seek(static_cast<std::uint32_t>(level));
+  } else {
+    seed_prng(board.rnd, level_seed(seed, level));
+  }
+  board.level = level;
+  board.generate_level();
+
+  LevelRecord<Width, Height> record;
+  record.seed = seed;
+  record.level = level;
+  record.surface = board.player.surface.to_long();
+  for (std::size_t i = 0; i < record.fields.size(); ++i) {
+    const Field &field = board.state[i];
+    record.fields[i] = { static_cast<std::uint8_t>(field.type), static_cast<std::uint8_t>(field.value) };
+  }
+  return record;
+}
+
+// puts a record on the board like generate_level() would, throws std::runtime_error if the record is corrupt
+template<std::size_t Width, std::size_t Height, class Prng>
+void load_record(GameBoard<Width, Height, Prng> &board, const LevelRecord<Width, Height> &record)
+{
+  static_assert(config::base <= 256, "field values are stored in one byte");
+
+  // the bytes come straight from the file, the board is only touched once all of them are valid
+  for (std::size_t i = 0; i < record.fields.size(); ++i) {
+    const PackedField &field = record.fields[i];
+    if (field.type > static_cast<std::uint8_t>(Field::Type::div)) {
+      throw std::runtime_error("corrupt level pack record");
+    }
+    // the one exit is the last field
+    if ((field.type == static_cast<std::uint8_t>(Field::Type::exit)) != (i == record.fields.size() - 1)) {
+      throw std::runtime_error("corrupt level pack record");
+    }
+    if (field.type >= static_cast<std::uint8_t>(Field::Type::add) && (field.value < 1 || field.value >= config::base)) {
+      throw std::runtime_error("corrupt level pack record");
+    }
+  }
+
+  for (std::size_t i = 0; i < record.fields.size(); ++i) {
+    board.state[i] = { static_cast<Field::Type>(record.fields[i].type), record.fields[i].value };
+  }
+  board.level = record.level;
+  board.player.x = 0;
+  board.player.y = 0;
+  board.player.surface = static_cast<long>(record.surface);
+}
+
+/**
+ * @brief makes the board take its levels from the pack
+ *
+ * Level n of the game is the record (seed, n). Levels missing from the pack are generated as usual.
+ * The pack has to outlive the board.
+ */
+template<std::size_t Width, std::size_t Height, class Prng>
+void use_level_pack(GameBoard<Width, Height, Prng> &board, const LevelPack &pack, std::uint64_t seed)
+{
+  if (!pack.holds<Width, Height>()) {
+    throw std::runtime_error(fmt::format("level pack holds {}x{} boards, the game needs {}x{}",
+      pack.info().width,
+      pack.info().height,
+      Width,
+      Height));
+  }
+
+  board.load_level = [&board, &pack, seed] {
+    const auto *record = pack.find<Width, Height>(seed, board.level);
+    if (record == nullptr) { return false; }
+    load_record(board, *record);
+    return true;
+  };
+}
+
+/**
+ * @brief writes a pack of all levels [first_level, first_level + levels) for the seeds
+ *
+ * Records are generated on the pool a batch of seeds at a time and appended in order, so memory stays
+ * bounded for packs of any size.
+ */
+template<std::size_t Width, std::size_t Height, class Prng = std::ranlux24>
+void write_level_pack(const std::filesystem::path &path,
+  ThreadPool &pool,
+  std::uint64_t first_seed,
+  std::uint64_t seeds,
+  int first_level,
+  int levels)
+{
+  using Record = LevelRecord<Width, Height>;
+  static constexpr std::uint64_t chunk_seeds = 256;
+  static constexpr std::uint64_t batch_chunks = 64;
+
+  std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+  if (!out) { throw std::runtime_error("cannot open " + path.string()); }
+
+  const auto header = level_pack_header<Width, Height>(first_seed, seeds, first_level, levels);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  const auto level_count = static_cast<std::uint64_t>(std::max(levels, 0));
+  std::vector<Record> batch;
+  for (std::uint64_t batch_start = 0; batch_start < seeds; batch_start += chunk_seeds * batch_chunks) {
+    const std::uint64_t batch_seeds = std::min(seeds - batch_start, chunk_seeds * batch_chunks);
+    batch.resize(batch_seeds * level_count);
+
+    for (std::uint64_t chunk = 0; chunk * chunk_seeds < batch_seeds; ++chunk) {
+      pool.submit([&, chunk] {
+        Player player;
+        Log log{ config::log_length };
+        Prng prng;
+        GameBoard<Width, Height, Prng> board{ prng, player, log };
+
+        const std::uint64_t end = std::min(batch_seeds, (chunk + 1) * chunk_seeds);
+        for (std::uint64_t s = chunk * chunk_seeds; s < end; ++s) {
+          for (std::uint64_t l = 0; l < level_count; ++l) {
+            batch[s * level_count + l] =
+              generate_record(board, first_seed + batch_start + s, first_level + static_cast<int>(l));
+          }
+        }
+      });
+    }
+    pool.wait();
+
+    const auto bytes = static_cast<std::streamsize>(batch.size() * sizeof(Record));
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    out.write(reinterpret_cast<const char *>(batch.data()), bytes);
+  }
+
+  if (!out.flush()) { throw std::runtime_error("cannot write " + path.string()); }
+}
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_LEVEL_PACK_HPP
@@ -0,0 +1,318 @@
+#include "config.hpp"
+#include "protocol.hpp"
+#include "server.hpp"
+#include "timer_wheel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <docopt/docopt.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <internal_use_only/config.hpp>
+
+namespace smoothlife {
+
+struct LoadOptions
+{
+  std::filesystem::path socket;
+  std::size_t sessions = 0;
+  int moves = 0;
+  // moves per second of a session, 0 sends the next one as soon as the reply is in
+  double rate = 0;
+  std::size_t threads = 1;
+  std::uint64_t seed = 0;
+};
+
+struct LoadResult
+{
+  // nanoseconds from sending a move until its reply is in
+  std::vector<std::uint32_t> latencies;
+  std::uint64_t games = 0;
+};
+
+/**
+ * @brief plays the sessions of one client thread
+ *
+ * Every session has one request in flight at a time and moves in a random direction the board allows. A
+ * session that finished its game starts a new one, it is done after its moves. Paced sessions wait on a
+ * timer wheel between a reply and the next move, starting at random offsets so they do not move in lockstep.
+ */
+class LoadClient
+{
+public:
+  LoadClient(const LoadOptions &opts, std::uint64_t first_seed, std::size_t count)
+    : options{ opts }, epoll{ ::epoll_create1(EPOLL_CLOEXEC) }, rnd{ first_seed }, next_seed{ first_seed }
+  {
+    if (!epoll.is_open()) { detail::fail_errno("epoll_create1"); }
+    sessions.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      Session &session = sessions[i];
+      session.fd = connect_server(options.socket);
+      if (::fcntl(session.fd.get(), F_SETFL, O_NONBLOCK) != 0) {// NOLINT(cppcoreguidelines-pro-type-vararg)
+        detail::fail_errno("fcntl");
+      }
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.u64 = i;
+      if (::epoll_ctl(epoll.get(), EPOLL_CTL_ADD, session.fd.get(), &event) != 0) { detail::fail_errno("epoll_ctl"); }
+      session.moves_left = options.moves;
+    }
+  }
+
+  LoadResult run()
+  {
+    LoadResult result;
+    result.latencies.reserve(sessions.size() * static_cast<std::size_t>(std::max(options.moves, 0)));
+    for (std::size_t i = 0; i < sessions.size(); ++i) { start(i, result); }
+
+    std::array<epoll_event, 256> events{};
+    while (active > 0) {
+      const auto now = std::chrono::steady_clock::now();
+      wheel.advance(now, [&](std::size_t index) { move(index); });
+      const auto wait = wheel.until_next(now);
+      const int timeout = wait == std::chrono::steady_clock::duration::max()
+                            ? -1
+                            : static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(wait).count());
+      const int ready = ::epoll_wait(epoll.get(), events.data(), static_cast<int>(events.size()), timeout);
+      if (ready < 0 && errno == EINTR) { continue; }
+      if (ready < 0) { detail::fail_errno("epoll_wait"); }
+      for (std::size_t i = 0; i < static_cast<std::size_t>(ready); ++i) { receive(events.at(i).data.u64, result); }
+    }
+    return result;
+  }
+
+private:
+  struct Session
+  {
+    detail::FileDescriptor fd;
+    int moves_left = 0;
+    std::array<std::byte, sizeof(ServerFrame)> reply{};
+    std::size_t got = 0;
+    std::chrono::steady_clock::time_point sent;
+    bool moving = false;
+    ServerFrame state;
+  };
+
+  const LoadOptions &options;
+  detail::FileDescriptor epoll;
+  std::vector<Session> sessions;
+  TimerWheel<std::size_t> wheel{ std::chrono::milliseconds{ 1 }, 4096 };
+  std::minstd_rand rnd;
+  std::uint64_t next_seed;
+  std::size_t active = 0;
+
+  void send(std::size_t index, const ClientFrame &request)
+  {
+    Session &session = sessions[index];
+    session.sent = std::chrono::steady_clock::now();
+    session.moving = request.type == ClientFrame::Type::move;
+    // a request never waits, the socket holds at most one reply and one request of a session
+    if (::send(session.fd.get(), &request, sizeof(request), MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(request))) {
+      detail::fail_errno("send");
+    }
+  }
+
+  void start(std::size_t index, LoadResult &result)
+  {
+    ++active;
+    ++result.games;
+    send(index, { ClientFrame::Type::start, 0, {}, next_seed++ });
+  }
+
+  void move(std::size_t index)
+  {
+    const ServerFrame &state = sessions[index].state;
+    std::array<Direction, 4> possible{};
+    std::size_t count = 0;
+    if (std::size_t{ state.y } + 1 < config::board_height) { possible.at(count++) = Direction::up; }
+    if (state.x > 0) { possible.at(count++) = Direction::left; }
+    if (state.y > 0) { possible.at(count++) = Direction::down; }
+    if (std::size_t{ state.x } + 1 < config::board_width) { possible.at(count++) = Direction::right; }
+    const Direction dir = possible.at(std::uniform_int_distribution<std::size_t>{ 0, count - 1 }(rnd));
+    send(index, { ClientFrame::Type::move, static_cast<std::uint8_t>(dir), {}, 0 });
+  }
+
+  void receive(std::size_t index, LoadResult &result)
+  {
+    Session &session = sessions[index];
+    const std::size_t missing = session.reply.size() - session.got;
+    const ssize_t n = ::recv(session.fd.get(), session.reply.data() + session.got, missing, 0);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) { return; }
+    if (n <= 0) { throw std::runtime_error("the server closed a session"); }
+    session.got += static_cast<std::size_t>(n);
+    if (session.got < session.reply.size()) { return; }
+
+    session.got = 0;
+    std::memcpy(&session.state, session.reply.data(), sizeof(session.state));
+    if (session.moving) {
+      const auto latency = std::chrono::steady_clock::now() - session.sent;
+      result.latencies.push_back(static_cast<std::uint32_t>(
+        std::min<std::chrono::nanoseconds::rep>(std::chrono::nanoseconds{ latency }.count(), UINT32_MAX)));
+      --session.moves_left;
+    }
+
+    --active;
+    if (session.moves_left <= 0) {
+      session.fd.close();
+      return;
+    }
+    if (session.state.stage != static_cast<std::uint8_t>(GameStage::game)) {
+      start(index, result);
+      return;
+    }
+    ++active;
+    if (options.rate <= 0) {
+      move(index);
+      return;
+    }
+    // the first move of a paced game goes anywhere in its first period
+    const std::chrono::duration<double> period{
+      (session.moving ? 1.0 : std::uniform_real_distribution<double>{ 0, 1 }(rnd)) / options.rate
+    };
+    wheel.schedule(index, std::chrono::duration_cast<std::chrono::steady_clock::duration>(period));
+  }
+};
+
+int run_load(const LoadOptions &options, std::optional<std::size_t> serve)
+{
+  std::optional<GameServer> server;
+  if (serve) { server.emplace(ServerOptions{ options.socket, *serve, config::energy_decrement_time }); }
+
+  GameClient monitor{ options.socket };
+  const ServerStatsFrame before = monitor.stats();
+  const auto start = std::chrono::steady_clock::now();
+
+  // sessions are connected before any of them plays
+  std::vector<std::unique_ptr<LoadClient>> clients;
+  for (std::size_t t = 0; t < options.threads; ++t) {
+    const std::size_t first = options.sessions * t / options.threads;
+    const std::size_t last = options.sessions * (t + 1) / options.threads;
+    clients.push_back(std::make_unique<LoadClient>(options, options.seed + first * 1'000'000, last - first));
+  }
+  std::vector<LoadResult> results(options.threads);
+  // a failing session would terminate the process from its thread, it is reported from here instead
+  std::vector<std::exception_ptr> failures(options.threads);
+  {
+    std::vector<std::jthread> threads;
+    for (std::size_t t = 0; t < options.threads; ++t) {
+      threads.emplace_back([&, t] {
+        try {
+          results[t] = clients[t]->run();
+        } catch (...) {
+          failures[t] = std::current_exception();
+        }
+      });
+    }
+  }
+  for (const auto &failure : failures) {
+    if (failure) { std::rethrow_exception(failure); }
+  }
+
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  const ServerStatsFrame after = monitor.stats();
+
+  std::vector<std::uint32_t> latencies;
+  std::uint64_t games = 0;
+  for (const auto &result : results) {
+    latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+    games += result.games;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  const auto at = [&](double q) {
+    if (latencies.empty()) { return 0.0; }
+    const auto index = static_cast<std::size_t>(q * static_cast<double>(latencies.size() - 1));
+    return static_cast<double>(latencies[index]) / 1e3;
+  };
+  const double seconds = elapsed.count();
+  const double server_cpu = static_cast<double>(after.cpu_ns - before.cpu_ns) / 1e9;
+  const auto moves = static_cast<double>(after.moves - before.moves);
+
+  fmt::print("smoothlife_load: {} sessions, {} moves each, {} client threads, {} server threads\n",
+    options.sessions,
+    options.moves,
+    options.threads,
+    after.threads);
+  fmt::print("  time       {:>12.3f} s\n", seconds);
+  fmt::print("  games      {:>12}\n", games);
+  fmt::print("  moves/sec  {:>12.0f}\n", static_cast<double>(latencies.size()) / seconds);
+  fmt::print("  latency    {:>12.1f} us p50 {:>8.1f} p90 {:>8.1f} p99 {:>8.1f} p999 {:>8.1f} max\n",
+    at(0.50),
+    at(0.90),
+    at(0.99),
+    at(0.999),
+    at(1.0));
+  fmt::print("  server cpu {:>12.3f} s, {:.0f} moves per cpu second\n", server_cpu, moves / std::max(server_cpu, 1e-9));
+  // sessions playing at this pace a fully busy core would hold
+  if (options.rate > 0) {
+    fmt::print("  sessions   {:>12.0f} per core at {:g} moves/sec each\n",
+      static_cast<double>(options.sessions) * seconds / std::max(server_cpu, 1e-9),
+      options.rate);
+  }
+  return 0;
+}
+
+}// namespace smoothlife
+
+int main(int argc, const char **argv)
+{
+  try {
+    static constexpr auto USAGE =
+      R"(
+    Usage:
+          smoothlife_load <socket> [--sessions=<n>] [--moves=<m>] [--rate=<r>] [--threads=<t>] [--seed=<s>] [--serve=<t>]
+          smoothlife_load --version
+          smoothlife_load (-h | --help)
+    Options:
+          -h --help        Show this screen.
+          --version        Show version.
+          --sessions=<n>   Sessions playing at the same time [default: 1000].
+          --moves=<m>      Moves of every session [default: 100].
+          --rate=<r>       Moves per second of every session, 0 moves as soon as the reply is in [default: 0].
+          --threads=<t>    Client threads [default: 1].
+          --seed=<s>       Seed of the first game [default: 1].
+          --serve=<t>      Start a server with <t> threads on the socket in this process instead of using one.
+    Plays against smoothlife_server and reports the latency of the moves and the cpu time the server spent.
+)";
+
+    auto args = docopt::docopt(USAGE,
+      { std::next(argv), std::next(argv, argc) },
+      true,
+      fmt::format("{} {}", smoothlife::cmake::project_name, smoothlife::cmake::project_version));
+
+    smoothlife::raise_file_limit();
+    smoothlife::LoadOptions options;
+    options.socket = args["<socket>"].asString();
+    options.sessions = static_cast<std::size_t>(args["--sessions"].asLong());
+    options.moves = static_cast<int>(args["--moves"].asLong());
+    options.rate = std::stod(args["--rate"].asString());
+    options.threads = std::max<std::size_t>(1, static_cast<std::size_t>(args["--threads"].asLong()));
+    options.seed = static_cast<std::uint64_t>(args["--seed"].asLong());
+
+    std::optional<std::size_t> serve;
+    if (args["--serve"]) { serve = static_cast<std::size_t>(args["--serve"].asLong()); }
+    return smoothlife::run_load(options, serve);
+
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("Unhandled exception in main: {}", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,104 @@
+#ifndef SMOOTHLIFE_LOCKFREE_QUEUE_HPP
+#define SMOOTHLIFE_LOCKFREE_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+
+namespace smoothlife {
+
+/**
+ * @brief bounded queue for any number of producers and consumers that never takes a lock
+ *
+ * Every slot carries a sequence number telling whether it is free for the push or filled for the pop of the
+ * current lap around the ring (D. Vyukov's bounded queue). A push or pop is one compare and swap of a
+ * position on success, a full or empty queue is reported instead of waited for.
+ */
+template<class T> class LockFreeQueue
+{
+  static_assert(std::is_trivially_copyable_v<T>, "items are copied in and out of the slots");
+
+public:
+  // capacity is rounded up to a power of two
+  explicit LockFreeQueue(std::size_t capacity)
+    : mask{ slot_count(capacity) - 1 }, slots{ std::make_unique<Slot[]>(mask + 1) }
+  {
+    for (std::size_t i = 0; i <= mask; ++i) { slots[i].sequence.store(i, std::memory_order_relaxed); }
+  }
+
+  // false if the queue is full
+  bool try_push(const T &item)
+  {
+    std::size_t position = tail.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = slots[position & mask];
+      const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      const auto lap = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+      if (lap == 0) {
+        if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          slot.item = item;
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (lap < 0) {
+        return false;
+      } else {
+        position = tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // nothing if the queue is empty
+  std::optional<T> try_pop()
+  {
+    std::size_t position = head.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = slots[position & mask];
+      const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      const auto lap = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+      if (lap == 0) {
+        if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          const T item = slot.item;
+          slot.sequence.store(position + mask + 1, std::memory_order_release);
+          return item;
+        }
+      } else if (lap < 0) {
+        return std::nullopt;
+      } else {
+        position = head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  [[nodiscard]] std::size_t capacity() const { return mask + 1; }
+
+private:
+  // a slot per cache line, neighbouring pushes and pops do not share one
+  struct alignas(64) Slot
+  {
+    std::atomic<std::size_t> sequence = 0;
+    T item{};
+  };
+
+  // checked before anything is allocated
+  static std::size_t slot_count(std::size_t capacity)
+  {
+    if (capacity == 0) { throw std::invalid_argument("a queue needs room for an item"); }
+    if (capacity > std::size_t{ 1 } << 30U) { throw std::invalid_argument("queue too large"); }
+    return std::bit_ceil(std::max<std::size_t>(capacity, 2));
+  }
+
+  std::size_t mask;
+  std::unique_ptr<Slot[]> slots;
+  alignas(64) std::atomic<std::size_t> tail = 0;
+  alignas(64) std::atomic<std::size_t> head = 0;
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_LOCKFREE_QUEUE_HPP
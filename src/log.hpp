@@ -3,48 +3,122 @@
 
 #include "config.hpp"
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
 namespace smoothlife {
 
+/**
+ * @brief the last events of a game, newest first
+ *
+ * Events are stored as a message id and their numbers in a fixed ring, posting one never allocates.
+ * The text is only formatted when somebody reads it.
+ */
 struct Log
 {
-  enum struct Type { amazing, good, bad, neutral };
+  enum struct Type : std::uint8_t { amazing, good, bad, neutral };
   using enum Type;
 
-  std::size_t length;
-  std::deque<std::pair<std::string, Type>> log;
+  // everything the game can tell, texts and types are in the messages table
+  enum struct Message : std::uint8_t {
+    add_paste,
+    remove_burrs,
+    finer_sanding,
+    disassemble,
+    smoother,
+    smooth_and_shiny,
+    mess,
+    failed,
+    okay_polish,
+    fine_polish,
+    masterpiece
+  };
+
+  struct MessageInfo
+  {
+    // format string, {0} is the score and {1} the energy of the event
+    std::string_view text;
+    Type type;
+  };
+
+  static constexpr std::array<MessageInfo, static_cast<std::size_t>(Message::masterpiece) + 1> messages{ {
+    { "Add polishing paste.", neutral },
+    { "Remove burrs.", neutral },
+    { "Use finer sanding.", neutral },
+    { "Disassemble parts.", neutral },
+    { "Nice, it's getting smooth!", good },
+    { "Great, so smooth and shiny!", good },
+    { "Damn, what a mess!", bad },
+    { "You failed this time :(", bad },
+    { "An okay polish. score +{0}, energy +{1}", neutral },
+    { "A really fine polish ^.^ score +{0}, energy +{1}", good },
+    { "Truly a masterpiece *.* score +{0}, energy +{1}", amazing },
+  } };
+
+  struct Event
+  {
+    Message message = Message::add_paste;
+    int score = 0;
+    int energy = 0;
+
+    [[nodiscard]] constexpr Type type() const { return messages[static_cast<std::size_t>(message)].type; }
+
+    [[nodiscard]] std::string text() const
+    {
+      return fmt::format(fmt::runtime(messages[static_cast<std::size_t>(message)].text), score, energy);
+    }
+  };
+
+  static constexpr std::size_t capacity = config::log_length;
 
-  explicit Log(std::size_t len) : length{ len } {}
+  // counts the posted events, a view of the log is outdated when it changed
+  std::size_t revision = 0;
 
-  void post_event(const std::string &event, Type type = neutral)
+  constexpr explicit Log(std::size_t len) : length{ len }
   {
-    log.push_front({ event, type });
-    if (log.size() > length) { log.pop_back(); }
+    if (length > capacity) { throw std::invalid_argument("log length exceeds its capacity"); }
   }
 
-  [[nodiscard]] ftxui::Element render() const
+  constexpr void post_event(Message message, int score = 0, int energy = 0)
   {
-    using enum ftxui::Color::Palette16;
-
-    ftxui::Elements events;
-    std::array<ftxui::Color, 3> shades{ White, GrayLight, GrayDark };
-
-    for (std::size_t i = 0; i < log.size(); ++i) {
-      ftxui::Decorator color = ftxui::color(shades.at(std::min(i, shades.size() - 1)));
-      if (i == 0 && log.at(i).second == amazing) {
-        color = ftxui::color(GreenLight);
-      } else if (i == 0 && log.at(i).second == good) {
-        color = ftxui::color(BlueLight);
-      } else if (i == 0 && log.at(i).second == bad) {
-        color = ftxui::color(RedLight);
-      }
-      events.push_back(ftxui::paragraph(log.at(i).first) | color);
-    }
+    if (length == 0) { return; }
+    newest = newest + 1 == length ? 0 : newest + 1;
+    events[newest] = { message, score, energy };
+    if (count < length) { ++count; }
+    ++revision;
+  }
+
+  [[nodiscard]] constexpr std::size_t size() const { return count; }
 
-    return ftxui::vbox(std::move(events)) | ftxui::border | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, config::panel_width)
-           | ftxui::size(ftxui::HEIGHT, ftxui::EQUAL, config::panel_height);
+  [[nodiscard]] constexpr bool empty() const { return count == 0; }
+
+  // the i-th newest event, 0 is the last one posted
+  [[nodiscard]] constexpr const Event &operator[](std::size_t i) const
+  {
+    return events[(newest + length - i) % length];
   }
+
+  constexpr void clear()
+  {
+    count = 0;
+    ++revision;
+  }
+
+private:
+  std::size_t length;
+  std::array<Event, capacity> events{};
+  std::size_t newest = 0;
+  std::size_t count = 0;
 };
 
+static_assert(!Log::messages.back().text.empty(), "every Log::Message needs its entry in Log::messages");
+
 }// namespace smoothlife
 
-#endif// SMOOTHLIFE_LOG_HPP
\ No newline at end of file
+#endif// SMOOTHLIFE_LOG_HPP
@@ -1,178 +1,360 @@
+#include "builtin_levels.hpp"
 #include "config.hpp"
 #include "gameboard.hpp"
+#include "hints.hpp"
+#include "history.hpp"
+#include "level_pack.hpp"
+#include "mapped_file.hpp"
 #include "player.hpp"
+#include "prefetch.hpp"
+#include "random.hpp"
+#include "replay.hpp"
+#include "snapshot.hpp"
+#include "telemetry.hpp"
+#include "trace.hpp"
+#include "ui.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <docopt/docopt.h>
+#include <spdlog/spdlog.h>
 
 #include <internal_use_only/config.hpp>
 
 namespace smoothlife {
 
-void game_loop(bool skip_tutorial = false)
+struct GameOptions
+{
+  bool skip_tutorial = false;
+  // with a pack, the levels are the records of pack_seed instead of generated ones
+  const LevelPack *pack = nullptr;
+  std::uint64_t pack_seed = 0;
+  // the first levels are the built-in ones of today's challenge, without a pack
+  bool daily = false;
+  // write a replay of every session here, a retry overwrites it with the new session
+  std::string record;
+  // sizes other than the configured one play on a sparse board, without packs and replays
+  std::size_t width = config::board_width;
+  std::size_t height = config::board_height;
+  // one of config::bases, the other ones play without packs and replays as well
+  int base = config::base;
+  // one of prng_names, levels of the same seed differ between the engines, replays need the first one
+  std::string prng{ prng_names[0] };
+  // suggest the next move, computed in the background, needs the configured board size and base
+  bool hints = false;
+  // records the levels and moves of every session when set, any board and base
+  TelemetryWriter *telemetry = nullptr;
+  // resume the session saved here if there is one and save it again after every change, not with replays
+  std::string save;
+  bool resume = true;
+};
+
+template<class Board> void game_loop(GameOptions options = {})
 {
   Player player;
   Log log{ config::log_length };
-  auto prng = std::ranlux24{ std::random_device{}() };
+  const auto seed = std::random_device{}();
+  typename Board::random_engine prng;
+  seed_prng(prng, seed);
+
+  Board board{ prng, player, log, options.width, options.height };
+  // a game showing the tutorial starts with the built-in tutorial levels
+  bool tutorial = false;
+  if constexpr (Board::fixed_size && Board::base == config::base) {
+    if (options.pack != nullptr) {
+      use_level_pack(board, *options.pack, options.pack_seed);
+    } else if (options.daily) {
+      use_builtin_levels(board, daily_levels, daily_seed());
+    } else if (!options.skip_tutorial) {
+      use_builtin_levels(board, tutorial_levels, tutorial_levels.first_seed);
+      tutorial = true;
+    }
+  }
+  std::optional<TelemetrySession> telemetry;
+  int moves = 0;
+  if (options.telemetry != nullptr) {
+    telemetry.emplace(*options.telemetry, board);
+    telemetry->begin(seed);
+  }
+  board.next_level();
 
-  using GameBoard = GameBoard<config::board_width, config::board_height, std::ranlux24>;
-  GameBoard board{ prng, player, log };
-  board.generate_level();
+  if (options.skip_tutorial) { board.stage = GameStage::game; }
 
-  if (skip_tutorial) { board.stage = GameStage::game; }
+  // snapshots are taken under the game mutex and written by the autosaver's thread
+  std::optional<Autosaver> autosave;
+  if (!options.save.empty()) {
+    if (options.resume && std::filesystem::exists(options.save)) {
+      const MappedFile file{ options.save };
+      load_snapshot(board, file.bytes());
+    }
+    autosave.emplace(options.save);
+  }
+  const auto save_game = [&] {
+    if (autosave) { autosave->save(board); }
+  };
+
+  // the levels after this one are built while it is played, reaching the exit only swaps them in, a pack has
+  // all of its levels already
+  std::optional<LevelPrefetcher<Board>> prefetcher;
+  if (options.pack == nullptr) { prefetcher.emplace(board); }
+
+  ReplayRecorder recording{ seed,
+    (options.skip_tutorial ? ReplayHeader::skip_tutorial : 0U)
+      | (options.pack != nullptr ? ReplayHeader::level_pack : 0U) | (tutorial ? ReplayHeader::tutorial_levels : 0U),
+    options.pack_seed };
+  bool recorded = false;
+  const auto save_recording = [&] {
+    if (options.record.empty() || recorded) { return; }
+    recording.save(options.record, player.score, board.level);
+    recorded = true;
+  };
+
+  // moves and the continue button come from the ui thread, energy ticks from the timer thread
+  std::mutex game_mutex;
 
   auto screen = ftxui::ScreenInteractive::FitComponent();
+
+  // searches the position after every change of the game, the ui only shows the newest answer
+  std::optional<HintEngine> hints;
+  const auto update_hint = [&] {
+    if constexpr (Board::fixed_size && Board::base == config::base) {
+      if (hints) { hints->update(board); }
+    }
+  };
+  if (options.hints) {
+    hints.emplace([&screen] { screen.PostEvent(ftxui::Event::Custom); });
+    update_hint();
+  }
+
+  // every move is a version of the game to go back and forth between, replays only record moves forward
+  std::optional<BoardHistory<Board>> history;
+  if (options.record.empty()) { history.emplace(board); }
+
+  PlayerControls controls{ [&](Direction dir) {
+    const std::scoped_lock lock{ game_mutex };
+    if (history ? history->move(dir) : player.move(dir)) {
+      ++moves;
+      recording.record(replay_event(dir));
+      update_hint();
+      save_game();
+    }
+  } };
+
+  const auto travel = [&](auto step) {
+    const std::scoped_lock lock{ game_mutex };
+    if (board.stage == GameStage::game && step(*history)) {
+      update_hint();
+      save_game();
+    }
+  };
+  if (history) {
+    controls.undo = [&] { travel([](BoardHistory<Board> &h) { return h.undo(); }); };
+    controls.redo = [&] { travel([](BoardHistory<Board> &h) { return h.redo(); }); };
+  }
+
   auto quit_button = ftxui::Button("Quit", screen.ExitLoopClosure());
-  auto continue_button = ftxui::Button("Continue", [&] { ++board.stage; });
-  auto retry_button = ftxui::Button("Retry", [&] { game_loop(true); });
-  auto container = ftxui::Container::Horizontal({ player.move_ui, quit_button, continue_button, retry_button });
+  auto continue_button = ftxui::Button("Continue", [&] {
+    const std::scoped_lock lock{ game_mutex };
+    ++board.stage;
+    if (history) { history->amend(); }
+    recording.record(ReplayEvent::advance);
+    save_game();
+  });
+  auto retry_button = ftxui::Button("Retry", [&] {
+    save_recording();
+    GameOptions retry = options;
+    retry.skip_tutorial = true;
+    retry.resume = false;
+    game_loop<Board>(retry);
+  });
+  auto container = ftxui::Container::Horizontal({ controls.move_ui, quit_button, continue_button, retry_button });
+
+  using enum ftxui::Color::Palette16;
+
+  // parts of the window that change, each rebuilt only when what it shows changed
+  BoardView board_view{ config::viewport_width, config::viewport_height };
+  CachedElement<int> health_view;
+  CachedElement<int> energy_view;
+  CachedElement<Surface> surface_view;
+  CachedElement<int> score_view;
+  CachedElement<std::size_t> log_view;
+  CachedElement<Hint> hint_view;
+
+  // static texts, built once
+  const auto legend = ftxui::vbox({
+    ftxui::text(" legend:") | ftxui::color(GrayDark),
+    ftxui::hbox({
+      ftxui::text(" + ") | ftxui::bold | ftxui::color(RedLight),
+      ftxui::text(" − ") | ftxui::bold | ftxui::color(BlueLight),
+      ftxui::text(" × ") | ftxui::bold | ftxui::color(GreenLight),
+      ftxui::text(" ÷ ") | ftxui::bold | ftxui::color(YellowLight),
+    }),
+  });
+  const auto arrow_keys_hint = ftxui::text(" try arrow keys!") | ftxui::color(GrayDark);
+  const auto undo_keys_hint = ftxui::text(" u undo, r redo") | ftxui::color(GrayDark);
+  const auto energy_label = ftxui::text(" energy  ");
+  const auto surface_label = ftxui::text(" surface ");
+  const auto score_label = ftxui::text(" score   ");
+
+  const auto intro_text = ftxui::vbox({
+    ftxui::text(""),
+    ftxui::text(" Buzzing thoughts: I'm feeling so burned out... "),
+    ftxui::text("     Ironic... my dream is to become a master polisher. "),
+    ftxui::text("     Making things smooth, shiny and round. "),
+    ftxui::text("     Why does my life have to be so rough then? "),
+    ftxui::text("     I'm afraid of failing the final exams tomorrow. "),
+    ftxui::text(""),
+    ftxui::text(" You fall asleep at your working desk. "),
+    ftxui::text(""),
+  });
+  const auto tutorial_1_text = ftxui::vbox({
+    ftxui::text(""),
+    ftxui::text(" Airy voice: Stop pitying yourself, fool! "),
+    ftxui::text("     You're almost there! Keep on polishing! "),
+    ftxui::separator(),
+    ftxui::text(" Tutorial: ") | ftxui::bold,
+    ftxui::hbox({
+      ftxui::text(" Combine operations to make the "),
+      ftxui::text("surface-number") | ftxui::color(Blue),
+      ftxui::text(" as round as possible. "),
+    }),
+    ftxui::text(" A round number is an integer that ends with one or more '0's. "),
+    ftxui::text(" Example: 592 is less round than 590 is less round than 600. "),
+    ftxui::text(""),
+  });
+  const auto tutorial_2_text = ftxui::vbox({
+    ftxui::text(""),
+    ftxui::text(" Tutorial: ") | ftxui::bold,
+    ftxui::hbox({
+      ftxui::text(" Go to the exit ⋒ and your "),
+      ftxui::text("score") | ftxui::color(Magenta),
+      ftxui::text(" for this level is calculated. "),
+    }),
+    ftxui::text(" With a non-round number like 592 you lose a life. "),
+    ftxui::hbox({
+      ftxui::text(" The game ends if your "),
+      ftxui::text("energy-value") | ftxui::color(Yellow),
+      ftxui::text(" or your "),
+      ftxui::text("lives") | ftxui::color(Red),
+      ftxui::text(" reach zero. "),
+    }),
+    ftxui::text(fmt::format(
+      " Each step and every {} seconds you lose one energy point. ", config::energy_decrement_time.count())),
+    ftxui::text(" You can regain energy with a good polish. "),
+    ftxui::text(fmt::format(" You need a minimum score of {} to win. ", config::min_win_score)),
+    ftxui::text(""),
+  });
+  const auto lost_text = ftxui::vbox({
+    ftxui::text(""),
+    ftxui::text(" You wake up feeling terrified. What a nightmare! "),
+    ftxui::text(" Later that day you fail the exam :C"),
+    ftxui::text(" You become a looser for the rest of your life."),
+    ftxui::text(""),
+  });
+  const auto won_text = ftxui::vbox({
+    ftxui::text(""),
+    ftxui::text(" You wake up feeling refreshed. What a great dream! "),
+    ftxui::text(" Later that day you pass the exam *.* "),
+    ftxui::text(" You become a master of your craft and live a smoothlife. "),
+    ftxui::text(""),
+  });
+
+  // a story text with the buttons below, on top of the game window
+  const auto overlay = [](ftxui::Element window, ftxui::Element story, ftxui::Elements rest) {
+    rest.insert(rest.begin(), std::move(story));
+    return ftxui::dbox({
+      std::move(window),
+      ftxui::vbox(std::move(rest)) | ftxui::borderDouble | ftxui::clear_under | ftxui::center,
+    });
+  };
 
   auto game_ui = ftxui::Renderer(container, [&] {
-    using enum ftxui::Color::Palette16;
-    if (board.stage == GameStage::game) { player.move_ui->TakeFocus(); }
+    const trace::Span span{ "render" };
+    const std::scoped_lock lock{ game_mutex };
+    if (board.stage == GameStage::game) { controls.move_ui->TakeFocus(); }
+    const Hint hint = hints ? hints->hint() : Hint{};
     auto window = ftxui::window(ftxui::text(" smoothlife ") | ftxui::hcenter | ftxui::bold,
       ftxui::hbox({
         ftxui::vbox({
-          ftxui::text(player.health()) | ftxui::hcenter | ftxui::color(RedLight) | ftxui::border,
+          health_view.get(player.lives,
+            [&] { return ftxui::text(player.health()) | ftxui::hcenter | ftxui::color(RedLight) | ftxui::border; }),
           ftxui::vbox({
             ftxui::hbox({
               ftxui::filler(),
-              player.move_ui->Render(),
+              controls.move_ui->Render(),
               ftxui::filler(),
             }),
-            ftxui::text(" try arrow keys!") | ftxui::color(GrayDark),
+            arrow_keys_hint,
+            history ? undo_keys_hint : ftxui::emptyElement(),
+            hints && board.stage == GameStage::game ? hint_view.get(hint, [&] { return render(hint); })
+                                                    : ftxui::emptyElement(),
           }) | ftxui::border
             | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, config::panel_width),
           ftxui::hbox({ quit_button->Render() }),
         }),
         ftxui::separator(),
-        board.render(),
+        board_view.render(board),
         ftxui::separator(),
         ftxui::vbox({
-          ftxui::hbox(
-            { ftxui::text(" energy  "), ftxui::text(fmt::format("{:>8}", player.energy)) | ftxui::color(Yellow) }),
-          ftxui::hbox(
-            { ftxui::text(" surface "), ftxui::text(fmt::format("{:>8}", player.surface)) | ftxui::color(Blue) }),
-          ftxui::hbox(
-            { ftxui::text(" score   "), ftxui::text(fmt::format("{:>8}", player.score)) | ftxui::color(Magenta) }),
-          log.render(),
-          ftxui::text(" legend:") | ftxui::color(GrayDark),
-          ftxui::hbox({
-            ftxui::text(" + ") | ftxui::bold | ftxui::color(RedLight),
-            ftxui::text(" − ") | ftxui::bold | ftxui::color(BlueLight),
-            ftxui::text(" × ") | ftxui::bold | ftxui::color(GreenLight),
-            ftxui::text(" ÷ ") | ftxui::bold | ftxui::color(YellowLight),
-          }),
+          ftxui::hbox({ energy_label, energy_view.get(player.energy, [&] {
+            return ftxui::text(fmt::format("{:>8}", player.energy)) | ftxui::color(Yellow);
+          }) }),
+          ftxui::hbox({ surface_label, surface_view.get(player.surface, [&] {
+            return ftxui::text(fmt::format("{:>8}", player.surface.to_string(Board::base))) | ftxui::color(Blue);
+          }) }),
+          ftxui::hbox({ score_label, score_view.get(player.score, [&] {
+            return ftxui::text(fmt::format("{:>8}", player.score)) | ftxui::color(Magenta);
+          }) }),
+          log_view.get(log.revision, [&] { return render(log); }),
+          legend,
         }),
       }));
 
     if (board.stage == GameStage::intro) {
-      window = ftxui::dbox({
-        window,
-        ftxui::vbox({
-          ftxui::text(""),
-          ftxui::text(" Buzzing thoughts: I'm feeling so burned out... "),
-          ftxui::text("     Ironic... my dream is to become a master polisher. "),
-          ftxui::text("     Making things smooth, shiny and round. "),
-          ftxui::text("     Why does my life have to be so rough then? "),
-          ftxui::text("     I'm afraid of failing the final exams tomorrow. "),
-          ftxui::text(""),
-          ftxui::text(" You fall asleep at your working desk. "),
-          ftxui::text(""),
-          ftxui::hbox({ continue_button->Render() }),
-        }) | ftxui::borderDouble
-          | ftxui::clear_under | ftxui::center,
-      });
+      window = overlay(std::move(window), intro_text, { ftxui::hbox({ continue_button->Render() }) });
     } else if (board.stage == GameStage::tutorial_1) {
-      window = ftxui::dbox({
-        window,
-        ftxui::vbox({
-          ftxui::text(""),
-          ftxui::text(" Airy voice: Stop pitying yourself, fool! "),
-          ftxui::text("     You're almost there! Keep on polishing! "),
-          ftxui::separator(),
-          ftxui::text(" Tutorial: ") | ftxui::bold,
-          ftxui::hbox({
-            ftxui::text(" Combine operations to make the "),
-            ftxui::text("surface-number") | ftxui::color(Blue),
-            ftxui::text(" as round as possible. "),
-          }),
-          ftxui::text(" A round number is an integer that ends with one or more '0's. "),
-          ftxui::text(" Example: 592 is less round than 590 is less round than 600. "),
-          ftxui::text(""),
-          ftxui::hbox({ continue_button->Render() }),
-        }) | ftxui::borderDouble
-          | ftxui::clear_under | ftxui::center,
-      });
+      window = overlay(std::move(window), tutorial_1_text, { ftxui::hbox({ continue_button->Render() }) });
     } else if (board.stage == GameStage::tutorial_2) {
-      window = ftxui::dbox({
-        window,
-        ftxui::vbox({
-          ftxui::text(""),
-          ftxui::text(" Tutorial: ") | ftxui::bold,
-          ftxui::hbox({
-            ftxui::text(" Go to the exit ⋒ and your "),
-            ftxui::text("score") | ftxui::color(Magenta),
-            ftxui::text(" for this level is calculated. "),
-          }),
-          ftxui::text(" With a non-round number like 592 you lose a life. "),
-          ftxui::hbox({
-            ftxui::text(" The game ends if your "),
-            ftxui::text("energy-value") | ftxui::color(Yellow),
-            ftxui::text(" or your "),
-            ftxui::text("lives") | ftxui::color(Red),
-            ftxui::text(" reach zero. "),
-          }),
-          ftxui::text(fmt::format(
-            " Each step and every {} seconds you lose one energy point. ", config::energy_decrement_time.count())),
-          ftxui::text(" You can regain energy with a good polish. "),
-          ftxui::text(fmt::format(" You need a minimum score of {} to win. ", config::min_win_score)),
-          ftxui::text(""),
-          ftxui::hbox({ continue_button->Render() }),
-        }) | ftxui::borderDouble
-          | ftxui::clear_under | ftxui::center,
-      });
+      window = overlay(std::move(window), tutorial_2_text, { ftxui::hbox({ continue_button->Render() }) });
     } else if (board.stage == GameStage::ending) {
-      if (player.score < config::min_win_score) {
-        window = ftxui::dbox({
-          window,
-          ftxui::vbox({
-            ftxui::text(""),
-            ftxui::text(" You wake up feeling terrified. What a nightmare! "),
-            ftxui::text(" Later that day you fail the exam :C"),
-            ftxui::text(" You become a looser for the rest of your life."),
-            ftxui::text(""),
-            ftxui::text(fmt::format(" Total score: {}", player.score)) | ftxui::hcenter | ftxui::bold,
-            ftxui::text(""),
-            ftxui::hbox({ quit_button->Render(), retry_button->Render() }),
-          }) | ftxui::borderDouble
-            | ftxui::clear_under | ftxui::center,
-        });
-      } else {
-        window = ftxui::dbox({
-          window,
-          ftxui::vbox({
-            ftxui::text(""),
-            ftxui::text(" You wake up feeling refreshed. What a great dream! "),
-            ftxui::text(" Later that day you pass the exam *.* "),
-            ftxui::text(" You become a master of your craft and live a smoothlife. "),
-            ftxui::text(""),
-            ftxui::text(fmt::format(" Total score: {}", player.score)) | ftxui::hcenter | ftxui::bold,
-            ftxui::text(""),
-            ftxui::hbox({ quit_button->Render(), retry_button->Render() }),
-          }) | ftxui::borderDouble
-            | ftxui::clear_under | ftxui::center,
+      window = overlay(std::move(window),
+        player.score < config::min_win_score ? lost_text : won_text,
+        {
+          ftxui::text(fmt::format(" Total score: {}", player.score)) | ftxui::hcenter | ftxui::bold,
+          ftxui::text(""),
+          ftxui::hbox({ quit_button->Render(), retry_button->Render() }),
         });
-      }
     }
 
-    return window;
+    return traced(std::move(window));
   });
 
   std::atomic<bool> refresh_ui_continue = true;
 
   // This thread exists to decrement player.energy every few seconds
   std::thread refresh_ui([&] {
+    trace::name_thread("energy");
     while (refresh_ui_continue) {
       std::this_thread::sleep_for(config::energy_decrement_time);
-      if (board.stage == GameStage::game) { player.energy -= 1; }
+      {
+        const trace::Span span{ "energy tick" };
+        const std::scoped_lock lock{ game_mutex };
+        if (board.stage == GameStage::game) {
+          player.energy -= 1;
+          if (history) { history->amend(); }
+          recording.record(ReplayEvent::tick);
+          update_hint();
+          save_game();
+        }
+      }
       screen.PostEvent(ftxui::Event::Custom);
     }
   });
@@ -180,6 +362,39 @@ void game_loop(bool skip_tutorial = false)
   screen.Loop(game_ui);
   refresh_ui_continue = false;
   refresh_ui.join();
+  save_recording();
+  if (telemetry) { telemetry->end(player.score, board.level, moves); }
+}
+
+void game_loop(const GameOptions &options)
+{
+  const bool game_board = options.width == config::board_width && options.height == config::board_height;
+  if ((!game_board || options.base != config::base)
+      && (options.pack != nullptr || !options.record.empty() || options.hints)) {
+    throw std::invalid_argument("level packs, replays and hints need the configured board size and base");
+  }
+  if (options.daily && (!game_board || options.base != config::base || options.pack != nullptr)) {
+    throw std::invalid_argument("the daily challenge is played on its own levels, the configured board and base");
+  }
+  if (options.daily && !options.record.empty()) {
+    throw std::invalid_argument("replays of the daily challenge are not supported");
+  }
+  if (!options.record.empty() && options.prng != prng_names[0]) {
+    throw std::invalid_argument("replays are verified with the default random engine");
+  }
+  if (!options.record.empty() && !options.save.empty()) {
+    throw std::invalid_argument("a replay has to start with its seed, it cannot record a saved session");
+  }
+  with_prng(options.prng, [&](auto engine) {
+    using Prng = typename decltype(engine)::type;
+    with_base(options.base, [&](auto base) {
+      if (game_board) {
+        game_loop<GameBoard<config::board_width, config::board_height, Prng, decltype(base)::value>>(options);
+      } else {
+        game_loop<SparseGameBoard<Prng, decltype(base)::value>>(options);
+      }
+    });
+  });
 }
 
 }// namespace smoothlife
@@ -190,12 +405,26 @@ int main(int argc, const char **argv)
     static constexpr auto USAGE =
       R"(
     Usage:
-          smoothlife
+          smoothlife [--pack=<file> [--seed=<s>]] [--record=<file>] [--hints] [--trace=<file>] [--telemetry=<file>]
+          smoothlife [--save=<file>] [--pack=<file> [--seed=<s>]] [--daily] [--hints] [--prng=<name>] [--trace=<file>] [--telemetry=<file>]
+          smoothlife [--width=<w> --height=<h>] [--base=<b>] [--prng=<name>] [--save=<file>] [--trace=<file>] [--telemetry=<file>]
           smoothlife --version
           smoothlife (-h | --help)
     Options:
-          -h --help     Show this screen.
-          --version     Show version.
+          -h --help        Show this screen.
+          --version        Show version.
+          --pack=<file>    Play the levels of a pack written by smoothlife_pack.
+          --seed=<s>       Seed of the pack to play, a random one of the pack if not given.
+          --daily          Play the built-in levels of today's challenge, the same for everybody.
+          --record=<file>  Write a replay of the session, smoothlife_replay verifies it.
+          --width=<w>      Board width, boards larger than the window scroll.
+          --height=<h>     Board height.
+          --base=<b>       Base to polish in: 2, 8, 10, 12 or 16, 10 if not given.
+          --prng=<name>    Random engine of the levels: ranlux24, xoshiro, pcg or philox, ranlux24 if not given.
+          --hints          Suggest the next move, found by a search in the background.
+          --trace=<file>   Write where the time of the session went as a Chrome trace, see ui.perfetto.dev.
+          --save=<file>    Resume the session saved in the file and keep saving it after every move.
+          --telemetry=<file>  Append the levels and moves of every session, smoothlife_telemetry sums them up.
 )";
 
     auto args = docopt::docopt(USAGE,
@@ -203,8 +432,44 @@ int main(int argc, const char **argv)
       true,
       fmt::format("{} {}", smoothlife::cmake::project_name, smoothlife::cmake::project_version));
 
+    smoothlife::GameOptions options;
+    std::optional<smoothlife::LevelPack> pack;
+    if (args["--pack"]) {
+      pack.emplace(args["--pack"].asString());
+      const auto &info = pack->info();
+      options.pack = &*pack;
+      options.pack_seed = args["--seed"]
+                            ? static_cast<std::uint64_t>(args["--seed"].asLong())
+                            : info.first_seed + std::random_device{}() % std::max<std::uint64_t>(1, info.seeds);
+    }
+    options.daily = args["--daily"].asBool();
+    if (args["--record"]) { options.record = args["--record"].asString(); }
+    if (args["--save"]) { options.save = args["--save"].asString(); }
+    if (args["--width"]) {
+      options.width = static_cast<std::size_t>(args["--width"].asLong());
+      options.height = static_cast<std::size_t>(args["--height"].asLong());
+    }
+    options.hints = args["--hints"].asBool();
+    if (args["--base"]) { options.base = static_cast<int>(args["--base"].asLong()); }
+    if (args["--prng"]) { options.prng = args["--prng"].asString(); }
+
+    if (args["--trace"]) {
+      smoothlife::trace::start();
+      smoothlife::trace::name_thread("ui");
+    }
+
+    std::optional<smoothlife::TelemetryWriter> telemetry;
+    if (args["--telemetry"]) {
+      telemetry.emplace(args["--telemetry"].asString());
+      options.telemetry = &*telemetry;
+    }
+
     // start the game
-    smoothlife::game_loop();
+    smoothlife::game_loop(options);
+
+    if (telemetry) { telemetry->finish(); }
+
+    if (args["--trace"]) { smoothlife::trace::write(args["--trace"].asString()); }
 
   } catch (const std::exception &e) {
     SPDLOG_ERROR("Unhandled exception in main: {}", e.what());
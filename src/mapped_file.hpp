@@ -0,0 +1,143 @@
+#ifndef SMOOTHLIFE_MAPPED_FILE_HPP
+#define SMOOTHLIFE_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace smoothlife {
+
+/**
+ * @brief read only memory mapping of a whole file
+ *
+ * The operating system pages the file in on first access and shares the pages between processes, so
+ * opening is cheap no matter the file size.
+ */
+class MappedFile
+{
+public:
+  MappedFile() = default;
+
+  explicit MappedFile(const std::filesystem::path &path) { open(path); }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other) noexcept
+    : data{ std::exchange(other.data, nullptr) }, length{ std::exchange(other.length, 0) }
+  {}
+
+  MappedFile &operator=(MappedFile &&other) noexcept
+  {
+    if (this != &other) {
+      close();
+      data = std::exchange(other.data, nullptr);
+      length = std::exchange(other.length, 0);
+    }
+    return *this;
+  }
+
+  ~MappedFile() { close(); }
+
+  [[nodiscard]] std::span<const std::byte> bytes() const { return { data, length }; }
+
+  [[nodiscard]] std::size_t size() const { return length; }
+
+private:
+  const std::byte *data = nullptr;
+  std::size_t length = 0;
+
+  [[noreturn]] static void fail(const std::filesystem::path &path, const char *what)
+  {
+    throw std::runtime_error(std::string{ "cannot " } + what + " " + path.string());
+  }
+
+#ifdef _WIN32
+  void open(const std::filesystem::path &path)
+  {
+    HANDLE file =
+      CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { fail(path, "open"); }
+
+    LARGE_INTEGER file_size{};
+    if (!GetFileSizeEx(file, &file_size)) {
+      CloseHandle(file);
+      fail(path, "stat");
+    }
+    length = static_cast<std::size_t>(file_size.QuadPart);
+    if (length == 0) {
+      CloseHandle(file);
+      return;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) { fail(path, "map"); }
+
+    data = static_cast<const std::byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    CloseHandle(mapping);
+    if (data == nullptr) { fail(path, "map"); }
+  }
+
+  void close()
+  {
+    if (data != nullptr) { UnmapViewOfFile(data); }
+    data = nullptr;
+    length = 0;
+  }
+#else
+  void open(const std::filesystem::path &path)
+  {
+    const int file = ::open(path.c_str(), O_RDONLY);// NOLINT(cppcoreguidelines-pro-type-vararg)
+    if (file < 0) { fail(path, "open"); }
+
+    struct stat status
+    {
+    };
+    if (::fstat(file, &status) != 0) {
+      ::close(file);
+      fail(path, "stat");
+    }
+    length = static_cast<std::size_t>(status.st_size);
+    if (length == 0) {
+      ::close(file);
+      return;
+    }
+
+    void *mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, file, 0);
+    ::close(file);
+    if (mapping == MAP_FAILED) {// NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+      length = 0;
+      fail(path, "map");
+    }
+    data = static_cast<const std::byte *>(mapping);
+  }
+
+  void close()
+  {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    if (data != nullptr) { ::munmap(const_cast<std::byte *>(data), length); }
+    data = nullptr;
+    length = 0;
+  }
+#endif
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_MAPPED_FILE_HPP
@@ -0,0 +1,91 @@
+#include "config.hpp"
+#include "level_pack.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#include <docopt/docopt.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <internal_use_only/config.hpp>
+
+namespace smoothlife {
+
+int write_pack(const std::string &path,
+  std::uint64_t first_seed,
+  std::uint64_t seeds,
+  int first_level,
+  int levels,
+  std::size_t threads)
+{
+  ThreadPool pool{ threads };
+
+  const auto start = std::chrono::steady_clock::now();
+  write_level_pack<config::board_width, config::board_height>(path, pool, first_seed, seeds, first_level, levels);
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  const std::uint64_t records = seeds * static_cast<std::uint64_t>(std::max(levels, 0));
+  fmt::print("smoothlife_pack: {} records written to {}, {} threads\n", records, path, pool.size());
+  fmt::print("  time        {:>12.3f} s\n", elapsed.count());
+  fmt::print("  records/sec {:>12.0f}\n", static_cast<double>(records) / elapsed.count());
+  return 0;
+}
+
+int print_info(const std::string &path)
+{
+  const LevelPack pack{ path };
+  const auto &info = pack.info();
+  fmt::print("{}: level pack version {}\n", path, info.version);
+  fmt::print("  board   {}x{}\n", info.width, info.height);
+  fmt::print("  seeds   {}..{}\n", info.first_seed, info.first_seed + info.seeds - 1);
+  fmt::print("  levels  {}..{}\n", info.first_level, info.first_level + info.levels - 1);
+  fmt::print("  record  {} bytes\n", info.record_size);
+  return 0;
+}
+
+}// namespace smoothlife
+
+int main(int argc, const char **argv)
+{
+  try {
+    static constexpr auto USAGE =
+      R"(
+    Usage:
+          smoothlife_pack <file> [--seeds=<n>] [--first-seed=<s>] [--levels=<l>] [--first-level=<f>] [--threads=<t>]
+          smoothlife_pack --info <file>
+          smoothlife_pack --version
+          smoothlife_pack (-h | --help)
+    Options:
+          -h --help          Show this screen.
+          --version          Show version.
+          --seeds=<n>        Number of seeds in the pack [default: 1000].
+          --first-seed=<s>   First seed of the pack [default: 1].
+          --levels=<l>       Number of levels per seed [default: 50].
+          --first-level=<f>  First level of every seed [default: 0].
+          --threads=<t>      Worker threads, 0 uses every core [default: 0].
+          --info             Describe an existing pack instead of writing one.
+)";
+
+    auto args = docopt::docopt(USAGE,
+      { std::next(argv), std::next(argv, argc) },
+      true,
+      fmt::format("{} {}", smoothlife::cmake::project_name, smoothlife::cmake::project_version));
+
+    const std::string path = args["<file>"].asString();
+    if (args["--info"].asBool()) { return smoothlife::print_info(path); }
+
+    return smoothlife::write_pack(path,
+      static_cast<std::uint64_t>(args["--first-seed"].asLong()),
+      static_cast<std::uint64_t>(args["--seeds"].asLong()),
+      static_cast<int>(args["--first-level"].asLong()),
+      static_cast<int>(args["--levels"].asLong()),
+      static_cast<std::size_t>(args["--threads"].asLong()));
+
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("Unhandled exception in main: {}", e.what());
+    return 1;
+  }
+}
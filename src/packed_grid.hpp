@@ -0,0 +1,236 @@
+#ifndef SMOOTHLIFE_PACKED_GRID_HPP
+#define SMOOTHLIFE_PACKED_GRID_HPP
+
+#include "field.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace smoothlife {
+
+// a field in one byte, the type in the high and the value in the low four bits, values of every base fit
+constexpr std::uint8_t pack_field(Field field)
+{
+  if (field.value < 0 || field.value > 15) { throw std::out_of_range("field value does not fit into four bits"); }
+  // an empty field is 0, whatever its value
+  if (field.type == Field::Type::empty) { return 0; }
+  return static_cast<std::uint8_t>((static_cast<unsigned>(field.type) << 4U) | static_cast<unsigned>(field.value));
+}
+
+constexpr Field unpack_field(std::uint8_t byte) { return { static_cast<Field::Type>(byte >> 4U), byte & 0xF }; }
+
+namespace detail {
+
+  inline constexpr std::uint64_t byte_lows = 0x0101010101010101U;
+  inline constexpr std::uint64_t byte_highs = 0x8080808080808080U;
+
+  // the high bit of every byte of the word that is not 0, exact for all bytes, no carry crosses into the next one
+  constexpr std::uint64_t nonzero_bytes(std::uint64_t word)
+  {
+    constexpr std::uint64_t low_bits = ~byte_highs;
+    return (((word & low_bits) + low_bits) | word) & byte_highs;
+  }
+
+  // bit i is the high bit of byte i, the multiplication moves the eight high bits next to each other
+  constexpr std::uint64_t gather_highs(std::uint64_t highs) { return ((highs >> 7U) * 0x0102040810204080U) >> 56U; }
+
+}// namespace detail
+
+/**
+ * @brief all fields of a fixed size board in one byte each, eight of them to a word
+ *
+ * An eighth of the memory of a FixedGrid, the 7x5 board of the game is five words. Queries of the whole board
+ * compare eight fields at once with a few bit operations on a word (SWAR), so they need no instruction set
+ * beyond 64 bit integers, work in constant expressions and compilers vectorize the loop over the words further.
+ * Bytes past the last cell stay 0. get() returns fields by value, there is no Field to refer to.
+ */
+template<std::size_t Width, std::size_t Height> struct PackedGrid
+{
+  static constexpr bool fixed_size = true;
+  static constexpr std::size_t word_count = (Width * Height + 7) / 8;
+
+  // one bit per cell, cell i is bit i % 64 of word i / 64
+  using CellMask = std::array<std::uint64_t, (Width * Height + 63) / 64>;
+
+  std::array<std::uint64_t, word_count> words{};
+
+  PackedGrid() = default;
+
+  // for code that sizes every kind of grid at runtime
+  PackedGrid(std::size_t width, std::size_t height)
+  {
+    if (width != Width || height != Height) { throw std::invalid_argument("the grid size is fixed"); }
+  }
+
+  static constexpr std::size_t index(int x, int y)
+  {
+    return static_cast<std::size_t>(x) + Width * static_cast<std::size_t>(y);
+  }
+
+  [[nodiscard]] static constexpr std::size_t width() { return Width; }
+
+  [[nodiscard]] static constexpr std::size_t height() { return Height; }
+
+  [[nodiscard]] static constexpr std::size_t size() { return Width * Height; }
+
+  [[nodiscard]] constexpr Field get(int x, int y) const { return unpack_field(byte(checked(x, y))); }
+
+  constexpr void set(int x, int y, Field field)
+  {
+    const std::size_t i = checked(x, y);
+    const unsigned shift = 8U * (i % 8);
+    std::uint64_t &word = words[i / 8];
+    word = (word & ~(std::uint64_t{ 0xFF } << shift)) | std::uint64_t{ pack_field(field) } << shift;
+  }
+
+  constexpr void clear() { words = {}; }
+
+  [[nodiscard]] constexpr Field operator[](std::size_t i) const { return unpack_field(byte(i)); }
+
+  [[nodiscard]] constexpr std::uint8_t byte(std::size_t i) const
+  {
+    return static_cast<std::uint8_t>(words[i / 8] >> (8U * (i % 8)));
+  }
+
+  // row by row, visiting only the occupied cells
+  template<class Visit> constexpr void for_each_field(Visit &&visit) const
+  {
+    for_each_cell(occupied(), [&](std::size_t i) {
+      visit(static_cast<int>(i % Width), static_cast<int>(i / Width), (*this)[i]);
+    });
+  }
+
+  // cells holding a field of the type, the empty type gives the free cells
+  [[nodiscard]] constexpr CellMask cells_of(Field::Type type) const
+  {
+    return gather([type](std::uint64_t word) { return ~other_types(word, type); });
+  }
+
+  [[nodiscard]] constexpr CellMask occupied() const
+  {
+    return gather([](std::uint64_t word) { return detail::nonzero_bytes(word); });
+  }
+
+  // cells holding an operation, neither empty nor the exit
+  [[nodiscard]] constexpr CellMask operations() const
+  {
+    return gather(
+      [](std::uint64_t word) { return detail::nonzero_bytes(word) & other_types(word, Field::Type::exit); });
+  }
+
+  [[nodiscard]] constexpr std::size_t count(Field::Type type) const
+  {
+    std::size_t n = 0;
+    for (const std::uint64_t bits : cells_of(type)) { n += static_cast<std::size_t>(std::popcount(bits)); }
+    return n;
+  }
+
+  // the cell of the mask fewest steps away from x, y on an empty board, the first one of a tie, size() for none
+  [[nodiscard]] constexpr std::size_t nearest(int x, int y, const CellMask &cells) const
+  {
+    std::size_t found = size();
+    std::size_t best = Width + Height;
+    const auto take = [&](std::size_t i, int cx, int cy) {
+      const auto steps = static_cast<std::size_t>((cx < x ? x - cx : cx - x) + (cy < y ? y - cy : cy - y));
+      if (steps < best) {
+        best = steps;
+        found = i;
+      }
+    };
+
+    if constexpr (Width > 64) {
+      for_each_cell(cells, [&](std::size_t i) { take(i, static_cast<int>(i % Width), static_cast<int>(i / Width)); });
+    } else {
+      // a row at a time, its closest cells are the first one from x on and the last one before
+      const auto column = static_cast<unsigned>(std::clamp(x, 0, static_cast<int>(Width)));
+      for (std::size_t row = 0; row < Height; ++row) {
+        const std::uint64_t bits = row_bits(cells, row);
+        if (bits == 0) { continue; }
+        const auto cy = static_cast<int>(row);
+        const std::uint64_t before = column == 64 ? bits : bits & ((std::uint64_t{ 1 } << column) - 1);
+        if (before != 0) {
+          const int cx = static_cast<int>(std::bit_width(before)) - 1;
+          take(row * Width + static_cast<std::size_t>(cx), cx, cy);
+        }
+        const std::uint64_t after = bits ^ before;
+        if (after != 0) {
+          const int cx = std::countr_zero(after);
+          take(row * Width + static_cast<std::size_t>(cx), cx, cy);
+        }
+      }
+    }
+    return found;
+  }
+
+  // hash of all fields for transposition tables, grids holding the same fields hash the same
+  [[nodiscard]] constexpr std::uint64_t checksum() const
+  {
+    std::uint64_t hash = 0x9e3779b97f4a7c15U;
+    for (const std::uint64_t word : words) {
+      hash = (hash ^ word) * 0xbf58476d1ce4e5b9U;
+      hash ^= hash >> 31U;
+    }
+    return hash;
+  }
+
+  // calls visit(i) for every cell of the mask, in order
+  template<class Visit> static constexpr void for_each_cell(const CellMask &cells, Visit &&visit)
+  {
+    for (std::size_t w = 0; w < cells.size(); ++w) {
+      for (std::uint64_t bits = cells[w]; bits != 0; bits &= bits - 1) {
+        visit(w * 64 + static_cast<std::size_t>(std::countr_zero(bits)));
+      }
+    }
+  }
+
+private:
+  constexpr std::size_t checked(int x, int y) const
+  {
+    if (x < 0 || y < 0 || static_cast<std::size_t>(x) >= Width || static_cast<std::size_t>(y) >= Height) {
+      throw std::out_of_range("cell outside of the grid");
+    }
+    return index(x, y);
+  }
+
+  // the cells of the row of the mask, the first one in bit 0
+  static constexpr std::uint64_t row_bits(const CellMask &cells, std::size_t row)
+  {
+    const std::size_t first = row * Width;
+    const unsigned shift = first % 64;
+    std::uint64_t bits = cells[first / 64] >> shift;
+    if (shift + Width > 64) { bits |= cells[first / 64 + 1] << (64 - shift); }
+    if constexpr (Width < 64) { bits &= (std::uint64_t{ 1 } << Width) - 1; }
+    return bits;
+  }
+
+  // the high bit of every byte of the word holding a field of another type than the given one
+  static constexpr std::uint64_t other_types(std::uint64_t word, Field::Type type)
+  {
+    const std::uint64_t pattern = detail::byte_lows * (static_cast<std::uint64_t>(type) << 4U);
+    return detail::nonzero_bytes((word ^ pattern) & (detail::byte_lows * 0xF0U));
+  }
+
+  // the cells of every word whose byte has its high bit set by highs, cells past the board dropped
+  template<class Highs> constexpr CellMask gather(Highs &&highs) const
+  {
+    CellMask mask{};
+    for (std::size_t m = 0; m < mask.size(); ++m) {
+      // eight words to a mask word, collected in a register rather than or-ed into memory one by one
+      std::uint64_t bits = 0;
+      for (std::size_t w = m * 8; w < std::min(word_count, m * 8 + 8); ++w) {
+        bits |= detail::gather_highs(highs(words[w]) & detail::byte_highs) << (8U * (w % 8));
+      }
+      mask[m] = bits;
+    }
+    if constexpr (size() % 64 != 0) { mask.back() &= (std::uint64_t{ 1 } << (size() % 64)) - 1; }
+    return mask;
+  }
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_PACKED_GRID_HPP
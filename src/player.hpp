@@ -2,14 +2,26 @@
 #define SMOOTHLIFE_PLAYER_HPP
 
 #include "config.hpp"
+#include "surface.hpp"
 
 namespace smoothlife {
 
+enum struct Direction : int { up = 0, left = 1, down = 2, right = 3 };
+
+// inclusive movement area, same layout as ftxui::Box
+struct Bounds
+{
+  int x_min = 0;
+  int x_max = 0;
+  int y_min = 0;
+  int y_max = 0;
+};
+
 struct Player
 {
   int x = 0;
   int y = 0;
-  long surface = 0;
+  Surface surface = 0;
   int score = 0;
   int steps = 0;
   int energy = config::player_energy;
@@ -17,11 +29,7 @@ struct Player
 
   // set by GameBoard
   std::function<void()> interaction;
-  ftxui::Box bounds;
-
-  // player control ui
-  ftxui::Components buttons;
-  ftxui::Component move_ui;
+  Bounds bounds;
 
   [[nodiscard]] std::string health() const
   {
@@ -37,74 +45,55 @@ struct Player
     return health_str;
   }
 
-  Player()
+  [[nodiscard]] bool can_move(Direction dir) const
   {
-    buttons.push_back(ftxui::Button(" ᐃ ", [&] {
-      if (y < bounds.y_max && energy > 0) {
-        y++;
-        energy--;
-        interaction();
-      }
-    }));
-    buttons.push_back(ftxui::Button(" ᐊ ", [&] {
-      if (x > bounds.x_min && energy > 0) {
-        x--;
-        energy--;
-        interaction();
-      }
-    }));
-    buttons.push_back(ftxui::Button(" ᐁ ", [&] {
-      if (y > bounds.y_min && energy > 0) {
-        y--;
-        energy--;
-        interaction();
-      }
-    }));
-    buttons.push_back(ftxui::Button(" ᐅ ", [&] {
-      if (x < bounds.x_max && energy > 0) {
-        x++;
-        energy--;
-        interaction();
-      }
-    }));
+    if (energy <= 0) { return false; }
+    switch (dir) {
+    case Direction::up:
+      return y < bounds.y_max;
+    case Direction::left:
+      return x > bounds.x_min;
+    case Direction::down:
+      return y > bounds.y_min;
+    case Direction::right:
+      return x < bounds.x_max;
+    }
+    return false;
+  }
 
-    move_ui = ftxui::Container::Vertical({
-      ftxui::Renderer(buttons[0],
-        [&] {
-          return ftxui::hbox({
-            ftxui::filler(),
-            buttons[0]->Render(),
-            ftxui::filler(),
-          });
-        }),
-      ftxui::Container::Horizontal({
-        buttons[1],
-        buttons[2],
-        buttons[3],
-      }),
-    });
+  // take one step, costs one energy and triggers the interaction with the new field
+  bool move(Direction dir)
+  {
+    if (!can_move(dir)) { return false; }
+    switch (dir) {
+    case Direction::up:
+      y++;
+      break;
+    case Direction::left:
+      x--;
+      break;
+    case Direction::down:
+      y--;
+      break;
+    case Direction::right:
+      x++;
+      break;
+    }
+    energy--;
+    if (interaction) { interaction(); }
+    return true;
+  }
 
-    // use arrow keys as hotkeys for movement
-    move_ui = ftxui::CatchEvent(move_ui, [&](const ftxui::Event &event) {
-      if (event == ftxui::Event::ArrowUp) {
-        buttons[0]->TakeFocus();
-        buttons[0]->OnEvent(ftxui::Event::Return);
-        return true;
-      } else if (event == ftxui::Event::ArrowLeft) {
-        buttons[1]->TakeFocus();
-        buttons[1]->OnEvent(ftxui::Event::Return);
-        return true;
-      } else if (event == ftxui::Event::ArrowDown) {
-        buttons[2]->TakeFocus();
-        buttons[2]->OnEvent(ftxui::Event::Return);
-        return true;
-      } else if (event == ftxui::Event::ArrowRight) {
-        buttons[3]->TakeFocus();
-        buttons[3]->OnEvent(ftxui::Event::Return);
-        return true;
-      }
-      return false;
-    });
+  // restore the stats of a fresh game, keeps interaction and bounds
+  void reset()
+  {
+    x = 0;
+    y = 0;
+    surface = 0;
+    score = 0;
+    steps = 0;
+    energy = config::player_energy;
+    lives = config::player_lives;
   }
 };
 
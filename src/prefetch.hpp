@@ -0,0 +1,206 @@
+#ifndef SMOOTHLIFE_PREFETCH_HPP
+#define SMOOTHLIFE_PREFETCH_HPP
+
+#include "trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+namespace smoothlife {
+
+struct PrefetchStats
+{
+  // levels that were built ahead, waits counts those the board still had to wait for
+  std::uint64_t hits = 0;
+  std::uint64_t waits = 0;
+  // levels the board built itself
+  std::uint64_t misses = 0;
+  // time taking a prefetched level, wait included, and time building a missed one
+  std::chrono::nanoseconds swap_time{};
+  std::chrono::nanoseconds max_swap_time{};
+  std::chrono::nanoseconds miss_time{};
+};
+
+/**
+ * @brief builds the levels a board may need next on a worker thread, before the player reaches the exit
+ *
+ * Leaving through the exit either starts the next level or, with a rough surface, a fresh one of the same
+ * level, both drawn from the board's engine as it is now. The worker builds both from a copy of the engine
+ * while the level is played. generate_level() then swaps the grid and the engine of the matching one into the
+ * board, a fixed amount of work for every size of level, instead of building it in the middle of a move.
+ *
+ * A level is only taken when its level number and the engine it started from equal the board's, so the
+ * levels are exactly those of a board without a prefetcher, and a level the worker did not build is built on
+ * the board's thread as before. Snapshots, packs and replays need no care. The board has to outlive the
+ * prefetcher and is only touched by the thread that calls generate_level().
+ */
+template<class Board> class LevelPrefetcher
+{
+public:
+  using Grid = typename Board::grid_type;
+  using Prng = typename Board::random_engine;
+
+  explicit LevelPrefetcher(Board &b)
+    : board{ b }, scratch{ empty_level(b), empty_level(b) }, ready{ empty_level(b), empty_level(b) },
+      worker{ [this](const std::stop_token &stop) { work(stop); } }
+  {
+    board.level_source = [this] { return take(); };
+    {
+      const std::scoped_lock lock{ mutex };
+      request();
+    }
+    wake.notify_one();
+  }
+
+  LevelPrefetcher(const LevelPrefetcher &) = delete;
+  LevelPrefetcher(LevelPrefetcher &&) = delete;
+  LevelPrefetcher &operator=(const LevelPrefetcher &) = delete;
+  LevelPrefetcher &operator=(LevelPrefetcher &&) = delete;
+
+  ~LevelPrefetcher()
+  {
+    board.level_source = nullptr;
+    worker.request_stop();
+  }
+
+  [[nodiscard]] PrefetchStats stats() const
+  {
+    const std::scoped_lock lock{ mutex };
+    return counters;
+  }
+
+  // blocks until the levels of the next exit are built
+  void wait() const
+  {
+    std::unique_lock lock{ mutex };
+    built.wait(lock, [this] { return !pending && !building; });
+  }
+
+private:
+  // a level as generate_level() leaves it, with the engine it was drawn from before and after
+  struct Level
+  {
+    Grid grid;
+    int level = 0;
+    Prng before{};
+    Prng after{};
+    long surface = 0;
+    bool valid = false;
+  };
+
+  struct Request
+  {
+    int level = 0;
+    Prng engine{};
+  };
+
+  using Clock = std::chrono::steady_clock;
+
+  static Level empty_level(const Board &b) { return { Grid{ b.width(), b.height() } }; }
+
+  Board &board;
+  // the worker builds into scratch and swaps it with ready under the lock
+  std::array<Level, 2> scratch;
+  std::array<Level, 2> ready;
+  PrefetchStats counters;
+
+  mutable std::mutex mutex;
+  mutable std::condition_variable_any wake;
+  mutable std::condition_variable_any built;
+  std::optional<Request> pending;
+  // the request the worker is on, while it is building
+  std::optional<Request> building;
+
+  // builds the levels of the pending request into scratch
+  std::jthread worker;
+
+  // board.level_source
+  long take()
+  {
+    const auto start = Clock::now();
+    std::unique_lock lock{ mutex };
+    // the worker is on this very exit, the rest of its work is less than all of it
+    if (building && building->engine == board.rnd
+        && (building->level == board.level || building->level + 1 == board.level)) {
+      ++counters.waits;
+      built.wait(lock, [this] { return !building; });
+    }
+
+    for (Level &candidate : ready) {
+      if (!candidate.valid || candidate.level != board.level || candidate.before != board.rnd) { continue; }
+      using std::swap;
+      swap(board.state, candidate.grid);
+      board.rnd = candidate.after;
+      const long surface = candidate.surface;
+      request();
+
+      const auto took = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+      ++counters.hits;
+      counters.swap_time += took;
+      counters.max_swap_time = std::max(counters.max_swap_time, took);
+      lock.unlock();
+      // woken only now, so the worker does not have to wait for the lock while the board is swapping
+      wake.notify_one();
+      return surface;
+    }
+
+    lock.unlock();
+    const long surface = Board::build_level(board.state, board.rnd, board.level);
+    lock.lock();
+    request();
+    ++counters.misses;
+    counters.miss_time += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+    lock.unlock();
+    wake.notify_one();
+    return surface;
+  }
+
+  // the levels after the one the board holds now, under the lock, the worker needs a notify afterwards
+  void request()
+  {
+    for (Level &candidate : ready) { candidate.valid = false; }
+    pending = Request{ board.level, board.rnd };
+  }
+
+  void work(const std::stop_token &stop)
+  {
+    trace::name_thread("prefetch");
+    std::unique_lock lock{ mutex };
+    while (wake.wait(lock, stop, [this] { return pending.has_value(); })) {
+      building = std::move(pending);
+      pending.reset();
+      lock.unlock();
+
+      {
+        const trace::Span span{ "prefetch levels" };
+        // the next level after a round surface, the same one again after a rough one
+        for (std::size_t i = 0; i < scratch.size(); ++i) {
+          Level &level = scratch[i];
+          level.level = building->level + (i == 0 ? 1 : 0);
+          level.before = building->engine;
+          level.after = building->engine;
+          level.surface = Board::build_level(level.grid, level.after, level.level);
+          level.valid = true;
+        }
+      }
+
+      lock.lock();
+      // a newer request makes these stale
+      if (!pending) { std::swap(scratch, ready); }
+      building.reset();
+      built.notify_all();
+    }
+  }
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_PREFETCH_HPP
@@ -0,0 +1,211 @@
+#ifndef SMOOTHLIFE_PROTOCOL_HPP
+#define SMOOTHLIFE_PROTOCOL_HPP
+
+#include "config.hpp"
+#include "gameboard.hpp"
+#include "log.hpp"
+#include "player.hpp"
+#include "random.hpp"
+#include "surface.hpp"
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+
+namespace smoothlife {
+
+/*
+ * Wire format of the game server. A client sends fixed size requests and gets one reply of fixed size for
+ * every request, in order, so neither side ever parses a length. Integers are little endian.
+ */
+
+struct ClientFrame
+{
+  enum struct Type : std::uint8_t {
+    // a new game of the seed, from level 0 in the game stage
+    start = 1,
+    // one step in direction
+    move = 2,
+    // the state as it is, with the energy the timer took since
+    state = 3,
+    // a ServerStatsFrame of the whole server
+    stats = 4
+  };
+
+  Type type = Type::state;
+  // a Direction
+  std::uint8_t direction = 0;
+  std::array<std::uint8_t, 6> reserved{};
+  std::uint64_t seed = 0;
+};
+
+static_assert(sizeof(ClientFrame) == 16);
+static_assert(std::is_trivially_copyable_v<ClientFrame>);
+
+struct ServerFrame
+{
+  enum struct Type : std::uint8_t { state = 1, stats = 2 };
+  enum struct Status : std::uint8_t {
+    ok = 0,
+    // the move was not possible, nothing changed
+    rejected = 1,
+    // no game was started on this connection yet
+    no_game = 2,
+    unknown_request = 3
+  };
+
+  static constexpr std::uint8_t wide_surface = 1U << 0U;
+  static constexpr std::size_t cells = config::board_width * config::board_height;
+
+  Type type = Type::state;
+  Status status = Status::ok;
+  // a GameStage
+  std::uint8_t stage = 0;
+  std::uint8_t lives = 0;
+  std::uint8_t x = 0;
+  std::uint8_t y = 0;
+  std::uint8_t roundness = 0;
+  std::uint8_t flags = 0;
+  std::int32_t energy = 0;
+  std::int32_t score = 0;
+  std::int32_t level = 0;
+  std::int32_t steps = 0;
+  // 0 with wide_surface set when it does not fit, roundness is exact either way
+  std::int64_t surface = 0;
+  // row by row from the bottom, type * 16 + value
+  std::array<std::uint8_t, cells> fields{};
+  std::array<std::uint8_t, 80 - 32 - cells> reserved{};
+
+  bool operator==(const ServerFrame &) const = default;
+};
+
+static_assert(sizeof(ServerFrame) == 80);
+static_assert(std::is_trivially_copyable_v<ServerFrame>);
+
+// the reply to ClientFrame::Type::stats, as long as a ServerFrame
+struct ServerStatsFrame
+{
+  ServerFrame::Type type = ServerFrame::Type::stats;
+  std::array<std::uint8_t, 7> reserved{};
+  // connections open now
+  std::uint64_t sessions = 0;
+  // connections since the start
+  std::uint64_t connections = 0;
+  std::uint64_t games = 0;
+  std::uint64_t moves = 0;
+  // cpu time of the event loop threads
+  std::uint64_t cpu_ns = 0;
+  std::uint64_t threads = 0;
+  std::array<std::uint8_t, 24> padding{};
+};
+
+static_assert(sizeof(ServerStatsFrame) == sizeof(ServerFrame));
+static_assert(std::is_trivially_copyable_v<ServerStatsFrame>);
+
+/**
+ * @brief the game behind one connection
+ *
+ * The rules of the configured board without any frontend, driven by client frames and energy ticks. A new
+ * game resets the objects in place, a connection keeps one for its whole life.
+ */
+class ServerGame
+{
+public:
+  ServerGame() = default;
+
+  // the board keeps references into this object
+  ServerGame(const ServerGame &) = delete;
+  ServerGame(ServerGame &&) = delete;
+  ServerGame &operator=(const ServerGame &) = delete;
+  ServerGame &operator=(ServerGame &&) = delete;
+  ~ServerGame() = default;
+
+  // start, move and state, stats are the server's
+  ServerFrame handle(const ClientFrame &request)
+  {
+    ServerFrame::Status status = ServerFrame::Status::ok;
+    switch (request.type) {
+    case ClientFrame::Type::start:
+      start(request.seed);
+      break;
+    case ClientFrame::Type::move:
+      if (!started) {
+        status = ServerFrame::Status::no_game;
+      } else if (request.direction > static_cast<std::uint8_t>(Direction::right) || board.stage != GameStage::game
+                 || !player.move(static_cast<Direction>(request.direction))) {
+        status = ServerFrame::Status::rejected;
+      } else {
+        ++moves;
+      }
+      break;
+    case ClientFrame::Type::state:
+      if (!started) { status = ServerFrame::Status::no_game; }
+      break;
+    default:
+      status = ServerFrame::Status::unknown_request;
+      break;
+    }
+    return state(status);
+  }
+
+  // the energy timer of the game, only runs down in the game stage
+  void tick()
+  {
+    if (started && board.stage == GameStage::game) { player.energy -= 1; }
+  }
+
+  void reset() { started = false; }
+
+  [[nodiscard]] ServerFrame state(ServerFrame::Status status = ServerFrame::Status::ok) const
+  {
+    ServerFrame frame;
+    frame.status = status;
+    if (!started) { return frame; }
+    frame.stage = static_cast<std::uint8_t>(board.stage);
+    frame.lives = static_cast<std::uint8_t>(player.lives);
+    frame.x = static_cast<std::uint8_t>(player.x);
+    frame.y = static_cast<std::uint8_t>(player.y);
+    frame.roundness = static_cast<std::uint8_t>(roundness<config::base>(player.surface));
+    frame.energy = player.energy;
+    frame.score = player.score;
+    frame.level = board.level;
+    frame.steps = player.steps;
+    if (player.surface.representation() == Surface::Representation::small) {
+      frame.surface = player.surface.to_long();
+    } else {
+      frame.flags |= ServerFrame::wide_surface;
+    }
+    for (std::size_t i = 0; i < frame.fields.size(); ++i) {
+      const Field &field = board.state[i];
+      frame.fields[i] = static_cast<std::uint8_t>(static_cast<int>(field.type) * 16 + field.value);
+    }
+    return frame;
+  }
+
+  // successful moves of all games
+  [[nodiscard]] std::uint64_t moved() const { return moves; }
+
+private:
+  Player player;
+  Log log{ config::log_length };
+  std::ranlux24 prng;
+  GameBoard<config::board_width, config::board_height, std::ranlux24> board{ prng, player, log };
+  bool started = false;
+  std::uint64_t moves = 0;
+
+  void start(std::uint64_t seed)
+  {
+    seed_prng(prng, seed);
+    player.reset();
+    log.clear();
+    board.level = 0;
+    board.stage = GameStage::game;
+    board.next_level();
+    started = true;
+  }
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_PROTOCOL_HPP
@@ -0,0 +1,361 @@
+#ifndef SMOOTHLIFE_RANDOM_HPP
+#define SMOOTHLIFE_RANDOM_HPP
+
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace smoothlife {
+
+/*
+ * Random engines for the Prng parameter of the boards, all of them far cheaper per draw than std::ranlux24.
+ * They follow the standard engine interface as far as the game uses it: seed(), discard(), comparison and
+ * the text form the snapshots store, which starts with the name of the engine so one engine does not read
+ * another one's state.
+ */
+
+namespace detail {
+
+  constexpr std::uint64_t splitmix64(std::uint64_t &state)
+  {
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15U);
+    z = (z ^ (z >> 30U)) * 0xbf58476d1ce4e5b9U;
+    z = (z ^ (z >> 27U)) * 0x94d049bb133111ebU;
+    return z ^ (z >> 31U);
+  }
+
+  template<class Engine> std::ostream &write_engine(std::ostream &out, const auto &words)
+  {
+    out << Engine::name;
+    for (const auto word : words) { out << ' ' << word; }
+    return out;
+  }
+
+  // leaves the words as they were unless the whole state was read
+  template<class Engine, class Words> std::istream &read_engine(std::istream &in, Words &words)
+  {
+    std::string name;
+    Words read{};
+    in >> name;
+    for (auto &word : read) { in >> word; }
+    if (name != Engine::name) { in.setstate(std::ios::failbit); }
+    if (in) { words = read; }
+    return in;
+  }
+
+}// namespace detail
+
+// xoshiro256** by Blackman and Vigna, 256 bits of state seeded through splitmix64
+class Xoshiro256
+{
+public:
+  using result_type = std::uint64_t;
+  static constexpr std::string_view name = "xoshiro";
+  static constexpr result_type default_seed = 1;
+
+  constexpr Xoshiro256() { seed(default_seed); }
+
+  constexpr explicit Xoshiro256(result_type value) { seed(value); }
+
+  constexpr void seed(result_type value = default_seed)
+  {
+    for (auto &word : state) { word = detail::splitmix64(value); }
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  constexpr result_type operator()()
+  {
+    const result_type result = rotl(state[1] * 5, 7) * 9;
+    const result_type shifted = state[1] << 17U;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= shifted;
+    state[3] = rotl(state[3], 45);
+    return result;
+  }
+
+  constexpr void discard(unsigned long long draws)
+  {
+    for (; draws > 0; --draws) { (*this)(); }
+  }
+
+  bool operator==(const Xoshiro256 &) const = default;
+
+  friend std::ostream &operator<<(std::ostream &out, const Xoshiro256 &engine)
+  {
+    return detail::write_engine<Xoshiro256>(out, engine.state);
+  }
+
+  friend std::istream &operator>>(std::istream &in, Xoshiro256 &engine)
+  {
+    return detail::read_engine<Xoshiro256>(in, engine.state);
+  }
+
+private:
+  std::array<std::uint64_t, 4> state{};
+
+  static constexpr std::uint64_t rotl(std::uint64_t x, unsigned k) { return (x << k) | (x >> (64U - k)); }
+};
+
+// pcg32 by O'Neill: a 64 bit linear congruential state and a permuted 32 bit output, one of 2^63 streams
+class Pcg32
+{
+public:
+  using result_type = std::uint32_t;
+  static constexpr std::string_view name = "pcg";
+  static constexpr std::uint64_t default_seed = 0x853c49e6748fea9bU;
+  static constexpr std::uint64_t default_stream = 0x6d1f1ce5cade56d5U;
+
+  constexpr Pcg32() { seed(default_seed); }
+
+  constexpr explicit Pcg32(std::uint64_t value, std::uint64_t stream = default_stream) { seed(value, stream); }
+
+  constexpr void seed(std::uint64_t value = default_seed, std::uint64_t stream = default_stream)
+  {
+    words = { 0, (stream << 1U) | 1U };
+    step();
+    words[0] += value;
+    step();
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  constexpr result_type operator()()
+  {
+    const std::uint64_t old = words[0];
+    step();
+    const auto xorshifted = static_cast<std::uint32_t>(((old >> 18U) ^ old) >> 27U);
+    const auto rotation = static_cast<std::uint32_t>(old >> 59U);
+    return (xorshifted >> rotation) | (xorshifted << ((0U - rotation) & 31U));
+  }
+
+  constexpr void discard(unsigned long long draws)
+  {
+    for (; draws > 0; --draws) { step(); }
+  }
+
+  bool operator==(const Pcg32 &) const = default;
+
+  friend std::ostream &operator<<(std::ostream &out, const Pcg32 &engine)
+  {
+    return detail::write_engine<Pcg32>(out, engine.words);
+  }
+
+  friend std::istream &operator>>(std::istream &in, Pcg32 &engine)
+  {
+    std::istream &result = detail::read_engine<Pcg32>(in, engine.words);
+    // the increment is always odd
+    engine.words[1] |= 1U;
+    return result;
+  }
+
+private:
+  static constexpr std::uint64_t multiplier = 6364136223846793005U;
+
+  // state and increment
+  std::array<std::uint64_t, 2> words{};
+
+  constexpr void step() { words[0] = words[0] * multiplier + words[1]; }
+};
+
+/**
+ * @brief Philox4x32-10 by Salmon et al., counter based
+ *
+ * Every block of four outputs is a keyed bijection of its 128 bit counter, there is no state besides the
+ * counter. The seed is the key and seek() jumps to the start of one of 2^64 streams in constant time, so the
+ * draws of level n of a session do not depend on anything drawn before and any level can be generated on its
+ * own, in any order or in parallel.
+ */
+class Philox4x32
+{
+public:
+  using result_type = std::uint32_t;
+  static constexpr std::string_view name = "philox";
+  static constexpr std::uint64_t default_seed = 20111115U;
+
+  constexpr Philox4x32() { seed(default_seed); }
+
+  constexpr explicit Philox4x32(std::uint64_t value) { seed(value); }
+
+  constexpr void seed(std::uint64_t value = default_seed)
+  {
+    key = { static_cast<std::uint32_t>(value), static_cast<std::uint32_t>(value >> 32U) };
+    seek(0);
+  }
+
+  // the first draw of the stream, counters of different streams never meet
+  constexpr void seek(std::uint64_t stream)
+  {
+    counter = { 0, 0, static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32U) };
+    used = block_size;
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  constexpr result_type operator()()
+  {
+    if (used == block_size) {
+      output = block(counter, key);
+      used = 0;
+      if (++counter[0] == 0) { ++counter[1]; }
+    }
+    return output[used++];
+  }
+
+  // skips whole blocks without computing them
+  constexpr void discard(unsigned long long draws)
+  {
+    const auto left = block_size - used;
+    if (draws <= left) {
+      used += static_cast<std::uint32_t>(draws);
+      return;
+    }
+    draws -= left;
+    const std::uint64_t blocks = (draws - 1) / block_size;
+    const std::uint64_t position = ((std::uint64_t{ counter[1] } << 32U) | counter[0]) + blocks;
+    counter[0] = static_cast<std::uint32_t>(position);
+    counter[1] = static_cast<std::uint32_t>(position >> 32U);
+    used = block_size;
+    (*this)();
+    used = static_cast<std::uint32_t>((draws - 1) % block_size) + 1;
+  }
+
+  // the outputs of a block used up are left over and do not count
+  constexpr bool operator==(const Philox4x32 &other) const
+  {
+    return key == other.key && counter == other.counter && used == other.used
+           && (used == block_size || output == other.output);
+  }
+
+  // the ten rounds on one counter, the whole engine is this function applied to consecutive counters
+  static constexpr std::array<std::uint32_t, 4> block(std::array<std::uint32_t, 4> count,
+    std::array<std::uint32_t, 2> round_key)
+  {
+    for (int round = 0; round < 10; ++round) {
+      const std::uint64_t first = std::uint64_t{ 0xD2511F53U } * count[0];
+      const std::uint64_t second = std::uint64_t{ 0xCD9E8D57U } * count[2];
+      count = { static_cast<std::uint32_t>(second >> 32U) ^ count[1] ^ round_key[0],
+        static_cast<std::uint32_t>(second),
+        static_cast<std::uint32_t>(first >> 32U) ^ count[3] ^ round_key[1],
+        static_cast<std::uint32_t>(first) };
+      round_key[0] += 0x9E3779B9U;
+      round_key[1] += 0xBB67AE85U;
+    }
+    return count;
+  }
+
+  friend std::ostream &operator<<(std::ostream &out, const Philox4x32 &engine)
+  {
+    const std::array<std::uint32_t, 7> words{ engine.key[0],
+      engine.key[1],
+      engine.counter[0],
+      engine.counter[1],
+      engine.counter[2],
+      engine.counter[3],
+      engine.used };
+    return detail::write_engine<Philox4x32>(out, words);
+  }
+
+  friend std::istream &operator>>(std::istream &in, Philox4x32 &engine)
+  {
+    std::array<std::uint32_t, 7> words{};
+    detail::read_engine<Philox4x32>(in, words);
+    if (in && words[6] > block_size) { in.setstate(std::ios::failbit); }
+    if (!in) { return in; }
+    engine.key = { words[0], words[1] };
+    engine.counter = { words[2], words[3], words[4], words[5] };
+    engine.used = block_size;
+    // the block in use belongs to the counter before, compute it again
+    if (words[6] < block_size) {
+      const std::uint64_t position = ((std::uint64_t{ engine.counter[1] } << 32U) | engine.counter[0]) - 1;
+      std::array<std::uint32_t, 4> previous = engine.counter;
+      previous[0] = static_cast<std::uint32_t>(position);
+      previous[1] = static_cast<std::uint32_t>(position >> 32U);
+      engine.output = block(previous, engine.key);
+      engine.used = words[6];
+    }
+    return in;
+  }
+
+private:
+  static constexpr std::uint32_t block_size = 4;
+
+  std::array<std::uint32_t, 2> key{};
+  // of the next block
+  std::array<std::uint32_t, 4> counter{};
+  std::array<std::uint32_t, 4> output{};
+  // outputs of the current block already drawn
+  std::uint32_t used = block_size;
+};
+
+// engines a seek(stream) puts at the start of an independent stream
+template<class Prng>
+concept SeekablePrng = requires(Prng prng, std::uint64_t stream) { prng.seek(stream); };
+
+// seeds with all 64 bits where the engine takes them, the standard engines are seeded with a result_type
+template<class Prng> void seed_prng(Prng &prng, std::uint64_t seed)
+{
+  if constexpr (std::is_same_v<Prng, Xoshiro256> || std::is_same_v<Prng, Pcg32> || std::is_same_v<Prng, Philox4x32>) {
+    prng.seed(seed);
+  } else {
+    prng.seed(static_cast<typename Prng::result_type>(seed));
+  }
+}
+
+/**
+ * @brief a uniform integer in [lo, hi], also in constant expressions
+ *
+ * Lemire's multiply and reject on 32 bits of a draw, for ranges of up to 2^32 values. The standard
+ * distributions cannot run at compile time and map draws differently, so the same engine gives other numbers
+ * here than through std::uniform_int_distribution.
+ */
+template<std::integral Int, class Prng> constexpr Int uniform_int(Prng &prng, Int lo, Int hi)
+{
+  static_assert(Prng::min() == 0 && Prng::max() >= std::numeric_limits<std::uint32_t>::max(),
+    "uniform_int takes 32 bits of every draw");
+  const std::uint64_t range = static_cast<std::uint64_t>(hi) - static_cast<std::uint64_t>(lo) + 1;
+  if (hi < lo || range > std::uint64_t{ 1 } << 32U) {
+    throw std::invalid_argument("uniform_int needs a range of at most 32 bits");
+  }
+
+  auto product = static_cast<std::uint64_t>(static_cast<std::uint32_t>(prng())) * range;
+  if (static_cast<std::uint32_t>(product) < range) {
+    // 2^32 % range, the low products that would make some values more likely than others
+    const std::uint64_t threshold = (std::uint64_t{ 1 } << 32U) % range;
+    while (static_cast<std::uint32_t>(product) < threshold) {
+      product = static_cast<std::uint64_t>(static_cast<std::uint32_t>(prng())) * range;
+    }
+  }
+  return static_cast<Int>(static_cast<std::uint64_t>(lo) + (product >> 32U));
+}
+
+// names of the engines with_prng() knows, the first one is the default
+inline constexpr std::array<std::string_view, 4> prng_names{ "ranlux24", "xoshiro", "pcg", "philox" };
+
+// calls visit with std::type_identity of the engine of that name, throws std::invalid_argument for any other
+template<class Visit> decltype(auto) with_prng(std::string_view name, Visit &&visit)
+{
+  if (name == prng_names[0]) { return visit(std::type_identity<std::ranlux24>{}); }
+  if (name == Xoshiro256::name) { return visit(std::type_identity<Xoshiro256>{}); }
+  if (name == Pcg32::name) { return visit(std::type_identity<Pcg32>{}); }
+  if (name == Philox4x32::name) { return visit(std::type_identity<Philox4x32>{}); }
+  throw std::invalid_argument("unknown random engine " + std::string{ name });
+}
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_RANDOM_HPP
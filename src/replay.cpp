@@ -0,0 +1,133 @@
+#include "config.hpp"
+#include "level_pack.hpp"
+#include "mapped_file.hpp"
+#include "replay.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <docopt/docopt.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <internal_use_only/config.hpp>
+
+namespace smoothlife {
+
+// the files themselves and every *.replay file inside the directories
+std::vector<std::filesystem::path> replay_files(const std::vector<std::string> &arguments)
+{
+  std::vector<std::filesystem::path> files;
+  for (const auto &argument : arguments) {
+    if (!std::filesystem::is_directory(argument)) {
+      files.emplace_back(argument);
+      continue;
+    }
+    for (const auto &entry : std::filesystem::directory_iterator{ argument }) {
+      if (entry.is_regular_file() && entry.path().extension() == ".replay") { files.push_back(entry.path()); }
+    }
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+/**
+ * @brief verifies all replays on the pool
+ *
+ * Files are handed out in chunks, every chunk reuses one Replayer and reads the events straight from the
+ * mapped file.
+ */
+std::vector<ReplayResult>
+  verify(ThreadPool &pool, const std::vector<std::filesystem::path> &files, const LevelPack *pack)
+{
+  static constexpr std::size_t chunk_size = 64;
+
+  std::vector<ReplayResult> results(files.size());
+  for (std::size_t chunk = 0; chunk * chunk_size < files.size(); ++chunk) {
+    pool.submit([&, chunk] {
+      Replayer replayer{ pack };
+      const std::size_t end = std::min(files.size(), (chunk + 1) * chunk_size);
+      for (std::size_t i = chunk * chunk_size; i < end; ++i) {
+        try {
+          const MappedFile file{ files[i] };
+          results[i] = replayer.run(parse_replay(file.bytes()));
+        } catch (const std::exception &e) {
+          results[i].error = e.what();
+        }
+      }
+    });
+  }
+  pool.wait();
+  return results;
+}
+
+}// namespace smoothlife
+
+int main(int argc, const char **argv)
+{
+  try {
+    static constexpr auto USAGE =
+      R"(
+    Usage:
+          smoothlife_replay <replays>... [--threads=<t>] [--pack=<file>] [--verbose]
+          smoothlife_replay --version
+          smoothlife_replay (-h | --help)
+    Options:
+          -h --help        Show this screen.
+          --version        Show version.
+          --threads=<t>    Worker threads, 0 uses every core [default: 0].
+          --pack=<file>    Level pack the replays were recorded with.
+          --verbose        Print every replay, not only the invalid ones.
+    Replays are files written by smoothlife --record or directories holding *.replay files.
+)";
+
+    auto args = docopt::docopt(USAGE,
+      { std::next(argv), std::next(argv, argc) },
+      true,
+      fmt::format("{} {}", smoothlife::cmake::project_name, smoothlife::cmake::project_version));
+
+    std::optional<smoothlife::LevelPack> pack;
+    if (args["--pack"]) { pack.emplace(args["--pack"].asString()); }
+
+    const auto files = smoothlife::replay_files(args["<replays>"].asStringList());
+    smoothlife::ThreadPool pool{ static_cast<std::size_t>(args["--threads"].asLong()) };
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto results = smoothlife::verify(pool, files, pack ? &*pack : nullptr);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::uint64_t moves = 0;
+    std::size_t invalid = 0;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+      const auto &result = results[i];
+      moves += result.moves;
+      if (!result.valid) {
+        ++invalid;
+        fmt::print("INVALID {}: {}\n", files[i].string(), result.error);
+      } else if (args["--verbose"].asBool()) {
+        fmt::print(
+          "valid   {}: score {} level {} moves {}\n", files[i].string(), result.score, result.level, result.moves);
+      }
+    }
+
+    fmt::print("smoothlife_replay: {} replays, {} valid, {} invalid, {} threads\n",
+      files.size(),
+      files.size() - invalid,
+      invalid,
+      pool.size());
+    fmt::print("  time             {:>12.3f} s\n", elapsed.count());
+    fmt::print("  moves/sec        {:>12.0f}\n", static_cast<double>(moves) / elapsed.count());
+    fmt::print("  moves/sec/thread {:>12.0f}\n",
+      static_cast<double>(moves) / elapsed.count() / static_cast<double>(pool.size()));
+    return invalid == 0 ? 0 : 1;
+
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("Unhandled exception in main: {}", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,256 @@
+#ifndef SMOOTHLIFE_REPLAY_HPP
+#define SMOOTHLIFE_REPLAY_HPP
+
+#include "config.hpp"
+#include "builtin_levels.hpp"
+#include "gameboard.hpp"
+#include "level_pack.hpp"
+#include "log.hpp"
+#include "player.hpp"
+#include "random.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace smoothlife {
+
+// everything that changes a game besides its seed, one byte each in a replay
+enum struct ReplayEvent : std::uint8_t {
+  // successful moves, same values as Direction
+  up = 0,
+  left = 1,
+  down = 2,
+  right = 3,
+  // the energy timer took one energy
+  tick = 4,
+  // the continue button moved on to the next stage
+  advance = 5
+};
+
+constexpr ReplayEvent replay_event(Direction dir) { return static_cast<ReplayEvent>(static_cast<int>(dir)); }
+
+/**
+ * @brief file header of a replay, followed by one byte per event
+ *
+ * The seed and the events reproduce the whole session, score and level are what the session claims to have
+ * reached. Integers are little endian.
+ */
+struct ReplayHeader
+{
+  static constexpr std::array<char, 8> signature{ 'S', 'M', 'L', 'R', 'E', 'P', 'L', 'Y' };
+  static constexpr std::uint32_t current_version = 1;
+
+  // the session started in the game stage
+  static constexpr std::uint32_t skip_tutorial = 1U << 0U;
+  // levels came from a level pack, pack_seed is the seed of the pack
+  static constexpr std::uint32_t level_pack = 1U << 1U;
+  // the first levels were the built-in tutorial levels
+  static constexpr std::uint32_t tutorial_levels = 1U << 2U;
+
+  std::array<char, 8> magic = signature;
+  std::uint32_t version = current_version;
+  std::uint32_t flags = 0;
+  std::uint64_t seed = 0;
+  std::uint64_t pack_seed = 0;
+  std::uint32_t width = 0;
+  std::uint32_t height = 0;
+  std::uint64_t events = 0;
+  std::int32_t score = 0;
+  std::int32_t level = 0;
+  std::array<std::uint8_t, 8> reserved{};
+};
+
+static_assert(sizeof(ReplayHeader) == 64);
+static_assert(std::is_trivially_copyable_v<ReplayHeader>);
+
+/**
+ * @brief collects the events of a session
+ *
+ * Not synchronized, the game records under the same lock that applies the events.
+ */
+class ReplayRecorder
+{
+public:
+  ReplayRecorder(std::uint64_t seed, std::uint32_t flags, std::uint64_t pack_seed = 0)
+  {
+    header.seed = seed;
+    header.flags = flags;
+    header.pack_seed = pack_seed;
+    header.width = config::board_width;
+    header.height = config::board_height;
+  }
+
+  void record(ReplayEvent event) { events.push_back(event); }
+
+  // writes the session with the score and level it reached
+  void save(const std::filesystem::path &path, int score, int level) const
+  {
+    ReplayHeader finished = header;
+    finished.events = events.size();
+    finished.score = score;
+    finished.level = level;
+
+    std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    out.write(reinterpret_cast<const char *>(&finished), sizeof(finished));
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    out.write(reinterpret_cast<const char *>(events.data()), static_cast<std::streamsize>(events.size()));
+    if (!out.flush()) { throw std::runtime_error("cannot write " + path.string()); }
+  }
+
+private:
+  ReplayHeader header;
+  std::vector<ReplayEvent> events;
+};
+
+// a replay as it lies in memory, events point into the bytes it was read from
+struct ReplayView
+{
+  ReplayHeader header;
+  std::span<const std::uint8_t> events;
+};
+
+inline ReplayView parse_replay(std::span<const std::byte> bytes)
+{
+  ReplayView replay;
+  if (bytes.size() < sizeof(ReplayHeader)) { throw std::runtime_error("not a replay"); }
+  std::memcpy(&replay.header, bytes.data(), sizeof(ReplayHeader));
+
+  if (replay.header.magic != ReplayHeader::signature) { throw std::runtime_error("not a replay"); }
+  if (replay.header.version != ReplayHeader::current_version) {
+    throw std::runtime_error(fmt::format("unsupported replay version {}", replay.header.version));
+  }
+  if (bytes.size() - sizeof(ReplayHeader) < replay.header.events) { throw std::runtime_error("truncated replay"); }
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto *events = reinterpret_cast<const std::uint8_t *>(bytes.data() + sizeof(ReplayHeader));
+  replay.events = { events, events + replay.header.events };
+  return replay;
+}
+
+struct ReplayResult
+{
+  bool valid = false;
+  int score = 0;
+  int level = 0;
+  std::uint64_t moves = 0;
+  // why the replay is invalid
+  std::string error;
+};
+
+/**
+ * @brief re-runs recorded sessions without any ui
+ *
+ * Holds one game and reuses it for every replay like the Simulator. A replay is valid if every recorded move
+ * is possible, every event happens in a stage where the game allows it and the session ends with the
+ * claimed score and level.
+ */
+template<class Prng = std::ranlux24> class Replayer
+{
+public:
+  using Board = GameBoard<config::board_width, config::board_height, Prng>;
+
+  // replays that used a level pack need the same pack
+  explicit Replayer(const LevelPack *pack = nullptr) : levels{ pack } {}
+
+  // the board keeps references into this object
+  Replayer(const Replayer &) = delete;
+  Replayer(Replayer &&) = delete;
+  Replayer &operator=(const Replayer &) = delete;
+  Replayer &operator=(Replayer &&) = delete;
+  ~Replayer() = default;
+
+  ReplayResult run(const ReplayView &replay)
+  {
+    ReplayResult result;
+    const ReplayHeader &header = replay.header;
+
+    if (header.width != config::board_width || header.height != config::board_height) {
+      result.error = fmt::format("recorded on a {}x{} board", header.width, header.height);
+      return result;
+    }
+
+    seed_prng(prng, header.seed);
+    player.reset();
+    log.clear();
+    board.load_level = nullptr;
+    if ((header.flags & ReplayHeader::level_pack) != 0) {
+      if (levels == nullptr) {
+        result.error = "recorded with a level pack";
+        return result;
+      }
+      use_level_pack(board, *levels, header.pack_seed);
+    } else if ((header.flags & ReplayHeader::tutorial_levels) != 0) {
+      use_builtin_levels(board, smoothlife::tutorial_levels, smoothlife::tutorial_levels.first_seed);
+    }
+    board.level = 0;
+    board.stage = GameStage::intro;
+    board.next_level();
+    if ((header.flags & ReplayHeader::skip_tutorial) != 0) { board.stage = GameStage::game; }
+
+    for (std::size_t i = 0; i < replay.events.size(); ++i) {
+      const auto event = static_cast<ReplayEvent>(replay.events[i]);
+      switch (event) {
+      case ReplayEvent::up:
+      case ReplayEvent::left:
+      case ReplayEvent::down:
+      case ReplayEvent::right:
+        if (!player.move(static_cast<Direction>(event))) {
+          result.error = fmt::format("impossible move at event {}", i);
+          return result;
+        }
+        ++result.moves;
+        break;
+      case ReplayEvent::tick:
+        if (board.stage != GameStage::game) {
+          result.error = fmt::format("energy tick outside the game at event {}", i);
+          return result;
+        }
+        player.energy -= 1;
+        break;
+      case ReplayEvent::advance:
+        ++board.stage;
+        break;
+      default:
+        result.error = fmt::format("unknown event {} at event {}", replay.events[i], i);
+        return result;
+      }
+    }
+
+    result.score = player.score;
+    result.level = board.level;
+    if (result.score != header.score || result.level != header.level) {
+      result.error = fmt::format("claims score {} at level {}, replays to {} at level {}",
+        header.score,
+        header.level,
+        result.score,
+        result.level);
+      return result;
+    }
+    result.valid = true;
+    return result;
+  }
+
+private:
+  const LevelPack *levels;
+
+  Player player;
+  Log log{ config::log_length };
+  Prng prng;
+  Board board{ prng, player, log };
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_REPLAY_HPP
@@ -0,0 +1,109 @@
+#ifndef SMOOTHLIFE_ROUNDNESS_HPP
+#define SMOOTHLIFE_ROUNDNESS_HPP
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+namespace smoothlife {
+
+namespace detail {
+
+  // |number| without overflowing on the smallest long
+  constexpr std::uint64_t magnitude(long number)
+  {
+    const auto bits = static_cast<std::uint64_t>(number);
+    return number < 0 ? 0 - bits : bits;
+  }
+
+  // multiplicative inverse of an odd number modulo 2^64, every newton step doubles the correct low bits
+  constexpr std::uint64_t inverse(std::uint64_t odd)
+  {
+    std::uint64_t x = odd;
+    for (int i = 0; i < 5; ++i) { x *= 2 - odd * x; }
+    return x;
+  }
+
+  /**
+   * @brief division free divisibility test by a constant divisor
+   *
+   * With divisor = 2^twos * odd, number is a multiple of divisor exactly if
+   * rotr(number * odd^-1, twos) <= (2^64 - 1) / divisor, and then the rotated product is the quotient
+   * (Granlund and Montgomery, Lemire et al.). One multiplication replaces the division per digit.
+   */
+  template<std::uint64_t Divisor> struct ExactDivision
+  {
+    static_assert(Divisor >= 2);
+
+    static constexpr int twos = std::countr_zero(Divisor);
+    static constexpr std::uint64_t odd_inverse = inverse(Divisor >> twos);
+    static constexpr std::uint64_t max_quotient = std::numeric_limits<std::uint64_t>::max() / Divisor;
+
+    // number / Divisor if it divides, otherwise something above max_quotient
+    static constexpr std::uint64_t quotient(std::uint64_t number) { return std::rotr(number * odd_inverse, twos); }
+  };
+
+}// namespace detail
+
+// most trailing zeros a nonzero long can have in the base, 18 for base 10
+template<int Base> inline constexpr int max_roundness = [] {
+  int digits = 0;
+  for (std::uint64_t rest = detail::magnitude(std::numeric_limits<long>::min()); rest >= Base;
+       rest /= static_cast<std::uint64_t>(Base)) {
+    ++digits;
+  }
+  return digits;
+}();
+
+/**
+ * @brief roundness of a number in any base, see roundness(long)
+ *
+ * Valid for the whole range of long. The base is a compile time constant, so the digit loop strips one
+ * zero per multiplication, for base 10 a multiplication by 5^-1 and a rotation. In a power of two base the
+ * zero digits are the trailing zero bits, counted by a single instruction.
+ */
+template<int Base> constexpr int roundness(long number)
+{
+  static_assert(Base >= 2, "roundness needs a base of at least 2");
+
+  if constexpr (std::has_single_bit(static_cast<unsigned>(Base))) {
+    // -x ends in as many zero bits as x, no need for the magnitude and its unpredictable sign branch
+    // zero counts as 1 like in every other base
+    if (number == 0) { return 1; }
+    return std::countr_zero(static_cast<std::uint64_t>(number)) / std::countr_zero(static_cast<unsigned>(Base));
+  } else {
+    std::uint64_t rest = detail::magnitude(number);
+    using Digit = detail::ExactDivision<static_cast<std::uint64_t>(Base)>;
+
+    // zero divides forever and is the only number running into the bound, it counts as 1 like before
+    for (int zeros = 0; zeros <= max_roundness<Base>; ++zeros) {
+      const std::uint64_t quotient = Digit::quotient(rest);
+      if (quotient > Digit::max_quotient) { return zeros; }
+      rest = quotient;
+    }
+    return 1;
+  }
+}
+
+/**
+ * @brief roundness of every number, result[i] = roundness<Base>(numbers[i])
+ *
+ * Most numbers are not round and leave the kernel after a single multiplication, so a plain loop beats
+ * vectorized variants here. Lanes would have to wait for the roundest number and x86 has no 64 bit
+ * vector multiplication below AVX-512.
+ *
+ * @param numbers integers to determine the roundness of.
+ * @param result receives one roundness per number, must be at least as long as numbers.
+ */
+template<int Base> constexpr void roundness(std::span<const long> numbers, std::span<int> result)
+{
+  if (result.size() < numbers.size()) { throw std::out_of_range("roundness: result is shorter than numbers"); }
+
+  for (std::size_t i = 0; i < numbers.size(); ++i) { result[i] = roundness<Base>(numbers[i]); }
+}
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_ROUNDNESS_HPP
@@ -0,0 +1,222 @@
+#ifndef SMOOTHLIFE_RULES_HPP
+#define SMOOTHLIFE_RULES_HPP
+
+#include "config.hpp"
+#include "field.hpp"
+#include "log.hpp"
+#include "roundness.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace smoothlife {
+
+enum struct GameStage : int { intro = 1, tutorial_1 = 2, tutorial_2 = 3, game = 4, ending = 5 };
+
+// Make GameStage incrementable
+constexpr GameStage &operator++(GameStage &stage)
+{
+  using IntType = typename std::underlying_type<GameStage>::type;
+  if (stage != GameStage::ending) { stage = static_cast<GameStage>(static_cast<IntType>(stage) + 1); }
+  return stage;
+}
+
+/*
+ * The rules of the game on plain values, without a board, a player or a log to change, so all of them run at
+ * compile time as well, see builtin_levels.hpp. BasicGameBoard plays by them.
+ *
+ * A draw is a callable draw(lo, hi) returning a uniform number of the type of lo in [lo, hi], the board
+ * passes one drawing from its engine through the std distributions, uniform_int() works at compile time.
+ */
+namespace rules {
+
+  // what leaving a level through the exit scores, only paid if the surface is round
+  constexpr int exit_score(int roundness, int level, int steps)
+  {
+    return (roundness + level) * (config::player_energy - steps);
+  }
+
+  // energy the player gains for leaving with a surface of the roundness
+  constexpr int energy_gain(int roundness)
+  {
+    if (roundness <= 0) { return 0; }
+    if (roundness == 1) { return config::ok_energy_gain; }
+    if (roundness == 2) { return config::fine_energy_gain; }
+    return config::master_energy_gain;
+  }
+
+  // what the log tells about leaving with a surface of the roundness
+  constexpr Log::Message exit_message(int roundness)
+  {
+    if (roundness <= 0) { return Log::Message::failed; }
+    if (roundness == 1) { return Log::Message::okay_polish; }
+    if (roundness == 2) { return Log::Message::fine_polish; }
+    return Log::Message::masterpiece;
+  }
+
+  // zeros of the round surface a level is built from, more of them every two levels
+  constexpr int surface_zeros(int level)
+  {
+    return std::min(config::surface_zeros + std::max(level, 0) / 2, config::max_surface_zeros);
+  }
+
+  // operations of a level, one more every two levels, at most until the board is full
+  constexpr std::size_t chain_length(int level, std::size_t cells)
+  {
+    return std::min(static_cast<std::size_t>(config::chain_length + std::max(level, 0) / 2), cells - 2);
+  }
+
+  /**
+   * @brief draws the next operation of the chain
+   *
+   * Same distribution as drawing a uniform type and value and retrying, but without the retries: the type is
+   * uniform, the value uniform among the ones keeping the chain exact (divisors of the surface for mul) and
+   * free of overflow. With rough set only choices leaving a surface that is not round remain, weighted like
+   * the first draw. Such a choice always remains: adding or subtracting 1 to Base - 1 reaches Base - 1
+   * consecutive surfaces, at most one of them a multiple of Base, which leaves a rough one from base 3 on. In
+   * base 2 adding or subtracting 1 makes an even surface odd, and multiplying by 1 keeps an odd one.
+   */
+  template<int Base, class Draw> constexpr Field random_operation(long surface, bool rough, Draw &&draw)
+  {
+    constexpr std::array types{ Field::Type::add, Field::Type::sub, Field::Type::mul, Field::Type::div };
+    constexpr int values = Base - 1;
+    using Values = std::uint32_t;
+
+    // bit value - 1 is set for every valid value of the type
+    std::array<Values, types.size()> valid{};
+    for (std::size_t t = 0; t < types.size(); ++t) {
+      for (int value = 1; value <= values; ++value) {
+        const Field f{ types[t], value };
+        if (f.inverse().fits(surface) && (f.type != Field::Type::mul || surface % value == 0)) {
+          valid[t] |= Values{ 1 } << (value - 1);
+        }
+      }
+    }
+
+    const auto nth_value = [](Values set, int n) {
+      for (; n > 0; --n) { set &= set - 1; }
+      return std::countr_zero(set) + 1;
+    };
+
+    if (!rough) {
+      std::array<std::size_t, types.size()> candidates{};
+      std::size_t count = 0;
+      for (std::size_t t = 0; t < types.size(); ++t) {
+        if (valid[t] != 0) { candidates[count++] = t; }
+      }
+      const std::size_t t = candidates[draw(std::size_t{ 0 }, count - 1)];
+      const int n = draw(0, std::popcount(valid[t]) - 1);
+      return { types[t], nth_value(valid[t], n) };
+    }
+
+    // drop the choices leaving a round surface, a value of type t keeps its weight 1 / |valid[t]|,
+    // scaled by the product of all counts to stay an integer
+    std::array<Values, types.size()> rough_values{};
+    std::array<int, types.size()> weights{};
+    int total = 0;
+    for (std::size_t t = 0; t < types.size(); ++t) {
+      for (Values set = valid[t]; set != 0; set &= set - 1) {
+        const int value = std::countr_zero(set) + 1;
+        long result = surface;
+        Field{ types[t], value }.inverse().apply<Base>(result);
+        if (roundness<Base>(result) == 0) { rough_values[t] |= Values{ 1 } << (value - 1); }
+      }
+
+      weights[t] = std::popcount(rough_values[t]);
+      for (std::size_t other = 0; other < types.size(); ++other) {
+        if (other != t && valid[other] != 0) { weights[t] *= std::popcount(valid[other]); }
+      }
+      total += weights[t];
+    }
+
+    int pick = draw(0, total - 1);
+    std::size_t t = 0;
+    while (pick >= weights[t]) { pick -= weights[t++]; }
+    const int per_value = weights[t] / std::popcount(rough_values[t]);
+    return { types[t], nth_value(rough_values[t], pick / per_value) };
+  }
+
+  /**
+   * @brief builds a level backwards from a round surface and returns the surface the player starts with
+   *
+   * The player starts at (0, 0) and the exit is the opposite corner. Operation fields are drawn onto free
+   * cells and their inverses applied to the surface, so the player can walk the chain back to a round number.
+   * Every draw picks directly from the valid choices instead of retrying, which bounds the work by the chain
+   * length, even on a completely filled board. Grids sized at runtime draw the cells of short chains by
+   * rejection instead, so huge boards cost no more than small ones.
+   */
+  template<int Base, class Grid, class Draw> constexpr long generate_level(Grid &grid, int level, Draw &&draw)
+  {
+    if constexpr (Grid::fixed_size) {
+      static_assert(Grid::size() >= 3, "the board needs room for the player, the exit and an operation");
+    } else if (grid.width() * grid.height() < 3) {
+      throw std::invalid_argument("the board needs room for the player, the exit and an operation");
+    }
+
+    const std::size_t width = grid.width();
+    const std::size_t cells = width * grid.height();
+    grid.clear();
+
+    // a digit and zeros
+    long factor = 1;
+    for (int i = 0; i < surface_zeros(level); ++i) { factor *= Base; }
+    long surface = draw(1, Base - 1) * factor;
+
+    grid.set(static_cast<int>(width) - 1, static_cast<int>(grid.height()) - 1, { Field::Type::exit });
+    const std::size_t chain = chain_length(level, cells);
+
+    // cells are numbered row by row, every cell between the player at the first and the exit at the last is free
+    const auto place_chain = [&](auto &&free_cell) {
+      for (std::size_t i = 0; i < chain; ++i) {
+        // the last operation decides the surface the player starts with, it must not be round
+        const Field rnd_f = random_operation<Base>(surface, i + 1 == chain, draw);
+        const std::size_t cell = free_cell(i);
+        grid.set(static_cast<int>(cell % width), static_cast<int>(cell / width), rnd_f);
+
+        // make surface rough
+        rnd_f.inverse().template apply<Base>(surface);
+      }
+    };
+
+    // partial fisher-yates shuffle, the i-th cell is uniform among the ones still free
+    const auto shuffled = [&](auto &free_cells) {
+      std::iota(free_cells.begin(), free_cells.end(), std::size_t{ 1 });
+      return [&](std::size_t i) {
+        std::swap(free_cells[i], free_cells[draw(i, free_cells.size() - 1)]);
+        return free_cells[i];
+      };
+    };
+
+    if constexpr (Grid::fixed_size) {
+      std::array<std::size_t, Grid::size() - 2> free_cells{};
+      place_chain(shuffled(free_cells));
+    } else if (chain * 2 > cells - 2) {
+      std::vector<std::size_t> free_cells(cells - 2);
+      place_chain(shuffled(free_cells));
+    } else {
+      // at most half of the cells get taken, a draw hits a free one with at least even odds
+      place_chain([&](std::size_t /*i*/) {
+        std::size_t cell = 0;
+        do {
+          cell = draw(std::size_t{ 1 }, cells - 2);
+        } while (grid.get(static_cast<int>(cell % width), static_cast<int>(cell / width)).type != Field::Type::empty);
+        return cell;
+      });
+    }
+
+    return surface;
+  }
+
+}// namespace rules
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_RULES_HPP
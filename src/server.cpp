@@ -0,0 +1,74 @@
+#include "server.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <string>
+
+#include <pthread.h>
+
+#include <docopt/docopt.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <internal_use_only/config.hpp>
+
+int main(int argc, const char **argv)
+{
+  try {
+    static constexpr auto USAGE =
+      R"(
+    Usage:
+          smoothlife_server <socket> [--threads=<t>] [--tick=<ms>]
+          smoothlife_server --version
+          smoothlife_server (-h | --help)
+    Options:
+          -h --help        Show this screen.
+          --version        Show version.
+          --threads=<t>    Event loop threads, 0 uses every core [default: 1].
+          --tick=<ms>      Milliseconds between two energy ticks of a game [default: 5000].
+    Serves a game to every connection on the Unix domain socket until interrupted, see smoothlife_load.
+)";
+
+    auto args = docopt::docopt(USAGE,
+      { std::next(argv), std::next(argv, argc) },
+      true,
+      fmt::format("{} {}", smoothlife::cmake::project_name, smoothlife::cmake::project_version));
+
+    // blocked before the loops start, so only this thread takes them
+    sigset_t signals{};
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    smoothlife::raise_file_limit();
+    smoothlife::ServerOptions options;
+    options.socket = args["<socket>"].asString();
+    options.threads = static_cast<std::size_t>(args["--threads"].asLong());
+    options.tick = std::chrono::milliseconds{ args["--tick"].asLong() };
+
+    const auto start = std::chrono::steady_clock::now();
+    smoothlife::GameServer server{ options };
+    const auto threads = server.stats().threads;
+    fmt::print("smoothlife_server: listening on {}, {} threads\n", options.socket.string(), threads);
+
+    int signal = 0;
+    sigwait(&signals, &signal);
+    const smoothlife::ServerStatsFrame stats = server.stats();
+    server.stop();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    fmt::print("smoothlife_server: {} connections, {} games, {} moves in {:.1f} s\n",
+      stats.connections,
+      stats.games,
+      stats.moves,
+      elapsed.count());
+    fmt::print("  cpu        {:>12.3f} s\n", static_cast<double>(stats.cpu_ns) / 1e9);
+    return 0;
+
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("Unhandled exception in main: {}", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,599 @@
+#ifndef SMOOTHLIFE_SERVER_HPP
+#define SMOOTHLIFE_SERVER_HPP
+
+#include "config.hpp"
+#include "protocol.hpp"
+#include "timer_wheel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace smoothlife {
+
+/*
+ * The game server and its client, Linux only: epoll event loops on a Unix domain socket, see protocol.hpp for
+ * what goes over it.
+ */
+
+namespace detail {
+
+  [[noreturn]] inline void fail_errno(const std::string &what)
+  {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+
+  // owns a file descriptor and closes it
+  class FileDescriptor
+  {
+  public:
+    FileDescriptor() = default;
+
+    explicit FileDescriptor(int descriptor) : fd{ descriptor } {}
+
+    FileDescriptor(const FileDescriptor &) = delete;
+    FileDescriptor &operator=(const FileDescriptor &) = delete;
+
+    FileDescriptor(FileDescriptor &&other) noexcept : fd{ std::exchange(other.fd, -1) } {}
+
+    FileDescriptor &operator=(FileDescriptor &&other) noexcept
+    {
+      if (this != &other) {
+        close();
+        fd = std::exchange(other.fd, -1);
+      }
+      return *this;
+    }
+
+    ~FileDescriptor() { close(); }
+
+    [[nodiscard]] int get() const { return fd; }
+
+    [[nodiscard]] bool is_open() const { return fd >= 0; }
+
+    void close()
+    {
+      if (fd >= 0) { ::close(fd); }
+      fd = -1;
+    }
+
+  private:
+    int fd = -1;
+  };
+
+  inline sockaddr_un unix_address(const std::filesystem::path &path)
+  {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const std::string name = path.string();
+    if (name.empty() || name.size() >= sizeof(address.sun_path)) {
+      throw std::invalid_argument("unusable socket path " + name);
+    }
+    std::memcpy(&address.sun_path[0], name.c_str(), name.size() + 1);
+    return address;
+  }
+
+  inline std::uint64_t thread_cpu_ns()
+  {
+    timespec now{};
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<std::uint64_t>(now.tv_sec) * 1'000'000'000U + static_cast<std::uint64_t>(now.tv_nsec);
+  }
+
+}// namespace detail
+
+// every session holds a file descriptor, thousands of them need more than the usual soft limit of 1024
+inline void raise_file_limit()
+{
+  rlimit limit{};
+  if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+  }
+}
+
+// a blocking connection to the server listening on path
+inline detail::FileDescriptor connect_server(const std::filesystem::path &path)
+{
+  detail::FileDescriptor fd{ ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0) };
+  if (!fd.is_open()) { detail::fail_errno("socket"); }
+  const sockaddr_un address = detail::unix_address(path);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast) the socket api takes every address this way
+  if (::connect(fd.get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+    detail::fail_errno("cannot connect to " + path.string());
+  }
+  return fd;
+}
+
+/**
+ * @brief one session on the server, every call waits for its reply
+ *
+ * Throws std::system_error if the connection fails and std::runtime_error if the server closes it.
+ */
+class GameClient
+{
+public:
+  explicit GameClient(const std::filesystem::path &socket) : fd{ connect_server(socket) } {}
+
+  ServerFrame start(std::uint64_t seed) { return play({ ClientFrame::Type::start, 0, {}, seed }); }
+
+  ServerFrame move(Direction dir) { return play({ ClientFrame::Type::move, static_cast<std::uint8_t>(dir), {}, 0 }); }
+
+  ServerFrame state() { return play({ ClientFrame::Type::state, 0, {}, 0 }); }
+
+  ServerStatsFrame stats()
+  {
+    ServerStatsFrame reply;
+    exchange({ ClientFrame::Type::stats, 0, {}, 0 }, &reply);
+    return reply;
+  }
+
+  // any request but stats, even a malformed one
+  ServerFrame play(const ClientFrame &request)
+  {
+    ServerFrame reply;
+    exchange(request, &reply);
+    return reply;
+  }
+
+private:
+  detail::FileDescriptor fd;
+
+  void exchange(const ClientFrame &request, void *reply)
+  {
+    std::array<std::byte, sizeof(ClientFrame)> bytes{};
+    std::memcpy(bytes.data(), &request, sizeof(request));
+    for (std::size_t sent = 0; sent < bytes.size();) {
+      const ssize_t n = ::send(fd.get(), bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR) { continue; }
+      if (n < 0) { detail::fail_errno("send"); }
+      sent += static_cast<std::size_t>(n);
+    }
+
+    std::array<std::byte, sizeof(ServerFrame)> received{};
+    for (std::size_t got = 0; got < received.size();) {
+      const ssize_t n = ::recv(fd.get(), received.data() + got, received.size() - got, 0);
+      if (n < 0 && errno == EINTR) { continue; }
+      if (n < 0) { detail::fail_errno("recv"); }
+      if (n == 0) { throw std::runtime_error("the server closed the connection"); }
+      got += static_cast<std::size_t>(n);
+    }
+    std::memcpy(reply, received.data(), received.size());
+  }
+};
+
+struct ServerOptions
+{
+  std::filesystem::path socket;
+  // event loops, 0 uses every core
+  std::size_t threads = 1;
+  // energy tick of every game, like the timer of the interactive game
+  std::chrono::milliseconds tick = config::energy_decrement_time;
+};
+
+/**
+ * @brief hosts a game for every connection on a few event loops
+ *
+ * Every loop thread waits on its own epoll instance, all of them on the listening socket, and the kernel wakes
+ * only one for a new connection. A connection stays on the loop that accepted it, so its game is never
+ * shared between threads and nothing is locked. Requests are answered in the order they come, as many as a
+ * read returns at once, and the replies leave in one write. The energy ticks of all games of a loop share one
+ * timer wheel, which also sets how long the loop waits.
+ *
+ * The constructor binds and starts listening, throws std::system_error if it cannot and std::runtime_error if
+ * another server still answers on the socket. stop() or the destructor close every connection and remove the
+ * socket file.
+ */
+class GameServer
+{
+public:
+  explicit GameServer(ServerOptions opts) : options{ std::move(opts) }
+  {
+    if (options.threads == 0) { options.threads = std::max(1U, std::thread::hardware_concurrency()); }
+    if (options.tick <= std::chrono::milliseconds::zero()) { throw std::invalid_argument("the tick needs a length"); }
+
+    // a socket left by a server that did not stop, nothing else is replaced
+    std::error_code error;
+    if (std::filesystem::is_socket(options.socket, error)) {
+      if (listening(options.socket)) {
+        throw std::runtime_error("a server is already running on " + options.socket.string());
+      }
+      std::filesystem::remove(options.socket, error);
+    }
+
+    listener = detail::FileDescriptor{ ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0) };
+    if (!listener.is_open()) { detail::fail_errno("socket"); }
+    const sockaddr_un address = detail::unix_address(options.socket);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast) the socket api takes every address this way
+    if (::bind(listener.get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+      detail::fail_errno("cannot bind " + options.socket.string());
+    }
+    if (::listen(listener.get(), SOMAXCONN) != 0) { detail::fail_errno("listen"); }
+
+    for (std::size_t i = 0; i < options.threads; ++i) { loops.push_back(std::make_unique<Loop>(*this)); }
+    for (auto &loop : loops) { threads.emplace_back([&loop = *loop] { loop.run(); }); }
+  }
+
+  GameServer(const GameServer &) = delete;
+  GameServer(GameServer &&) = delete;
+  GameServer &operator=(const GameServer &) = delete;
+  GameServer &operator=(GameServer &&) = delete;
+
+  ~GameServer()
+  {
+    try {
+      stop();
+    } catch (...) {
+      // a failed loop already stopped, there is nobody left to tell
+    }
+  }
+
+  // stops every loop and closes the connections, rethrows the first error of a loop
+  void stop()
+  {
+    if (threads.empty()) { return; }
+    for (auto &loop : loops) { loop->wake(); }
+    threads.clear();
+    listener.close();
+    std::error_code error;
+    std::filesystem::remove(options.socket, error);
+    for (auto &loop : loops) {
+      if (loop->error) { std::rethrow_exception(loop->error); }
+    }
+  }
+
+  [[nodiscard]] ServerStatsFrame stats() const
+  {
+    ServerStatsFrame stats;
+    for (const auto &loop : loops) {
+      stats.sessions += loop->sessions.load(std::memory_order_relaxed);
+      stats.connections += loop->connections.load(std::memory_order_relaxed);
+      stats.games += loop->games.load(std::memory_order_relaxed);
+      stats.moves += loop->moves.load(std::memory_order_relaxed);
+      stats.cpu_ns += loop->cpu_ns.load(std::memory_order_relaxed);
+    }
+    stats.threads = loops.size();
+    return stats;
+  }
+
+private:
+  // only a refused connection shows that nobody listens on the socket any more
+  static bool listening(const std::filesystem::path &socket)
+  {
+    const detail::FileDescriptor probe{ ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0) };
+    if (!probe.is_open()) { detail::fail_errno("socket"); }
+    const sockaddr_un address = detail::unix_address(socket);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast) the socket api takes every address this way
+    if (::connect(probe.get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0) { return true; }
+    return errno != ECONNREFUSED;
+  }
+
+  class Loop
+  {
+  public:
+    std::atomic<std::uint64_t> sessions = 0;
+    std::atomic<std::uint64_t> connections = 0;
+    std::atomic<std::uint64_t> games = 0;
+    std::atomic<std::uint64_t> moves = 0;
+    std::atomic<std::uint64_t> cpu_ns = 0;
+    // set when run() ended on its own
+    std::exception_ptr error;
+
+    explicit Loop(GameServer &owner)
+      : server{ owner }, epoll{ ::epoll_create1(EPOLL_CLOEXEC) }, wakeup{ ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) },
+        wheel{ resolution(owner.options.tick), slots(owner.options.tick) }
+    {
+      if (!epoll.is_open()) { detail::fail_errno("epoll_create1"); }
+      if (!wakeup.is_open()) { detail::fail_errno("eventfd"); }
+      // only one of the loops wakes up for a connection
+      watch(server.listener.get(), EPOLLIN | EPOLLEXCLUSIVE, listener_key);
+      watch(wakeup.get(), EPOLLIN, wakeup_key);
+    }
+
+    void wake() const
+    {
+      const std::uint64_t one = 1;
+      [[maybe_unused]] const ssize_t written = ::write(wakeup.get(), &one, sizeof(one));
+    }
+
+    void run()
+    {
+      try {
+        loop();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      for (auto &connection : connection_slots) { connection.fd.close(); }
+      sessions.store(0, std::memory_order_relaxed);
+    }
+
+  private:
+    static constexpr std::uint64_t listener_key = ~std::uint64_t{ 0 };
+    static constexpr std::uint64_t wakeup_key = listener_key - 1;
+    // replies a client does not read before it is dropped
+    static constexpr std::size_t max_pending = std::size_t{ 1 } << 20U;
+    // how long a loop out of file descriptors stops accepting, unless one of its connections closes before
+    static constexpr auto accept_pause = std::chrono::milliseconds{ 100 };
+
+    struct Connection
+    {
+      detail::FileDescriptor fd;
+      // counted up when the connection closes, events and timers of an older one are dropped
+      std::uint32_t generation = 0;
+      ServerGame game;
+      std::array<std::byte, sizeof(ClientFrame)> partial{};
+      std::size_t partial_size = 0;
+      std::vector<std::byte> out;
+      std::size_t written = 0;
+      bool writing = false;
+    };
+
+    struct TimerId
+    {
+      std::uint32_t index = 0;
+      std::uint32_t generation = 0;
+    };
+
+    GameServer &server;
+    detail::FileDescriptor epoll;
+    detail::FileDescriptor wakeup;
+    TimerWheel<TimerId> wheel;
+    // a deque keeps the games where they are, their boards refer into them
+    std::deque<Connection> connection_slots;
+    std::vector<std::uint32_t> free_slots;
+    // the listener is not watched until then, see accept_all()
+    std::optional<std::chrono::steady_clock::time_point> paused_until;
+
+    static std::chrono::steady_clock::duration resolution(std::chrono::milliseconds tick)
+    {
+      return std::clamp<std::chrono::steady_clock::duration>(
+        tick / 64, std::chrono::milliseconds{ 1 }, std::chrono::milliseconds{ 10 });
+    }
+
+    static std::size_t slots(std::chrono::milliseconds tick)
+    {
+      return static_cast<std::size_t>(tick / resolution(tick)) + 2;
+    }
+
+    static std::uint64_t key(std::uint32_t index, std::uint32_t generation)
+    {
+      return (std::uint64_t{ generation } << 32U) | index;
+    }
+
+    void watch(int fd, std::uint32_t events, std::uint64_t data, int operation = EPOLL_CTL_ADD) const
+    {
+      epoll_event event{};
+      event.events = events;
+      event.data.u64 = data;
+      if (::epoll_ctl(epoll.get(), operation, fd, &event) != 0) { detail::fail_errno("epoll_ctl"); }
+    }
+
+    void loop()
+    {
+      std::array<epoll_event, 256> events{};
+      while (true) {
+        const auto now = std::chrono::steady_clock::now();
+        wheel.advance(now, [this](TimerId id) { tick(id); });
+        const auto wait = wheel.until_next(now);
+        int timeout = -1;
+        if (wait != std::chrono::steady_clock::duration::max()) {
+          const auto ms = std::chrono::ceil<std::chrono::milliseconds>(wait).count();
+          timeout = static_cast<int>(std::min<decltype(ms)>(ms, INT_MAX));
+        }
+        if (paused_until) {
+          if (now >= *paused_until) {
+            resume_accepting();
+          } else {
+            const auto ms = std::chrono::ceil<std::chrono::milliseconds>(*paused_until - now).count();
+            timeout = timeout < 0 ? static_cast<int>(ms) : std::min(timeout, static_cast<int>(ms));
+          }
+        }
+
+        const int ready = ::epoll_wait(epoll.get(), events.data(), static_cast<int>(events.size()), timeout);
+        if (ready < 0 && errno == EINTR) { continue; }
+        if (ready < 0) { detail::fail_errno("epoll_wait"); }
+
+        for (std::size_t i = 0; i < static_cast<std::size_t>(ready); ++i) {
+          const epoll_event &event = events.at(i);
+          if (event.data.u64 == wakeup_key) { return; }
+          if (event.data.u64 == listener_key) {
+            if (!paused_until) { accept_all(); }
+            continue;
+          }
+          const auto index = static_cast<std::uint32_t>(event.data.u64);
+          Connection &connection = connection_slots[index];
+          // closed and maybe reused earlier in this batch
+          if (connection.generation != static_cast<std::uint32_t>(event.data.u64 >> 32U)) { continue; }
+          if ((event.events & EPOLLIN) != 0) {
+            receive(index);
+          } else if ((event.events & (EPOLLHUP | EPOLLERR)) != 0) {
+            close(index);
+          }
+          if (connection.fd.is_open() && (event.events & EPOLLOUT) != 0) { flush(index); }
+        }
+        cpu_ns.store(detail::thread_cpu_ns(), std::memory_order_relaxed);
+      }
+    }
+
+    void accept_all()
+    {
+      while (true) {
+        detail::FileDescriptor fd{ ::accept4(server.listener.get(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC) };
+        if (!fd.is_open()) {
+          if (errno == EINTR || errno == ECONNABORTED) { continue; }
+          // out of descriptors the connection stays queued and the listener readable, which would wake the loop
+          // over and over, so it is not watched until a connection of this loop closes or the pause is over
+          if (errno == EMFILE || errno == ENFILE) {
+            watch(server.listener.get(), 0, listener_key, EPOLL_CTL_DEL);
+            paused_until = std::chrono::steady_clock::now() + accept_pause;
+          }
+          // EAGAIN once there are no more, anything else is left for the next wakeup
+          return;
+        }
+
+        std::uint32_t index = 0;
+        if (free_slots.empty()) {
+          index = static_cast<std::uint32_t>(connection_slots.size());
+          connection_slots.emplace_back();
+        } else {
+          index = free_slots.back();
+          free_slots.pop_back();
+        }
+        Connection &connection = connection_slots[index];
+        connection.fd = std::move(fd);
+        watch(connection.fd.get(), EPOLLIN, key(index, connection.generation));
+        wheel.schedule({ index, connection.generation }, server.options.tick);
+        sessions.fetch_add(1, std::memory_order_relaxed);
+        connections.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    void resume_accepting()
+    {
+      watch(server.listener.get(), EPOLLIN | EPOLLEXCLUSIVE, listener_key);
+      paused_until.reset();
+    }
+
+    void tick(TimerId id)
+    {
+      Connection &connection = connection_slots[id.index];
+      if (connection.generation != id.generation || !connection.fd.is_open()) { return; }
+      connection.game.tick();
+      wheel.schedule(id, server.options.tick);
+    }
+
+    void receive(std::uint32_t index)
+    {
+      Connection &connection = connection_slots[index];
+      std::array<std::byte, 64 * sizeof(ClientFrame)> buffer{};
+      while (true) {
+        const ssize_t n = ::recv(connection.fd.get(), buffer.data(), buffer.size(), 0);
+        if (n < 0 && errno == EINTR) { continue; }
+        if (n < 0 && errno == EAGAIN) { break; }
+        if (n <= 0) {
+          close(index);
+          return;
+        }
+
+        const auto got = static_cast<std::size_t>(n);
+        std::size_t used = 0;
+        while (used < got) {
+          const std::size_t take = std::min(got - used, connection.partial.size() - connection.partial_size);
+          std::memcpy(connection.partial.data() + connection.partial_size, buffer.data() + used, take);
+          connection.partial_size += take;
+          used += take;
+          if (connection.partial_size == connection.partial.size()) {
+            ClientFrame request;
+            std::memcpy(&request, connection.partial.data(), sizeof(request));
+            connection.partial_size = 0;
+            answer(connection, request);
+          }
+        }
+        if (got < buffer.size()) { break; }
+      }
+
+      if (connection.out.size() - connection.written > max_pending) {
+        close(index);
+        return;
+      }
+      flush(index);
+    }
+
+    void answer(Connection &connection, const ClientFrame &request)
+    {
+      std::array<std::byte, sizeof(ServerFrame)> bytes{};
+      if (request.type == ClientFrame::Type::stats) {
+        const ServerStatsFrame stats = server.stats();
+        std::memcpy(bytes.data(), &stats, sizeof(stats));
+      } else {
+        const ServerFrame reply = connection.game.handle(request);
+        if (reply.status == ServerFrame::Status::ok) {
+          if (request.type == ClientFrame::Type::move) { moves.fetch_add(1, std::memory_order_relaxed); }
+          if (request.type == ClientFrame::Type::start) { games.fetch_add(1, std::memory_order_relaxed); }
+        }
+        std::memcpy(bytes.data(), &reply, sizeof(reply));
+      }
+      connection.out.insert(connection.out.end(), bytes.begin(), bytes.end());
+    }
+
+    void flush(std::uint32_t index)
+    {
+      Connection &connection = connection_slots[index];
+      while (connection.written < connection.out.size()) {
+        const ssize_t n = ::send(connection.fd.get(),
+          connection.out.data() + connection.written,
+          connection.out.size() - connection.written,
+          MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) { continue; }
+        if (n < 0 && errno == EAGAIN) {
+          // the rest leaves once the socket takes more
+          if (!connection.writing) {
+            watch(connection.fd.get(), EPOLLIN | EPOLLOUT, key(index, connection.generation), EPOLL_CTL_MOD);
+            connection.writing = true;
+          }
+          return;
+        }
+        if (n < 0) {
+          close(index);
+          return;
+        }
+        connection.written += static_cast<std::size_t>(n);
+      }
+      connection.out.clear();
+      connection.written = 0;
+      if (connection.writing) {
+        watch(connection.fd.get(), EPOLLIN, key(index, connection.generation), EPOLL_CTL_MOD);
+        connection.writing = false;
+      }
+    }
+
+    void close(std::uint32_t index)
+    {
+      Connection &connection = connection_slots[index];
+      connection.fd.close();
+      ++connection.generation;
+      connection.game.reset();
+      connection.partial_size = 0;
+      connection.out.clear();
+      connection.written = 0;
+      connection.writing = false;
+      free_slots.push_back(index);
+      sessions.fetch_sub(1, std::memory_order_relaxed);
+      if (paused_until) { resume_accepting(); }
+    }
+  };
+
+  ServerOptions options;
+  detail::FileDescriptor listener;
+  std::vector<std::unique_ptr<Loop>> loops;
+  std::vector<std::jthread> threads;
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_SERVER_HPP
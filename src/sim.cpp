@@ -0,0 +1,263 @@
+#include "bots.hpp"
+#include "calibration.hpp"
+#include "config.hpp"
+#include "level_pack.hpp"
+#include "random.hpp"
+#include "simulation.hpp"
+#include "solver.hpp"
+#include "telemetry.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <docopt/docopt.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <internal_use_only/config.hpp>
+
+namespace smoothlife {
+
+void report(const SimulationStats &stats, std::string_view bot, std::size_t threads, double seconds)
+{
+  fmt::print("smoothlife_sim: {} games, bot {}, {} threads\n", stats.games, bot, threads);
+  fmt::print("  time       {:>12.3f} s\n", seconds);
+  fmt::print("  games/sec  {:>12.0f}\n", static_cast<double>(stats.games) / seconds);
+  fmt::print("  moves/sec  {:>12.0f}\n", static_cast<double>(stats.moves) / seconds);
+  fmt::print("  level      {:>12.2f} mean\n", static_cast<double>(stats.levels) / static_cast<double>(stats.games));
+  fmt::print("  win rate   {:>12.2f} % (score >= {})\n", 100.0 * stats.win_rate(), config::min_win_score);
+  fmt::print("  score      {:>12.1f} mean {:>10.1f} stddev\n", stats.mean(), stats.stddev());
+  fmt::print("             {:>12} min  {:>10} p10 {:>8} p50 {:>8} p90 {:>8} p99 {:>8} max\n",
+    stats.min_score,
+    stats.percentile(0.10),
+    stats.percentile(0.50),
+    stats.percentile(0.90),
+    stats.percentile(0.99),
+    stats.max_score);
+
+  // ten equally wide rows between min and max
+  static constexpr int rows = 10;
+  static constexpr int bar_width = 50;
+  const int width = std::max(SimulationStats::score_bucket, (stats.max_score - stats.min_score) / rows + 1);
+  std::array<std::uint64_t, rows> counts{};
+  for (std::size_t i = 0; i < stats.histogram.size(); ++i) {
+    const int score = static_cast<int>(i) * SimulationStats::score_bucket;
+    const auto row = static_cast<std::size_t>(std::clamp((score - stats.min_score) / width, 0, rows - 1));
+    counts.at(row) += stats.histogram[i];
+  }
+  const std::uint64_t peak = std::max<std::uint64_t>(1, *std::max_element(counts.begin(), counts.end()));
+  for (std::size_t row = 0; row < counts.size(); ++row) {
+    const int from = stats.min_score + static_cast<int>(row) * width;
+    const std::uint64_t bar = counts.at(row) * bar_width / peak;
+    fmt::print("  {:>6}..{:<6} {:>10} {}\n", from, from + width - 1, counts.at(row), std::string(bar, '#'));
+  }
+}
+
+template<class Bot>
+int run(std::uint64_t games,
+  std::uint64_t seed,
+  std::size_t threads,
+  SimulationOptions options,
+  int base,
+  std::string_view prng,
+  bool packed)
+{
+  ThreadPool pool{ threads };
+
+  if (options.levels != nullptr) {
+    const auto &info = options.levels->info();
+    if (seed < info.first_seed || seed + games > info.first_seed + info.seeds || info.first_level > 0) {
+      SPDLOG_WARN("the level pack misses some of the levels played, they are generated instead");
+    }
+  }
+
+  const bool game_board = options.width == config::board_width && options.height == config::board_height;
+  if (packed && !game_board) { throw std::invalid_argument("packed boards have the size of the game"); }
+  const auto start = std::chrono::steady_clock::now();
+  // every random engine, base and board size runs its own instantiation of the rules
+  const SimulationStats stats = with_prng(prng, [&](auto engine) {
+    using Prng = typename decltype(engine)::type;
+    return with_base(base, [&](auto b) {
+      using Board = GameBoard<config::board_width, config::board_height, Prng, decltype(b)::value>;
+      using PackedBoard = PackedGameBoard<config::board_width, config::board_height, Prng, decltype(b)::value>;
+      using SparseBoard = SparseGameBoard<Prng, decltype(b)::value>;
+      if (!game_board) { return simulate<Bot, Prng, SparseBoard>(pool, games, seed, Bot{}, options); }
+      return packed ? simulate<Bot, Prng, PackedBoard>(pool, games, seed, Bot{}, options)
+                    : simulate<Bot, Prng, Board>(pool, games, seed, Bot{}, options);
+    });
+  });
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  report(stats, Bot::name, pool.size(), elapsed.count());
+  if (options.telemetry != nullptr) {
+    options.telemetry->finish();
+    fmt::print("  telemetry  {:>12} rows\n", options.telemetry->written());
+  }
+  return 0;
+}
+
+int run_solver(std::uint64_t levels, std::uint64_t seed, std::size_t threads, int level)
+{
+  ThreadPool pool{ threads };
+
+  const auto start = std::chrono::steady_clock::now();
+  const OptimalScores optimal = solve_levels(pool, levels, seed, level);
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  const SimulationStats &stats = optimal.stats;
+  fmt::print("smoothlife_sim: solved {} levels of level {}, {} threads\n", stats.games, level, pool.size());
+  fmt::print("  time       {:>12.3f} s\n", elapsed.count());
+  fmt::print("  levels/sec {:>12.0f}\n", static_cast<double>(stats.games) / elapsed.count());
+  fmt::print("  unsolvable {:>12.2f} %\n",
+    100.0 * static_cast<double>(optimal.unsolvable) / static_cast<double>(std::max<std::uint64_t>(1, stats.games)));
+  fmt::print("  path       {:>12.2f} mean steps\n",
+    static_cast<double>(stats.moves) / static_cast<double>(std::max<std::uint64_t>(1, stats.games)));
+  fmt::print("  optimum    {:>12.1f} mean {:>10.1f} stddev\n", stats.mean(), stats.stddev());
+  fmt::print("             {:>12} min  {:>10} p10 {:>8} p50 {:>8} p90 {:>8} p99 {:>8} max\n",
+    stats.min_score,
+    stats.percentile(0.10),
+    stats.percentile(0.50),
+    stats.percentile(0.90),
+    stats.percentile(0.99),
+    stats.max_score);
+  return 0;
+}
+
+int run_calibration(std::uint64_t levels, std::uint64_t seed, std::size_t threads, int level)
+{
+  if (threads == 0) { threads = std::max<std::size_t>(1, std::thread::hardware_concurrency()); }
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto calibration = calibrate_levels(level, levels, seed, threads);
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  const auto &accepted = calibration.levels;
+  const auto count = static_cast<double>(std::max<std::size_t>(1, accepted.size()));
+  const auto mean = [&](auto member) {
+    double sum = 0;
+    for (const auto &calibrated : accepted) { sum += static_cast<double>(calibrated.difficulty.*member); }
+    return sum / count;
+  };
+  const auto band = DifficultyBand::for_level<config::board_width, config::board_height>(level);
+
+  fmt::print("smoothlife_sim: calibrated {} levels of level {}, {} threads\n", accepted.size(), level, threads);
+  fmt::print("  band       roundness >= {}, {}..{} steps, >= {} ways\n",
+    band.min_roundness,
+    band.min_steps,
+    band.max_steps,
+    band.min_ways);
+  fmt::print("  time       {:>12.3f} s\n", elapsed.count());
+  fmt::print("  levels/sec {:>12.0f} accepted\n", static_cast<double>(accepted.size()) / elapsed.count());
+  const auto candidates = static_cast<double>(std::max<std::uint64_t>(1, calibration.candidates));
+  fmt::print("  candidates {:>12} {:>10.2f} % accepted\n",
+    calibration.candidates,
+    100.0 * static_cast<double>(accepted.size()) / candidates);
+  fmt::print("  roundness  {:>12.2f} mean\n", mean(&Difficulty::roundness));
+  fmt::print("  path       {:>12.2f} mean steps\n", mean(&Difficulty::steps));
+  fmt::print("  ways       {:>12.2f} mean, counted up to {}\n", mean(&Difficulty::ways), config::counted_ways);
+  if (accepted.size() < levels) { SPDLOG_WARN("only {} of {} levels fall into the band", accepted.size(), levels); }
+  return 0;
+}
+
+}// namespace smoothlife
+
+int main(int argc, const char **argv)
+{
+  try {
+    static constexpr auto USAGE =
+      R"(
+    Usage:
+          smoothlife_sim [--games=<n>] [--seed=<s>] [--threads=<t>] [--bot=<name>] [--tick=<moves>] [--pack=<file>] [--record=<dir>] [--width=<w>] [--height=<h>] [--base=<b>] [--prng=<name>] [--telemetry=<file>] [--packed]
+          smoothlife_sim --solve [--games=<n>] [--seed=<s>] [--threads=<t>] [--level=<l>]
+          smoothlife_sim --calibrate [--games=<n>] [--seed=<s>] [--threads=<t>] [--level=<l>]
+          smoothlife_sim --version
+          smoothlife_sim (-h | --help)
+    Options:
+          -h --help        Show this screen.
+          --version        Show version.
+          --games=<n>      Number of games to play [default: 1000000].
+          --seed=<s>       Seed of the first game, game i uses seed + i [default: 1].
+          --threads=<t>    Worker threads, 0 uses every core [default: 0].
+          --bot=<name>     Bot policy: random, exit or greedy [default: greedy].
+          --tick=<moves>   Lose one energy every <moves> moves, 0 disables [default: 0].
+          --pack=<file>    Play the levels of a pack written by smoothlife_pack instead of generating them.
+          --record=<dir>   Write a replay of every game into the directory.
+          --width=<w>      Board width, other sizes than the game's play on a sparse board [default: 7].
+          --height=<h>     Board height [default: 5].
+          --base=<b>       Base the surfaces are polished in: 2, 8, 10, 12 or 16 [default: 10].
+          --prng=<name>    Random engine of the levels: ranlux24, xoshiro, pcg or philox [default: ranlux24].
+          --telemetry=<file>  Append every level and move played to a telemetry file, see smoothlife_telemetry.
+          --packed         Play on boards holding a field in a byte, same games, no packs or replays.
+          --solve          Find the optimal score of every generated level instead of playing.
+          --calibrate      Keep the first <n> generated levels inside the difficulty band of their level.
+          --level=<l>      Level to generate and solve [default: 0].
+)";
+
+    auto args = docopt::docopt(USAGE,
+      { std::next(argv), std::next(argv, argc) },
+      true,
+      fmt::format("{} {}", smoothlife::cmake::project_name, smoothlife::cmake::project_version));
+
+    const auto games = static_cast<std::uint64_t>(args["--games"].asLong());
+    const auto seed = static_cast<std::uint64_t>(args["--seed"].asLong());
+    const auto threads = static_cast<std::size_t>(args["--threads"].asLong());
+    const std::string bot = args["--bot"].asString();
+
+    if (args["--solve"].asBool()) {
+      return smoothlife::run_solver(games, seed, threads, static_cast<int>(args["--level"].asLong()));
+    }
+    if (args["--calibrate"].asBool()) {
+      return smoothlife::run_calibration(games, seed, threads, static_cast<int>(args["--level"].asLong()));
+    }
+
+    const auto base = static_cast<int>(args["--base"].asLong());
+    const std::string prng = args["--prng"].asString();
+    const bool packed = args["--packed"].asBool();
+    smoothlife::SimulationOptions options;
+    options.tick_every = static_cast<int>(args["--tick"].asLong());
+    options.width = static_cast<std::size_t>(args["--width"].asLong());
+    options.height = static_cast<std::size_t>(args["--height"].asLong());
+
+    if (args["--record"]) {
+      options.record = args["--record"].asString();
+      std::filesystem::create_directories(options.record);
+    }
+
+    std::optional<smoothlife::LevelPack> pack;
+    if (args["--pack"]) {
+      pack.emplace(args["--pack"].asString());
+      options.levels = &*pack;
+    }
+
+    std::optional<smoothlife::TelemetryWriter> telemetry;
+    if (args["--telemetry"]) {
+      telemetry.emplace(args["--telemetry"].asString());
+      options.telemetry = &*telemetry;
+    }
+
+    using namespace smoothlife::bots;
+    if (bot == RandomBot::name) {
+      return smoothlife::run<RandomBot>(games, seed, threads, options, base, prng, packed);
+    }
+    if (bot == ExitBot::name) {
+      return smoothlife::run<ExitBot>(games, seed, threads, options, base, prng, packed);
+    }
+    if (bot == GreedyBot::name) {
+      return smoothlife::run<GreedyBot>(games, seed, threads, options, base, prng, packed);
+    }
+
+    SPDLOG_ERROR("Unknown bot policy: {}", bot);
+    return 1;
+
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("Unhandled exception in main: {}", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,261 @@
+#ifndef SMOOTHLIFE_SIMULATION_HPP
+#define SMOOTHLIFE_SIMULATION_HPP
+
+#include "config.hpp"
+#include "gameboard.hpp"
+#include "level_pack.hpp"
+#include "log.hpp"
+#include "player.hpp"
+#include "random.hpp"
+#include "replay.hpp"
+#include "telemetry.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace smoothlife {
+
+struct GameResult
+{
+  int score = 0;
+  int level = 0;
+  int moves = 0;
+};
+
+struct SimulationOptions
+{
+  // lose one energy every n moves to stand in for the energy thread, 0 disables it
+  int tick_every = 0;
+  // safety net against bots that never finish
+  int max_moves = 100000;
+  // level n of the game with seed s is the record (s, n) of this pack when set, it has to outlive the games
+  const LevelPack *levels = nullptr;
+  // writes a replay of every game into this directory as <seed>.replay when set
+  std::filesystem::path record;
+  // records every game as a telemetry session with its seed as id when set, any board and base
+  TelemetryWriter *telemetry = nullptr;
+  // size of the board, the size of the game unless the simulator plays on a SparseGameBoard
+  std::size_t width = config::board_width;
+  std::size_t height = config::board_height;
+};
+
+/**
+ * @brief score distribution of a batch of games
+ *
+ * Scores are counted in buckets of score_bucket points, percentiles are exact up to one bucket.
+ */
+struct SimulationStats
+{
+  static constexpr int score_bucket = 10;
+
+  std::uint64_t games = 0;
+  std::uint64_t moves = 0;
+  std::uint64_t wins = 0;
+  std::uint64_t levels = 0;
+  double score_sum = 0;
+  double score_square_sum = 0;
+  int min_score = std::numeric_limits<int>::max();
+  int max_score = std::numeric_limits<int>::min();
+  std::vector<std::uint64_t> histogram;
+
+  void add(const GameResult &result)
+  {
+    ++games;
+    moves += static_cast<std::uint64_t>(result.moves);
+    levels += static_cast<std::uint64_t>(result.level);
+    if (result.score >= config::min_win_score) { ++wins; }
+
+    const auto score = static_cast<double>(result.score);
+    score_sum += score;
+    score_square_sum += score * score;
+    min_score = std::min(min_score, result.score);
+    max_score = std::max(max_score, result.score);
+
+    const auto bucket = static_cast<std::size_t>(std::max(result.score, 0) / score_bucket);
+    if (bucket >= histogram.size()) { histogram.resize(bucket + 1); }
+    ++histogram[bucket];
+  }
+
+  void merge(const SimulationStats &other)
+  {
+    games += other.games;
+    moves += other.moves;
+    wins += other.wins;
+    levels += other.levels;
+    score_sum += other.score_sum;
+    score_square_sum += other.score_square_sum;
+    min_score = std::min(min_score, other.min_score);
+    max_score = std::max(max_score, other.max_score);
+
+    if (other.histogram.size() > histogram.size()) { histogram.resize(other.histogram.size()); }
+    for (std::size_t i = 0; i < other.histogram.size(); ++i) { histogram[i] += other.histogram[i]; }
+  }
+
+  [[nodiscard]] double mean() const { return games == 0 ? 0.0 : score_sum / static_cast<double>(games); }
+
+  [[nodiscard]] double stddev() const
+  {
+    if (games == 0) { return 0.0; }
+    const double m = mean();
+    return std::sqrt(std::max(0.0, score_square_sum / static_cast<double>(games) - m * m));
+  }
+
+  [[nodiscard]] double win_rate() const
+  {
+    return games == 0 ? 0.0 : static_cast<double>(wins) / static_cast<double>(games);
+  }
+
+  // lower bound of the bucket holding the q-th quantile
+  [[nodiscard]] int percentile(double q) const
+  {
+    const auto rank = static_cast<std::uint64_t>(q * static_cast<double>(games));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < histogram.size(); ++i) {
+      seen += histogram[i];
+      if (seen > rank) { return static_cast<int>(i) * score_bucket; }
+    }
+    return max_score;
+  }
+};
+
+/**
+ * @brief plays complete games without any ui
+ *
+ * Holds one game and reuses it for every seed, so a batch does not pay for construction per game.
+ * Level packs and replays only exist for the board of the game in the default base, not its packed twin,
+ * replays only for the default random engine.
+ */
+template<class Bot,
+  class Prng = std::ranlux24,
+  class Board = GameBoard<config::board_width, config::board_height, Prng>>
+class Simulator
+{
+public:
+  explicit Simulator(Bot b = {}, SimulationOptions opts = {}) : bot{ b }, options{ std::move(opts) }
+  {
+    check(options);
+    if (options.telemetry != nullptr) { telemetry.emplace(*options.telemetry, board); }
+  }
+
+  // throws std::invalid_argument for options this board or engine cannot play
+  static void check(const SimulationOptions &options)
+  {
+    if (!game_board && (options.levels != nullptr || !options.record.empty())) {
+      throw std::invalid_argument("level packs and replays need the board of the game");
+    }
+    if (!std::is_same_v<Prng, std::ranlux24> && !options.record.empty()) {
+      throw std::invalid_argument("replays are verified with the default random engine");
+    }
+  }
+
+  // the board keeps references into this object
+  Simulator(const Simulator &) = delete;
+  Simulator(Simulator &&) = delete;
+  Simulator &operator=(const Simulator &) = delete;
+  Simulator &operator=(Simulator &&) = delete;
+  ~Simulator() = default;
+
+  GameResult play(std::uint64_t seed)
+  {
+    seed_prng(prng, seed);
+    bot_rnd.seed(seed % std::minstd_rand::modulus);
+
+    player.reset();
+    log.clear();
+    if constexpr (game_board) {
+      if (options.levels != nullptr) { use_level_pack(board, *options.levels, seed); }
+    }
+    board.level = 0;
+    board.stage = GameStage::game;
+    if (telemetry) { telemetry->begin(seed); }
+    board.next_level();
+
+    std::optional<ReplayRecorder> recording;
+    if (!options.record.empty()) {
+      const std::uint32_t flags =
+        ReplayHeader::skip_tutorial | (options.levels != nullptr ? ReplayHeader::level_pack : 0U);
+      recording.emplace(seed, flags, seed);
+    }
+
+    int moves = 0;
+    while (board.stage == GameStage::game && player.energy > 0 && moves < options.max_moves) {
+      const Direction dir = bot(board, bot_rnd);
+      if (!player.move(dir)) { break; }
+      ++moves;
+      if (recording) { recording->record(replay_event(dir)); }
+
+      if (options.tick_every > 0 && moves % options.tick_every == 0 && board.stage == GameStage::game) {
+        player.energy -= 1;
+        if (recording) { recording->record(ReplayEvent::tick); }
+      }
+    }
+
+    if (recording) { recording->save(options.record / fmt::format("{}.replay", seed), player.score, board.level); }
+    if (telemetry) { telemetry->end(player.score, board.level, moves); }
+    return { player.score, board.level, moves };
+  }
+
+  [[nodiscard]] const Board &game() const { return board; }
+
+private:
+  static constexpr bool game_board =
+    std::is_same_v<Board, GameBoard<config::board_width, config::board_height, Prng>>;
+
+  Bot bot;
+  SimulationOptions options;
+  std::minstd_rand bot_rnd;
+
+  Player player;
+  Log log{ config::log_length };
+  Prng prng;
+  Board board{ prng, player, log, options.width, options.height };
+  std::optional<TelemetrySession> telemetry;
+};
+
+/**
+ * @brief plays the seeds [first_seed, first_seed + games) on the pool
+ *
+ * Games are handed out in chunks, idle workers steal chunks from busy ones.
+ */
+template<class Bot,
+  class Prng = std::ranlux24,
+  class Board = GameBoard<config::board_width, config::board_height, Prng>>
+SimulationStats simulate(ThreadPool &pool,
+  std::uint64_t games,
+  std::uint64_t first_seed,
+  Bot bot = {},
+  SimulationOptions options = {})
+{
+  static constexpr std::uint64_t chunk_size = 1024;
+  // on this thread, the workers have nobody to throw to
+  Simulator<Bot, Prng, Board>::check(options);
+  const std::uint64_t chunks = (games + chunk_size - 1) / chunk_size;
+
+  std::vector<SimulationStats> results(chunks);
+  for (std::uint64_t chunk = 0; chunk < chunks; ++chunk) {
+    pool.submit([&, chunk] {
+      Simulator<Bot, Prng, Board> simulator{ bot, options };
+      SimulationStats &stats = results[chunk];
+      const std::uint64_t end = std::min(games, (chunk + 1) * chunk_size);
+      for (std::uint64_t game = chunk * chunk_size; game < end; ++game) {
+        stats.add(simulator.play(first_seed + game));
+      }
+    });
+  }
+  pool.wait();
+
+  SimulationStats total;
+  for (const auto &stats : results) { total.merge(stats); }
+  return total;
+}
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_SIMULATION_HPP
@@ -0,0 +1,103 @@
+#ifndef SMOOTHLIFE_ENV_H
+#define SMOOTHLIFE_ENV_H
+
+/*
+ * C interface of the vector environments, see vector_env.hpp, for training code in any language with a
+ * foreign function interface. Every game is the game board of smoothlife in base 10, its levels drawn with
+ * xoshiro256**. The buffers returned stay valid and unchanged until the next step of their environment.
+ * Functions returning int return 0 on success and -1 on failure, smoothlife_env_last_error() tells why.
+ */
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(SMOOTHLIFE_ENV_BUILD)
+#define SMOOTHLIFE_ENV_API __declspec(dllexport)
+#else
+#define SMOOTHLIFE_ENV_API __declspec(dllimport)
+#endif
+#else
+#define SMOOTHLIFE_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct smoothlife_env smoothlife_env;
+
+/* actions */
+enum { SMOOTHLIFE_ENV_UP = 0, SMOOTHLIFE_ENV_LEFT = 1, SMOOTHLIFE_ENV_DOWN = 2, SMOOTHLIFE_ENV_RIGHT = 3 };
+
+/* dones */
+enum { SMOOTHLIFE_ENV_RUNNING = 0, SMOOTHLIFE_ENV_GAME_OVER = 1, SMOOTHLIFE_ENV_TRUNCATED = 2 };
+
+/* columns of smoothlife_env_state() */
+typedef enum smoothlife_env_column {
+  SMOOTHLIFE_ENV_X = 0,
+  SMOOTHLIFE_ENV_Y = 1,
+  SMOOTHLIFE_ENV_ENERGY = 2,
+  SMOOTHLIFE_ENV_LIVES = 3,
+  SMOOTHLIFE_ENV_SCORE = 4,
+  SMOOTHLIFE_ENV_LEVEL = 5,
+  SMOOTHLIFE_ENV_STEPS = 6
+} smoothlife_env_column;
+
+typedef struct smoothlife_env_options
+{
+  /* game i of n plays the seeds first_seed + i, first_seed + i + n, ... */
+  uint64_t first_seed;
+  /* lose one energy every n steps, 0 disables it */
+  int32_t tick_every;
+  /* a game is cut off after this many steps */
+  int32_t max_moves;
+  /* threads stepping the games, 0 uses every core */
+  uint32_t threads;
+} smoothlife_env_options;
+
+/* first_seed 1, no ticks, 100000 moves, one thread */
+SMOOTHLIFE_ENV_API smoothlife_env_options smoothlife_env_default_options(void);
+
+/* count games, NULL on failure */
+SMOOTHLIFE_ENV_API smoothlife_env *smoothlife_env_create(uint32_t count, const smoothlife_env_options *options);
+
+SMOOTHLIFE_ENV_API void smoothlife_env_destroy(smoothlife_env *env);
+
+SMOOTHLIFE_ENV_API uint32_t smoothlife_env_size(const smoothlife_env *env);
+
+/* bytes of observation per game, the cells of the board */
+SMOOTHLIFE_ENV_API uint32_t smoothlife_env_observation_size(void);
+
+SMOOTHLIFE_ENV_API uint32_t smoothlife_env_width(void);
+
+SMOOTHLIFE_ENV_API uint32_t smoothlife_env_height(void);
+
+/* moves player i in direction actions[i], one action per game */
+SMOOTHLIFE_ENV_API int smoothlife_env_step(smoothlife_env *env, const uint8_t *actions);
+
+/* size * observation_size bytes, the fields of game i row by row from the bottom, type * 16 + value */
+SMOOTHLIFE_ENV_API const uint8_t *smoothlife_env_observations(const smoothlife_env *env);
+
+/* score gained by the last step, one per game */
+SMOOTHLIFE_ENV_API const float *smoothlife_env_rewards(const smoothlife_env *env);
+
+/* SMOOTHLIFE_ENV_RUNNING, GAME_OVER or TRUNCATED by the last step, a finished game already started anew */
+SMOOTHLIFE_ENV_API const uint8_t *smoothlife_env_dones(const smoothlife_env *env);
+
+/* one value of the column per game, NULL for an unknown column */
+SMOOTHLIFE_ENV_API const int32_t *smoothlife_env_state(const smoothlife_env *env, smoothlife_env_column column);
+
+/* the surface of every game */
+SMOOTHLIFE_ENV_API const long *smoothlife_env_surfaces(const smoothlife_env *env);
+
+/* the seed of the running game of every game */
+SMOOTHLIFE_ENV_API const uint64_t *smoothlife_env_seeds(const smoothlife_env *env);
+
+/* message of the last failure on this thread */
+SMOOTHLIFE_ENV_API const char *smoothlife_env_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SMOOTHLIFE_ENV_H */
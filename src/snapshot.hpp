@@ -0,0 +1,406 @@
+#ifndef SMOOTHLIFE_SNAPSHOT_HPP
+#define SMOOTHLIFE_SNAPSHOT_HPP
+
+#include "config.hpp"
+#include "field.hpp"
+#include "gameboard.hpp"
+#include "log.hpp"
+#include "player.hpp"
+#include "surface.hpp"
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace smoothlife {
+
+/**
+ * @brief file header of a snapshot of a running game
+ *
+ * Followed by the player, the log from the oldest event on, the fields that are not empty and the state of
+ * the random engine in its text form, the only form the standard engines have. Integers are little endian.
+ */
+struct SnapshotHeader
+{
+  static constexpr std::array<char, 8> signature{ 'S', 'M', 'L', 'S', 'N', 'A', 'P', 'S' };
+  static constexpr std::uint32_t current_version = 1;
+
+  std::array<char, 8> magic = signature;
+  std::uint32_t version = current_version;
+  // a snapshot only restores into a board of the same base and size
+  std::uint32_t base = 0;
+  std::uint64_t width = 0;
+  std::uint64_t height = 0;
+  std::int32_t stage = 0;
+  std::int32_t level = 0;
+};
+
+static_assert(sizeof(SnapshotHeader) == 40);
+static_assert(std::is_trivially_copyable_v<SnapshotHeader>);
+
+namespace detail {
+
+  class SnapshotWriter
+  {
+  public:
+    explicit SnapshotWriter(std::vector<std::byte> &out) : bytes{ &out } {}
+
+    template<class T> void put(const T &value)
+    {
+      static_assert(std::is_trivially_copyable_v<T>);
+      const std::size_t at = bytes->size();
+      bytes->resize(at + sizeof(T));
+      std::memcpy(bytes->data() + at, &value, sizeof(T));
+    }
+
+    void put(std::span<const char> text)
+    {
+      put(static_cast<std::uint32_t>(text.size()));
+      const std::size_t at = bytes->size();
+      bytes->resize(at + text.size());
+      std::memcpy(bytes->data() + at, text.data(), text.size());
+    }
+
+  private:
+    std::vector<std::byte> *bytes;
+  };
+
+  // every read checks the bounds, a cut off or corrupt snapshot throws std::runtime_error
+  class SnapshotReader
+  {
+  public:
+    explicit SnapshotReader(std::span<const std::byte> in) : bytes{ in } {}
+
+    template<class T> T get()
+    {
+      static_assert(std::is_trivially_copyable_v<T>);
+      T value;
+      std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+      return value;
+    }
+
+    std::string get_text()
+    {
+      const std::span<const std::byte> text = take(get<std::uint32_t>());
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      return { reinterpret_cast<const char *>(text.data()), text.size() };
+    }
+
+    // count if that many items of size still follow, a corrupt count cannot allocate more than the snapshot
+    [[nodiscard]] std::size_t fit(std::uint32_t count, std::size_t size) const
+    {
+      if (count > bytes.size() / size) { throw std::runtime_error("truncated snapshot"); }
+      return count;
+    }
+
+    [[nodiscard]] bool done() const { return bytes.empty(); }
+
+  private:
+    std::span<const std::byte> bytes;
+
+    std::span<const std::byte> take(std::size_t size)
+    {
+      if (size > bytes.size()) { throw std::runtime_error("truncated snapshot"); }
+      const auto taken = bytes.first(size);
+      bytes = bytes.subspan(size);
+      return taken;
+    }
+  };
+
+  struct SnapshotField
+  {
+    std::uint32_t x = 0;
+    std::uint32_t y = 0;
+    std::int32_t type = 0;
+    std::int32_t value = 0;
+  };
+
+  struct SnapshotEvent
+  {
+    std::int32_t message = 0;
+    std::int32_t score = 0;
+    std::int32_t energy = 0;
+  };
+
+}// namespace detail
+
+/**
+ * @brief the whole state of a running game: board, player, log and random engine
+ *
+ * Everything but the ui parts of the player, its interaction and bounds, which belong to the board. The
+ * default board takes a few microseconds, most of it for the text of the random engine.
+ */
+template<class Board> void save_snapshot(const Board &board, std::vector<std::byte> &out)
+{
+  out.clear();
+  detail::SnapshotWriter writer{ out };
+
+  SnapshotHeader header;
+  header.base = static_cast<std::uint32_t>(Board::base);
+  header.width = board.width();
+  header.height = board.height();
+  header.stage = static_cast<std::int32_t>(board.stage);
+  header.level = board.level;
+  writer.put(header);
+
+  const Player &player = board.player;
+  for (const int value : { player.x, player.y, player.score, player.steps, player.energy, player.lives }) {
+    writer.put(static_cast<std::int32_t>(value));
+  }
+  const Surface::Digits surface = player.surface.digits();
+  writer.put(static_cast<std::uint8_t>(surface.negative));
+  writer.put(static_cast<std::uint32_t>(surface.magnitude.size()));
+  for (const std::uint32_t digit : surface.magnitude) { writer.put(digit); }
+
+  const Log &log = board.log;
+  writer.put(static_cast<std::uint32_t>(log.size()));
+  for (std::size_t i = log.size(); i-- > 0;) {
+    const Log::Event &event = log[i];
+    writer.put(detail::SnapshotEvent{ static_cast<std::int32_t>(event.message), event.score, event.energy });
+  }
+
+  std::uint32_t fields = 0;
+  board.for_each_field([&](int, int, const Field &) { ++fields; });
+  writer.put(fields);
+  board.for_each_field([&](int x, int y, const Field &field) {
+    writer.put(detail::SnapshotField{ static_cast<std::uint32_t>(x),
+      static_cast<std::uint32_t>(y),
+      static_cast<std::int32_t>(field.type),
+      field.value });
+  });
+
+  std::ostringstream engine;
+  engine << board.rnd;
+  writer.put(std::span<const char>{ engine.view() });
+}
+
+template<class Board> [[nodiscard]] std::vector<std::byte> save_snapshot(const Board &board)
+{
+  std::vector<std::byte> bytes;
+  save_snapshot(board, bytes);
+  return bytes;
+}
+
+/**
+ * @brief puts a game back into the state of a snapshot
+ *
+ * Throws std::runtime_error if the snapshot is corrupt or was taken of a board of another size or base, the
+ * game is left untouched then.
+ */
+template<class Board> void load_snapshot(Board &board, std::span<const std::byte> bytes)
+{
+  detail::SnapshotReader reader{ bytes };
+  const auto header = reader.get<SnapshotHeader>();
+  if (header.magic != SnapshotHeader::signature) { throw std::runtime_error("not a snapshot"); }
+  if (header.version != SnapshotHeader::current_version) {
+    throw std::runtime_error(fmt::format("unsupported snapshot version {}", header.version));
+  }
+  if (header.base != static_cast<std::uint32_t>(Board::base) || header.width != board.width()
+      || header.height != board.height()) {
+    throw std::runtime_error(
+      fmt::format("snapshot of a {}x{} board in base {}", header.width, header.height, header.base));
+  }
+  if (header.stage < static_cast<int>(GameStage::intro) || header.stage > static_cast<int>(GameStage::ending)) {
+    throw std::runtime_error("corrupt snapshot");
+  }
+
+  Player player;
+  for (int *value : { &player.x, &player.y, &player.score, &player.steps, &player.energy, &player.lives }) {
+    *value = reader.get<std::int32_t>();
+  }
+  if (player.x < 0 || player.y < 0 || static_cast<std::uint64_t>(player.x) >= header.width
+      || static_cast<std::uint64_t>(player.y) >= header.height || player.lives < 0
+      || player.lives > config::player_lives) {
+    throw std::runtime_error("corrupt snapshot");
+  }
+  Surface::Digits surface;
+  surface.negative = reader.get<std::uint8_t>() != 0;
+  surface.magnitude.resize(reader.fit(reader.get<std::uint32_t>(), sizeof(std::uint32_t)));
+  for (std::uint32_t &digit : surface.magnitude) { digit = reader.get<std::uint32_t>(); }
+  try {
+    player.surface = Surface::from_digits(surface);
+  } catch (const std::overflow_error &) {
+    throw std::runtime_error("corrupt snapshot");
+  }
+
+  const std::uint32_t event_count = reader.get<std::uint32_t>();
+  std::vector<detail::SnapshotEvent> events(reader.fit(event_count, sizeof(detail::SnapshotEvent)));
+  for (auto &event : events) {
+    event = reader.get<detail::SnapshotEvent>();
+    if (event.message < 0 || static_cast<std::size_t>(event.message) >= Log::messages.size()) {
+      throw std::runtime_error("corrupt snapshot");
+    }
+  }
+
+  const std::uint32_t field_count = reader.get<std::uint32_t>();
+  std::vector<detail::SnapshotField> fields(reader.fit(field_count, sizeof(detail::SnapshotField)));
+  std::size_t exits = 0;
+  for (auto &field : fields) {
+    field = reader.get<detail::SnapshotField>();
+    if (field.x >= header.width || field.y >= header.height || field.type <= 0
+        || field.type > static_cast<std::int32_t>(Field::Type::div)) {
+      throw std::runtime_error("corrupt snapshot");
+    }
+    // the game only plays levels like the ones it generates: operations of a nonzero digit, the exit in the
+    // corner opposite to the start, anything else would throw in the middle of a move instead of here
+    if (field.type == static_cast<std::int32_t>(Field::Type::exit)) {
+      if (field.x != header.width - 1 || field.y != header.height - 1) { throw std::runtime_error("corrupt snapshot"); }
+      ++exits;
+    } else if (field.value < 1 || field.value >= Board::base) {
+      throw std::runtime_error("corrupt snapshot");
+    }
+  }
+  if (exits != 1) { throw std::runtime_error("corrupt snapshot"); }
+
+  std::istringstream engine{ reader.get_text() };
+  auto rnd = board.rnd;
+  engine >> rnd;
+  // text left over belongs to another engine that happens to start the same way
+  if (!engine || !(engine >> std::ws).eof() || !reader.done()) { throw std::runtime_error("corrupt snapshot"); }
+
+  // nothing below throws
+  board.stage = static_cast<GameStage>(header.stage);
+  board.level = header.level;
+  board.rnd = rnd;
+  board.state.clear();
+  for (const auto &field : fields) {
+    board.set_field(static_cast<int>(field.x),
+      static_cast<int>(field.y),
+      { static_cast<Field::Type>(field.type), field.value });
+  }
+  board.log.clear();
+  for (const auto &event : events) {
+    board.log.post_event(static_cast<Log::Message>(event.message), event.score, event.energy);
+  }
+  Player &restored = board.player;
+  restored.x = player.x;
+  restored.y = player.y;
+  restored.surface = std::move(player.surface);
+  restored.score = player.score;
+  restored.steps = player.steps;
+  restored.energy = player.energy;
+  restored.lives = player.lives;
+}
+
+/**
+ * @brief keeps the newest snapshot of a game on disk from a thread of its own
+ *
+ * save() hands the snapshot over and returns, the writer writes it to a temporary file next to the target and
+ * renames it over the target, a crash leaves the last complete snapshot. Snapshots taken while the writer is
+ * busy replace each other, only the newest one is written. The mutex only guards the handover.
+ */
+class Autosaver
+{
+public:
+  explicit Autosaver(std::filesystem::path file)
+    : path{ std::move(file) }, worker{ [this](const std::stop_token &stop) { work(stop); } }
+  {}
+
+  Autosaver(const Autosaver &) = delete;
+  Autosaver(Autosaver &&) = delete;
+  Autosaver &operator=(const Autosaver &) = delete;
+  Autosaver &operator=(Autosaver &&) = delete;
+
+  // writes the last snapshot handed over before stopping
+  ~Autosaver() = default;
+
+  // takes the snapshot of the board, the buffer of the previous one is reused
+  template<class Board> void save(const Board &board)
+  {
+    {
+      const std::scoped_lock lock{ mutex };
+      save_snapshot(board, pending);
+      has_pending = true;
+      ++requested;
+    }
+    wake.notify_one();
+  }
+
+  // waits until everything handed over is on disk, throws std::runtime_error if the last write failed
+  void flush()
+  {
+    std::unique_lock lock{ mutex };
+    written.wait(lock, [this] { return completed == requested; });
+    if (error) { std::rethrow_exception(error); }
+  }
+
+private:
+  void work(const std::stop_token &stop)
+  {
+    std::vector<std::byte> bytes;
+    while (true) {
+      std::uint64_t taken = 0;
+      {
+        std::unique_lock lock{ mutex };
+        // a stop still writes what is pending
+        wake.wait(lock, stop, [this] { return has_pending; });
+        if (!has_pending) { return; }
+        std::swap(bytes, pending);
+        has_pending = false;
+        taken = requested;
+      }
+
+      std::exception_ptr failure;
+      try {
+        write(bytes);
+      } catch (const std::exception &) {
+        failure = std::current_exception();
+      }
+
+      {
+        const std::scoped_lock lock{ mutex };
+        completed = taken;
+        error = failure;
+      }
+      written.notify_all();
+    }
+  }
+
+  void write(std::span<const std::byte> bytes) const
+  {
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+      std::ofstream out{ temporary, std::ios::binary | std::ios::trunc };
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+      if (!out.flush()) { throw std::runtime_error("cannot write " + temporary.string()); }
+    }
+    std::filesystem::rename(temporary, path);
+  }
+
+  std::filesystem::path path;
+
+  std::mutex mutex;
+  std::condition_variable_any wake;
+  std::condition_variable_any written;
+  std::vector<std::byte> pending;
+  bool has_pending = false;
+  std::uint64_t requested = 0;
+  std::uint64_t completed = 0;
+  std::exception_ptr error;
+
+  // writes the newest pending snapshot, save() only hands it over, declared last so that the destructor joins
+  // it after it wrote what was still pending
+  std::jthread worker;
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_SNAPSHOT_HPP
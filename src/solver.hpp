@@ -0,0 +1,605 @@
+#ifndef SMOOTHLIFE_SOLVER_HPP
+#define SMOOTHLIFE_SOLVER_HPP
+
+#include "config.hpp"
+#include "field.hpp"
+#include "gameboard.hpp"
+#include "player.hpp"
+#include "random.hpp"
+#include "simulation.hpp"
+#include "thread_pool.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace smoothlife {
+
+struct Solution
+{
+  // false if every reachable exit leaves the surface rough and costs a life
+  bool solved = false;
+  int score = 0;
+  int roundness = 0;
+  // steps of the level when leaving, including the ones taken before solving
+  int steps = 0;
+  long surface = 0;
+  std::vector<Direction> path;
+};
+
+// lets a caller follow a running search and stop it early
+struct SolveControl
+{
+  // once set, from any thread, solve() returns the best solution found so far
+  const std::atomic<bool> *stop = nullptr;
+  // called with every better solution as soon as it is found, path included
+  std::function<void(const Solution &)> improved;
+};
+
+/**
+ * @brief exact search for the highest scoring way through a level
+ *
+ * Walking over an operation applies it, so the search only branches when a new operation or the exit is
+ * entered: the distances in between are breadth first searches over empty and already consumed fields.
+ *
+ * States are (consumed operations, position, surface) and are expanded in order of steps taken, so the
+ * transposition table holds the fewest steps of every state and nothing is expanded twice. The exit is
+ * scored like the interaction of the GameBoard, (roundness + level) * (player_energy - steps), and states
+ * whose best possible exit cannot beat the best one found so far are dropped. All states with the same
+ * number of steps are independent and get expanded in parallel when a pool is given.
+ *
+ * The search is anytime: a first solution is usually found after a few expansions and improves from there,
+ * SolveControl reports each one and stops the search when its answer is no longer needed.
+ */
+class Solver
+{
+public:
+  static constexpr std::size_t max_operations = 64;
+  // the board is searched as one 64 bit row mask per line
+  static constexpr int max_side = 64;
+
+  // everything the search needs to know about a running level
+  struct Level
+  {
+    int width = 0;
+    int height = 0;
+    std::vector<Field> fields;
+    int x = 0;
+    int y = 0;
+    long surface = 0;
+    int steps = 0;
+    int energy = 0;
+    int level = 0;
+  };
+
+  // the search works on longs, a surface that outgrew them throws std::overflow_error
+  template<class Grid, class Prng>
+    requires Grid::fixed_size
+  [[nodiscard]] static Level capture(const BasicGameBoard<Grid, Prng> &board)
+  {
+    const Player &player = board.player;
+    std::vector<Field> fields(Grid::size());
+    for (std::size_t i = 0; i < fields.size(); ++i) { fields[i] = board.state[i]; }
+    return { static_cast<int>(Grid::width()),
+      static_cast<int>(Grid::height()),
+      std::move(fields),
+      player.x,
+      player.y,
+      player.surface.to_long(),
+      player.steps,
+      player.energy,
+      board.level };
+  }
+
+  explicit Solver(Level l) : level{ std::move(l) }
+  {
+    cell_operation.assign(level.fields.size(), no_operation);
+    for (std::size_t cell = 0; cell < level.fields.size(); ++cell) {
+      const Field::Type type = level.fields[cell].type;
+      if (type == Field::Type::exit) {
+        exit_cell = static_cast<int>(cell);
+      } else if (type != Field::Type::empty) {
+        cell_operation[cell] = static_cast<int>(operations.size());
+        operations.push_back(static_cast<int>(cell));
+      }
+    }
+    if (operations.size() > max_operations) { throw std::length_error("too many operations to solve"); }
+    if (level.width > max_side || level.height > max_side) { throw std::length_error("board too large to solve"); }
+
+    for (std::size_t cell = 0; cell < level.fields.size(); ++cell) {
+      if (level.fields[cell].type == Field::Type::empty) { empty_rows.at(row(cell)) |= bit(cell); }
+    }
+    for (int op : operations) {
+      const Field &field = level.fields[static_cast<std::size_t>(op)];
+      if (field.type == Field::Type::add || field.type == Field::Type::sub) {
+        summand.push_back(std::abs(static_cast<double>(field.value)));
+        factor_digits.push_back(0);
+      } else if (field.type == Field::Type::mul && field.value != 0) {
+        summand.push_back(0);
+        factor_digits.push_back(std::log10(std::abs(static_cast<double>(field.value))));
+      } else {
+        summand.push_back(0);
+        factor_digits.push_back(0);
+      }
+    }
+  }
+
+  [[nodiscard]] Solution solve(ThreadPool *pool = nullptr, const SolveControl &solve_control = {})
+  {
+    static constexpr std::size_t min_parallel_states = 256;
+    static constexpr std::size_t states_per_task = 64;
+
+    best_score = std::numeric_limits<int>::min();
+    best = Solution{};
+    best_state = no_state;
+    control = &solve_control;
+    states.clear();
+    buckets.clear();
+    visited.clear();
+    if (exit_cell < 0) { return best; }
+
+    push({ 0, level.surface, cell(level.x, level.y), level.steps, no_state });
+
+    // buckets only grow behind the one being expanded, operations are at least one step away
+    for (std::size_t steps = static_cast<std::size_t>(level.steps); steps < buckets.size(); ++steps) {
+      if (stopped()) { break; }
+      const std::vector<std::size_t> bucket = std::move(buckets[steps]);
+
+      if (pool == nullptr || pool->size() < 2 || bucket.size() < min_parallel_states) {
+        std::vector<State> successors;
+        for (std::size_t index : bucket) { expand(index, successors); }
+        for (const State &successor : successors) { push(successor); }
+        continue;
+      }
+
+      const std::size_t tasks = (bucket.size() + states_per_task - 1) / states_per_task;
+      std::vector<std::vector<State>> successors(tasks);
+      for (std::size_t task = 0; task < tasks; ++task) {
+        pool->submit([&, task] {
+          const std::size_t end = std::min(bucket.size(), (task + 1) * states_per_task);
+          for (std::size_t i = task * states_per_task; i < end; ++i) { expand(bucket[i], successors[task]); }
+        });
+      }
+      pool->wait();
+      for (const auto &found : successors) {
+        for (const State &successor : found) { push(successor); }
+      }
+    }
+
+    if (best.solved && best.path.empty()) { best.path = directions(best_state); }
+    control = nullptr;
+    return best;
+  }
+
+  /**
+   * @brief ways to win the level, counted up to limit
+   *
+   * A way ends at the exit with a round surface before the energy runs out. Ways over the same operations with
+   * the same last one and surface count once, however they were walked. Counting searches without the score
+   * bound, a level with few ways costs a full search of its states.
+   */
+  [[nodiscard]] std::size_t winning_ways(std::size_t limit, ThreadPool *pool = nullptr)
+  {
+    if (limit == 0) { return 0; }
+    win_limit = limit;
+    wins = 0;
+    (void)solve(pool);
+    win_limit = 0;
+    return std::min(wins.load(), limit);
+  }
+
+  // states the last solve() queued, a measure of how hard the level was
+  [[nodiscard]] std::size_t states_explored() const { return states.size(); }
+
+private:
+  static constexpr int no_operation = -1;
+  static constexpr int unreachable = -1;
+  static constexpr std::size_t no_state = std::numeric_limits<std::size_t>::max();
+  static constexpr int max_roundness = smoothlife::max_roundness<config::base>;
+
+  struct State
+  {
+    std::uint64_t consumed = 0;
+    long surface = 0;
+    int position = 0;
+    int steps = 0;
+    std::size_t previous = no_state;
+  };
+
+  struct Key
+  {
+    std::uint64_t consumed;
+    long surface;
+    int position;
+    bool operator==(const Key &) const = default;
+  };
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key &key) const
+    {
+      std::uint64_t h = key.consumed * 0x9E3779B97F4A7C15ULL;
+      h ^= static_cast<std::uint64_t>(key.surface) + 0x7F4A7C159E3779B9ULL + (h << 6) + (h >> 2);
+      h ^= static_cast<std::uint64_t>(key.position) + (h << 6) + (h >> 2);
+      return std::hash<std::uint64_t>{}(h);
+    }
+  };
+
+  // steps to every operation, the exit is the last entry
+  using Distances = std::array<int, max_operations + 1>;
+  using Rows = std::array<std::uint64_t, max_side>;
+
+  Level level;
+  std::vector<int> operations;
+  std::vector<int> cell_operation;
+  int exit_cell = -1;
+
+  std::vector<State> states;
+  std::vector<std::vector<std::size_t>> buckets;
+  std::unordered_map<Key, int, KeyHash> visited;
+
+  Rows empty_rows{};
+  std::vector<double> summand;
+  std::vector<double> factor_digits;
+
+  std::atomic<int> best_score = std::numeric_limits<int>::min();
+  std::mutex best_mutex;
+  Solution best;
+  std::size_t best_state = no_state;
+  const SolveControl *control = nullptr;
+
+  // set by winning_ways(), the bound is off and every winning exit is counted until the limit is reached
+  std::size_t win_limit = 0;
+  std::atomic<std::size_t> wins = 0;
+
+  [[nodiscard]] bool stopped() const
+  {
+    if (win_limit != 0 && wins.load(std::memory_order_relaxed) >= win_limit) { return true; }
+    return control->stop != nullptr && control->stop->load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] int cell(int x, int y) const { return x + level.width * y; }
+
+  [[nodiscard]] std::size_t row(std::size_t c) const { return c / static_cast<std::size_t>(level.width); }
+
+  [[nodiscard]] std::uint64_t bit(std::size_t c) const
+  {
+    return std::uint64_t{ 1 } << (c % static_cast<std::size_t>(level.width));
+  }
+
+  [[nodiscard]] int exit_distance(int position) const
+  {
+    return std::abs(exit_cell % level.width - position % level.width)
+           + std::abs(exit_cell / level.width - position / level.width);
+  }
+
+  // whole steps that may still be taken, the game ends when energy reaches zero
+  [[nodiscard]] int step_limit() const { return level.steps + level.energy - 1; }
+
+  [[nodiscard]] int score(int roundness_reached, int steps) const
+  {
+    return (roundness_reached + level.level) * (config::player_energy - steps);
+  }
+
+  // summands and factor digits of the operations not consumed yet
+  struct Remaining
+  {
+    double summands = 0;
+    double factor_digits = 0;
+  };
+
+  [[nodiscard]] Remaining remaining(std::uint64_t consumed) const
+  {
+    Remaining result;
+    for (std::size_t op = 0; op < operations.size(); ++op) {
+      if ((consumed >> op & 1U) != 0) { continue; }
+      result.summands += summand[op];
+      result.factor_digits += factor_digits[op];
+    }
+    return result;
+  }
+
+  /*
+   * Upper bound of the score a state can still reach.
+   * A surface needs more than r digits to end in r zeros (zero itself counts as round once), and
+   * (|surface| + every remaining summand) * every remaining factor bounds its magnitude.
+   */
+  [[nodiscard]] int bound(const State &state, const Remaining &rest) const
+  {
+    const int steps = state.steps + exit_distance(state.position);
+    if (steps >= config::player_energy) { return score(1, steps); }
+
+    const double magnitude = std::abs(static_cast<double>(state.surface)) + rest.summands;
+    if (magnitude < 1) { return score(1, steps); }
+
+    static constexpr double rounding = 1e-9;
+    const auto digits = static_cast<int>(std::floor(std::log10(magnitude) + rest.factor_digits + rounding));
+    return score(std::clamp(digits, 1, max_roundness), steps);
+  }
+
+  // states that cannot beat the best exit found so far are dropped, unless winning ways are counted
+  [[nodiscard]] bool pruned(const State &state, const Remaining &rest) const
+  {
+    return win_limit == 0 && bound(state, rest) <= best_score.load();
+  }
+
+  // apply an operation to a copy, false if the game would overflow or divide by zero
+  [[nodiscard]] static bool apply(Field field, long &surface)
+  {
+    if (!field.fits(surface)) { return false; }
+    field.apply(surface);
+    return true;
+  }
+
+  void push(const State &state)
+  {
+    auto [it, inserted] = visited.try_emplace(Key{ state.consumed, state.surface, state.position }, state.steps);
+    if (!inserted) {
+      if (it->second <= state.steps) { return; }
+      it->second = state.steps;
+    }
+
+    const auto steps = static_cast<std::size_t>(state.steps);
+    if (steps >= buckets.size()) { buckets.resize(steps + 1); }
+    buckets[steps].push_back(states.size());
+    states.push_back(state);
+  }
+
+  // score leaving through the exit, then collect every operation worth entering next
+  void expand(std::size_t index, std::vector<State> &successors)
+  {
+    if (stopped()) { return; }
+    const State state = states[index];
+    if (visited.at(Key{ state.consumed, state.surface, state.position }) < state.steps) { return; }
+    const Remaining rest = remaining(state.consumed);
+    if (pruned(state, rest)) { return; }
+
+    Distances distance;
+    distances(state.consumed, state.position, distance);
+    leave(index, distance.at(operations.size()));
+
+    for (std::size_t op = 0; op < operations.size(); ++op) {
+      if (distance.at(op) == unreachable) { continue; }
+
+      State next{
+        state.consumed | std::uint64_t{ 1 } << op, state.surface, operations[op], state.steps + distance.at(op), index
+      };
+      if (next.steps > step_limit()) { continue; }
+      if (!apply(level.fields[static_cast<std::size_t>(next.position)], next.surface)) { continue; }
+      if (pruned(next, { rest.summands - summand[op], rest.factor_digits - factor_digits[op] })) { continue; }
+
+      successors.push_back(next);
+    }
+  }
+
+  void leave(std::size_t index, int distance)
+  {
+    const State &state = states[index];
+    if (distance == unreachable || state.steps + distance > step_limit()) { return; }
+
+    const int r = roundness(state.surface);
+    if (r == 0) { return; }
+    if (win_limit != 0) { wins.fetch_add(1, std::memory_order_relaxed); }
+
+    const int steps = state.steps + distance;
+    const int s = score(r, steps);
+    if (s <= best_score.load()) { return; }
+
+    std::lock_guard lock{ best_mutex };
+    if (s <= best_score.load()) { return; }
+    best_score = s;
+    best = { true, s, r, steps, state.surface, {} };
+    best_state = index;
+    if (control->improved) {
+      // the states leading here are complete, expansion only appends new ones after the parallel phase
+      best.path = directions(best_state);
+      control->improved(best);
+    }
+  }
+
+  /*
+   * Breadth first search on row masks: every layer grows the frontier by one step in all directions.
+   * Unconsumed operations and the exit are recorded when reached but never walked through.
+   */
+  void distances(std::uint64_t consumed, int from, Distances &result) const
+  {
+    result.fill(unreachable);
+
+    // only the first height rows are used, the rest stays untouched
+    const auto height = static_cast<std::size_t>(level.height);
+    const std::uint64_t row_mask =
+      level.width == max_side ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << level.width) - 1;
+
+    Rows walkable;// NOLINT(cppcoreguidelines-pro-type-member-init)
+    Rows seen;// NOLINT(cppcoreguidelines-pro-type-member-init)
+    std::array<Rows, 2> frontiers;// NOLINT(cppcoreguidelines-pro-type-member-init)
+    std::copy_n(empty_rows.begin(), height, walkable.begin());
+    std::fill_n(seen.begin(), height, 0);
+    std::fill_n(frontiers[0].begin(), height, 0);
+    for (std::size_t op = 0; op < operations.size(); ++op) {
+      if ((consumed >> op & 1U) != 0) {
+        const auto c = static_cast<std::size_t>(operations[op]);
+        walkable[row(c)] |= bit(c);
+      }
+    }
+
+    const auto start = static_cast<std::size_t>(from);
+    frontiers[0][row(start)] = bit(start);
+    seen[row(start)] = bit(start);
+
+    for (int steps = 1; true; ++steps) {
+      const Rows &frontier = frontiers[static_cast<std::size_t>(steps - 1) % 2];
+      Rows &next = frontiers[static_cast<std::size_t>(steps) % 2];
+      bool growing = false;
+      for (std::size_t y = 0; y < height; ++y) {
+        std::uint64_t reached = ((frontier[y] << 1U) | (frontier[y] >> 1U)) & row_mask;
+        if (y > 0) { reached |= frontier[y - 1]; }
+        if (y + 1 < height) { reached |= frontier[y + 1]; }
+        reached &= ~seen[y];
+        seen[y] |= reached;
+
+        // everything reached that cannot be walked on is an operation or the exit
+        for (std::uint64_t targets = reached & ~walkable[y]; targets != 0; targets &= targets - 1) {
+          const auto c =
+            y * static_cast<std::size_t>(level.width) + static_cast<std::size_t>(std::countr_zero(targets));
+          const int op = cell_operation[c];
+          result.at(op == no_operation ? operations.size() : static_cast<std::size_t>(op)) = steps;
+        }
+
+        next[y] = reached & walkable[y];
+        growing = growing || next[y] != 0;
+      }
+      if (!growing) { return; }
+    }
+  }
+
+  // breadth first search over walkable fields, calls visit(cell, previous) for every reached field
+  template<class Visit> void walk(std::uint64_t consumed, int from, Visit visit) const
+  {
+    const std::size_t cells = level.fields.size();
+    std::vector<int> previous(cells, unreachable);
+    std::vector<int> queue;
+    queue.reserve(cells);
+    queue.push_back(from);
+    previous[static_cast<std::size_t>(from)] = from;
+
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+      const int current = queue[head];
+      const int x = current % level.width;
+      const int y = current / level.width;
+
+      // unconsumed operations and the exit are entered but never walked through
+      if (current != from && !walkable(consumed, current)) { continue; }
+
+      for (const auto &[nx, ny] : std::array<std::pair<int, int>, 4>{
+             { { x, y + 1 }, { x - 1, y }, { x, y - 1 }, { x + 1, y } } }) {
+        if (nx < 0 || ny < 0 || nx >= level.width || ny >= level.height) { continue; }
+        const int next = cell(nx, ny);
+        if (previous[static_cast<std::size_t>(next)] != unreachable) { continue; }
+        previous[static_cast<std::size_t>(next)] = current;
+        queue.push_back(next);
+        visit(next, previous);
+      }
+    }
+  }
+
+  [[nodiscard]] bool walkable(std::uint64_t consumed, int c) const
+  {
+    const auto index = static_cast<std::size_t>(c);
+    if (level.fields[index].type == Field::Type::empty) { return true; }
+    const int op = cell_operation[index];
+    return op != no_operation && (consumed >> static_cast<unsigned>(op) & 1U) != 0;
+  }
+
+  // follow the states back to the start and turn them into single steps
+  [[nodiscard]] std::vector<Direction> directions(std::size_t last) const
+  {
+    std::vector<int> cells{ exit_cell };
+    for (std::size_t index = last; index != no_state; index = states[index].previous) {
+      cells.push_back(states[index].position);
+    }
+    std::reverse(cells.begin(), cells.end());
+
+    std::vector<Direction> result;
+    std::uint64_t consumed = 0;
+    for (std::size_t i = 1; i < cells.size(); ++i) {
+      const int from = cells[i - 1];
+      const int to = cells[i];
+      std::vector<int> trail;
+      walk(consumed, from, [&](int reached, const std::vector<int> &previous) {
+        if (reached != to) { return; }
+        for (int c = to; c != from; c = previous[static_cast<std::size_t>(c)]) { trail.push_back(c); }
+      });
+
+      int current = from;
+      for (auto it = trail.rbegin(); it != trail.rend(); ++it) {
+        const int delta = *it - current;
+        if (delta == level.width) {
+          result.push_back(Direction::up);
+        } else if (delta == -level.width) {
+          result.push_back(Direction::down);
+        } else if (delta == 1) {
+          result.push_back(Direction::right);
+        } else {
+          result.push_back(Direction::left);
+        }
+        current = *it;
+      }
+
+      const int op = cell_operation[static_cast<std::size_t>(to)];
+      if (op != no_operation) { consumed |= std::uint64_t{ 1 } << static_cast<unsigned>(op); }
+    }
+    return result;
+  }
+};
+
+template<class Grid, class Prng>
+  requires Grid::fixed_size
+[[nodiscard]] Solution solve(const BasicGameBoard<Grid, Prng> &board, ThreadPool *pool = nullptr)
+{
+  Solver solver{ Solver::capture(board) };
+  return solver.solve(pool);
+}
+
+struct OptimalScores
+{
+  // score holds the optimal score, moves the length of the optimal path
+  SimulationStats stats;
+  std::uint64_t unsolvable = 0;
+};
+
+/**
+ * @brief generates the given level for the seeds [first_seed, first_seed + levels) and solves each of them
+ *
+ * Levels are spread over the pool, every single level is solved sequentially.
+ */
+template<class Prng = std::ranlux24>
+OptimalScores solve_levels(ThreadPool &pool, std::uint64_t levels, std::uint64_t first_seed, int level)
+{
+  static constexpr std::uint64_t chunk_size = 64;
+  const std::uint64_t chunks = (levels + chunk_size - 1) / chunk_size;
+
+  std::vector<OptimalScores> results(chunks);
+  for (std::uint64_t chunk = 0; chunk < chunks; ++chunk) {
+    pool.submit([&, chunk] {
+      Player player;
+      Log log{ config::log_length };
+      Prng prng;
+      GameBoard<config::board_width, config::board_height, Prng> board{ prng, player, log };
+
+      OptimalScores &result = results[chunk];
+      const std::uint64_t end = std::min(levels, (chunk + 1) * chunk_size);
+      for (std::uint64_t seed = first_seed + chunk * chunk_size; seed < first_seed + end; ++seed) {
+        seed_prng(prng, seed);
+        player.reset();
+        board.level = level;
+        board.generate_level();
+
+        const Solution solution = solve(board);
+        if (!solution.solved) { ++result.unsolvable; }
+        result.stats.add({ solution.score, level, static_cast<int>(solution.path.size()) });
+      }
+    });
+  }
+  pool.wait();
+
+  OptimalScores total;
+  for (const auto &result : results) {
+    total.stats.merge(result.stats);
+    total.unsolvable += result.unsolvable;
+  }
+  return total;
+}
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_SOLVER_HPP
@@ -0,0 +1,476 @@
+#ifndef SMOOTHLIFE_SURFACE_HPP
+#define SMOOTHLIFE_SURFACE_HPP
+
+#include "roundness.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace smoothlife {
+
+namespace detail {
+
+#if defined(__SIZEOF_INT128__)
+  // __extension__ keeps -Wpedantic quiet about the non standard type
+  __extension__ using wide_int = __int128;
+  __extension__ using wide_uint = unsigned __int128;
+#else
+  // without __int128, msvc's 32 bit long still gets a wider type
+  using wide_int = long long;
+  using wide_uint = unsigned long long;
+#endif
+
+  // a + b, a - b and a * b, false instead of overflowing, result is unspecified then
+  template<class Int> constexpr bool checked_add(Int a, Int b, Int &result)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return !__builtin_add_overflow(a, b, &result);
+#else
+    if (b > 0 ? a > std::numeric_limits<Int>::max() - b : a < std::numeric_limits<Int>::min() - b) { return false; }
+    result = a + b;
+    return true;
+#endif
+  }
+
+  template<class Int> constexpr bool checked_sub(Int a, Int b, Int &result)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return !__builtin_sub_overflow(a, b, &result);
+#else
+    if (b > 0 ? a < std::numeric_limits<Int>::min() + b : a > std::numeric_limits<Int>::max() + b) { return false; }
+    result = a - b;
+    return true;
+#endif
+  }
+
+  template<class Int> constexpr bool checked_mul(Int a, Int b, Int &result)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return !__builtin_mul_overflow(a, b, &result);
+#else
+    constexpr Int max = std::numeric_limits<Int>::max();
+    constexpr Int min = std::numeric_limits<Int>::min();
+    if (a > 0 ? (b > 0 ? a > max / b : b < min / a) : (b > 0 ? a < min / b : a != 0 && b < max / a)) { return false; }
+    result = a * b;
+    return true;
+#endif
+  }
+
+  // |number| without overflowing on the smallest value
+  constexpr std::uint32_t magnitude_of(int number)
+  {
+    const auto bits = static_cast<std::uint32_t>(number);
+    return number < 0 ? 0U - bits : bits;
+  }
+
+  constexpr wide_uint magnitude_of(wide_int number)
+  {
+    const auto bits = static_cast<wide_uint>(number);
+    return number < 0 ? wide_uint{ 0 } - bits : bits;
+  }
+
+  /**
+   * @brief fixed width signed integer for the surfaces no builtin type holds
+   *
+   * Sign and magnitude, the magnitude in 32 bit digits with the lowest first. It only needs what the
+   * operation fields do, so every arithmetic takes a single digit operand and runs in one pass.
+   */
+  struct BigInt
+  {
+    static constexpr std::size_t digits = 64;
+
+    bool negative = false;
+    // digits in use, the ones above are zero
+    std::size_t used = 0;
+    std::array<std::uint32_t, digits> magnitude{};
+
+    bool operator==(const BigInt &) const = default;
+
+    [[nodiscard]] static BigInt from(wide_uint bits, bool negative)
+    {
+      BigInt result;
+      for (; bits != 0; bits >>= 32U) { result.magnitude[result.used++] = static_cast<std::uint32_t>(bits); }
+      result.negative = negative && result.used > 0;
+      return result;
+    }
+
+    // the magnitude if it has at most Bits bits
+    template<int Bits> [[nodiscard]] bool fits() const
+    {
+      if (used * 32 <= Bits) { return true; }
+      if ((used - 1) * 32 >= Bits) { return false; }
+      return magnitude[used - 1] >> (Bits - (used - 1) * 32) == 0;
+    }
+
+    [[nodiscard]] wide_uint low_bits() const
+    {
+      wide_uint bits = 0;
+      for (std::size_t i = std::min(used, sizeof(wide_uint) / 4); i-- > 0;) { bits = bits << 32U | magnitude[i]; }
+      return bits;
+    }
+
+    [[nodiscard]] bool is_zero() const { return used == 0; }
+
+    // magnitude += value
+    void add(std::uint32_t value)
+    {
+      std::uint64_t carry = value;
+      for (std::size_t i = 0; carry != 0; ++i) {
+        if (i == digits) { throw std::overflow_error("surface exceeds the widest representation"); }
+        carry += magnitude[i];
+        magnitude[i] = static_cast<std::uint32_t>(carry);
+        carry >>= 32U;
+        used = std::max(used, i + 1);
+      }
+    }
+
+    // magnitude -= value, the sign flips if value is larger
+    void sub(std::uint32_t value)
+    {
+      if (used <= 1 && magnitude[0] < value) {
+        magnitude[0] = value - magnitude[0];
+        used = 1;
+        negative = !negative;
+        return;
+      }
+      std::uint64_t borrow = value;
+      for (std::size_t i = 0; borrow != 0; ++i) {
+        const std::uint64_t digit = magnitude[i];
+        magnitude[i] = static_cast<std::uint32_t>(digit - borrow);
+        borrow = digit < borrow ? 1 : 0;
+      }
+      trim();
+    }
+
+    // magnitude *= value
+    void mul(std::uint32_t value)
+    {
+      std::uint64_t carry = 0;
+      for (std::size_t i = 0; i < used; ++i) {
+        carry += std::uint64_t{ magnitude[i] } * value;
+        magnitude[i] = static_cast<std::uint32_t>(carry);
+        carry >>= 32U;
+      }
+      if (carry != 0) {
+        if (used == digits) { throw std::overflow_error("surface exceeds the widest representation"); }
+        magnitude[used++] = static_cast<std::uint32_t>(carry);
+      }
+      trim();
+    }
+
+    // magnitude /= value truncating like the builtin division, returns the remainder
+    std::uint32_t div(std::uint32_t value)
+    {
+      std::uint64_t remainder = 0;
+      for (std::size_t i = used; i-- > 0;) {
+        const std::uint64_t current = remainder << 32U | magnitude[i];
+        magnitude[i] = static_cast<std::uint32_t>(current / value);
+        remainder = current % value;
+      }
+      trim();
+      return static_cast<std::uint32_t>(remainder);
+    }
+
+  private:
+    void trim()
+    {
+      while (used > 0 && magnitude[used - 1] == 0) { --used; }
+      if (used == 0) { negative = false; }
+    }
+  };
+
+  // a BigInt on the heap, so copying a surface that fits a builtin type moves a few bytes and not 260
+  class BoxedBigInt
+  {
+  public:
+    explicit BoxedBigInt(const BigInt &big) : number{ std::make_unique<BigInt>(big) } {}
+    BoxedBigInt(const BoxedBigInt &other) : number{ std::make_unique<BigInt>(*other.number) } {}
+    BoxedBigInt(BoxedBigInt &&) noexcept = default;
+    BoxedBigInt &operator=(const BoxedBigInt &other)
+    {
+      *number = *other.number;
+      return *this;
+    }
+    BoxedBigInt &operator=(BoxedBigInt &&) noexcept = default;
+    ~BoxedBigInt() = default;
+
+    bool operator==(const BoxedBigInt &other) const { return *number == *other.number; }
+
+    [[nodiscard]] const BigInt &get() const { return *number; }
+
+  private:
+    std::unique_ptr<BigInt> number;
+  };
+
+}// namespace detail
+
+/**
+ * @brief the number the player polishes, as wide as the operations make it
+ *
+ * Holds a long while the value fits. Every operation checks for overflow and only then moves on to __int128,
+ * long long where there is no __int128, and on to a 2048 bit integer. Results that fit a narrower
+ * representation move back, so normal play stays on the long and pays one overflow check per operation.
+ * Overflowing the widest representation throws std::overflow_error, that takes hundreds of multiplications.
+ */
+class Surface
+{
+public:
+  enum struct Representation : std::uint8_t { small, wide, big };
+
+  constexpr Surface() = default;
+
+  // NOLINTNEXTLINE(hicpp-explicit-conversions) every long is a surface
+  constexpr Surface(long number) : value{ number } {}
+
+  bool operator==(const Surface &) const = default;
+
+  [[nodiscard]] Representation representation() const { return static_cast<Representation>(value.index()); }
+
+  // the value as a long, throws std::overflow_error if it does not fit
+  [[nodiscard]] long to_long() const
+  {
+    if (const long *small = std::get_if<long>(&value)) { return *small; }
+    throw std::overflow_error("surface does not fit a long");
+  }
+
+  // digits in the given base, 2 to 16, the ones above 9 as lowercase letters
+  [[nodiscard]] std::string to_string(int base = 10) const
+  {
+    if (base < 2 || base > 16) { throw std::invalid_argument("surfaces are written in base 2 to 16"); }
+    const long *small = std::get_if<long>(&value);
+    if (small != nullptr && base == 10) { return std::to_string(*small); }
+    if (small != nullptr && *small == 0) { return "0"; }
+    detail::BigInt rest = to_big();
+    std::string digits = rest.negative ? "-" : "";
+    const std::size_t first = digits.size();
+    while (!rest.is_zero()) { digits.push_back("0123456789abcdef"[rest.div(static_cast<std::uint32_t>(base))]); }
+    std::reverse(digits.begin() + static_cast<std::ptrdiff_t>(first), digits.end());
+    return digits;
+  }
+
+  Surface &operator+=(int operand)
+  {
+    long *small = std::get_if<long>(&value);
+    long result = 0;
+    if (small != nullptr && detail::checked_add(*small, long{ operand }, result)) {
+      *small = result;
+    } else {
+      add_slow(operand);
+    }
+    return *this;
+  }
+
+  Surface &operator-=(int operand)
+  {
+    long *small = std::get_if<long>(&value);
+    long result = 0;
+    if (small != nullptr && detail::checked_sub(*small, long{ operand }, result)) {
+      *small = result;
+    } else {
+      sub_slow(operand);
+    }
+    return *this;
+  }
+
+  Surface &operator*=(int operand)
+  {
+    long *small = std::get_if<long>(&value);
+    long result = 0;
+    if (small != nullptr && detail::checked_mul(*small, long{ operand }, result)) {
+      *small = result;
+    } else {
+      mul_slow(operand);
+    }
+    return *this;
+  }
+
+  // truncates towards zero like the builtin division, throws std::domain_error on zero
+  Surface &operator/=(int operand)
+  {
+    if (operand == 0) { throw std::domain_error("surface divided by zero"); }
+    long *small = std::get_if<long>(&value);
+    // of all longs only the smallest divided by -1 overflows
+    if (small != nullptr && (operand != -1 || *small != std::numeric_limits<long>::min())) {
+      *small /= operand;
+    } else {
+      div_slow(operand);
+    }
+    return *this;
+  }
+
+  // a surface in any representation as sign and magnitude, the magnitude in 32 bit digits with the lowest first
+  struct Digits
+  {
+    bool negative = false;
+    std::vector<std::uint32_t> magnitude;
+  };
+
+  [[nodiscard]] Digits digits() const
+  {
+    const detail::BigInt big = to_big();
+    return { big.negative, { big.magnitude.begin(), big.magnitude.begin() + static_cast<std::ptrdiff_t>(big.used) } };
+  }
+
+  // in the narrowest representation holding it, throws std::overflow_error if even the widest does not
+  [[nodiscard]] static Surface from_digits(const Digits &digits)
+  {
+    std::size_t used = digits.magnitude.size();
+    while (used > 0 && digits.magnitude[used - 1] == 0) { --used; }
+    if (used > detail::BigInt::digits) { throw std::overflow_error("surface exceeds the widest representation"); }
+    detail::BigInt big;
+    std::copy_n(digits.magnitude.begin(), used, big.magnitude.begin());
+    big.used = used;
+    big.negative = digits.negative && used > 0;
+    Surface surface;
+    surface.store(big);
+    return surface;
+  }
+
+  // roundness in any base, each representation with its own kernel
+  template<int Base> [[nodiscard]] int roundness() const
+  {
+    if (const long *small = std::get_if<long>(&value)) { return smoothlife::roundness<Base>(*small); }
+    // zero is always a long, the loops end
+    int zeros = 0;
+    if (const auto *wide = std::get_if<detail::wide_int>(&value)) {
+      for (auto rest = detail::magnitude_of(*wide); rest % Base == 0; rest /= Base) { ++zeros; }
+      return zeros;
+    }
+    const detail::BigInt &big = std::get<detail::BoxedBigInt>(value).get();
+    if constexpr (std::has_single_bit(static_cast<unsigned>(Base))) {
+      // the zero bits below the lowest digit that is not zero
+      std::size_t i = 0;
+      while (big.magnitude[i] == 0) { ++i; }
+      const auto bits = static_cast<int>(i) * 32 + std::countr_zero(big.magnitude[i]);
+      return bits / std::countr_zero(static_cast<unsigned>(Base));
+    } else {
+      detail::BigInt rest = big;
+      while (rest.div(static_cast<std::uint32_t>(Base)) == 0) { ++zeros; }
+      return zeros;
+    }
+  }
+
+private:
+  std::variant<long, detail::wide_int, detail::BoxedBigInt> value;
+
+  [[nodiscard]] detail::BigInt to_big() const
+  {
+    if (const auto *big = std::get_if<detail::BoxedBigInt>(&value)) { return big->get(); }
+    const detail::wide_int number = to_wide();
+    return detail::BigInt::from(detail::magnitude_of(number), number < 0);
+  }
+
+  // only for the long and wide representation
+  [[nodiscard]] detail::wide_int to_wide() const
+  {
+    if (const long *small = std::get_if<long>(&value)) { return *small; }
+    return std::get<detail::wide_int>(value);
+  }
+
+  // tries the wide type first and only falls back to the bignum when it overflows too
+  template<class Wide, class Big> void slow(Wide &&wide_op, Big &&big_op)
+  {
+    if (!std::holds_alternative<detail::BoxedBigInt>(value)) {
+      detail::wide_int result = 0;
+      if (wide_op(to_wide(), result)) {
+        store(result);
+        return;
+      }
+    }
+    detail::BigInt big = to_big();
+    big_op(big);
+    store(big);
+  }
+
+  // the operations once the value left the long, kept out of the operators so those stay small enough to inline
+  void add_slow(int operand)
+  {
+    slow(
+      [&](detail::wide_int number, detail::wide_int &result) {
+        return detail::checked_add(number, detail::wide_int{ operand }, result);
+      },
+      [&](detail::BigInt &big) { add(big, operand < 0, detail::magnitude_of(operand)); });
+  }
+
+  void sub_slow(int operand)
+  {
+    slow(
+      [&](detail::wide_int number, detail::wide_int &result) {
+        return detail::checked_sub(number, detail::wide_int{ operand }, result);
+      },
+      [&](detail::BigInt &big) { add(big, operand > 0, detail::magnitude_of(operand)); });
+  }
+
+  void mul_slow(int operand)
+  {
+    slow(
+      [&](detail::wide_int number, detail::wide_int &result) {
+        return detail::checked_mul(number, detail::wide_int{ operand }, result);
+      },
+      [&](detail::BigInt &big) {
+        big.negative = big.negative != (operand < 0);
+        big.mul(detail::magnitude_of(operand));
+      });
+  }
+
+  void div_slow(int operand)
+  {
+    slow(
+      [&](detail::wide_int number, detail::wide_int &result) {
+        if (operand == -1 && number == std::numeric_limits<detail::wide_int>::min()) { return false; }
+        result = number / operand;
+        return true;
+      },
+      [&](detail::BigInt &big) {
+        big.negative = big.negative != (operand < 0);
+        big.div(detail::magnitude_of(operand));
+      });
+  }
+
+  // adds a number of the given sign and magnitude
+  static void add(detail::BigInt &big, bool negative, std::uint32_t magnitude)
+  {
+    if (big.negative == negative || big.is_zero()) {
+      big.negative = negative;
+      big.add(magnitude);
+    } else {
+      big.sub(magnitude);
+    }
+  }
+
+  // keeps the narrowest representation holding the number, equal surfaces compare equal that way
+  void store(detail::wide_int number)
+  {
+    if (number >= std::numeric_limits<long>::min() && number <= std::numeric_limits<long>::max()) {
+      value = static_cast<long>(number);
+    } else {
+      value = number;
+    }
+  }
+
+  void store(const detail::BigInt &big)
+  {
+    // the smallest wide value has one bit more, it is rare enough to stay a bignum
+    if (big.fits<std::numeric_limits<detail::wide_int>::digits>()) {
+      const auto number = static_cast<detail::wide_int>(big.low_bits());
+      store(big.negative ? -number : number);
+    } else {
+      value = detail::BoxedBigInt{ big };
+    }
+  }
+};
+
+template<int Base> [[nodiscard]] int roundness(const Surface &surface) { return surface.roundness<Base>(); }
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_SURFACE_HPP
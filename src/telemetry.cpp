@@ -0,0 +1,164 @@
+#include "field.hpp"
+#include "mapped_file.hpp"
+#include "telemetry.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <docopt/docopt.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <internal_use_only/config.hpp>
+
+namespace smoothlife {
+
+struct TelemetryScan
+{
+  TelemetrySummary summary;
+  std::uint64_t bytes = 0;
+  std::uint64_t blocks = 0;
+};
+
+/**
+ * @brief sums up every block of the files on the pool
+ *
+ * The files are mapped and their blocks found by hopping over the headers, then blocks are handed out in
+ * chunks. Each chunk only pages in the columns it decodes and sums into a summary of its own.
+ */
+TelemetryScan scan(ThreadPool &pool, const std::vector<std::filesystem::path> &files)
+{
+  static constexpr std::size_t chunk_size = 16;
+
+  std::vector<MappedFile> mapped;
+  std::vector<TelemetryBlock> blocks;
+  TelemetryScan total;
+  for (const auto &path : files) {
+    mapped.emplace_back(path);
+    const TelemetryView view = parse_telemetry(mapped.back().bytes());
+    if (view.truncated) { SPDLOG_WARN("{} ends inside a block, the block is left out", path.string()); }
+    blocks.insert(blocks.end(), view.blocks.begin(), view.blocks.end());
+    total.bytes += mapped.back().size();
+  }
+  total.blocks = blocks.size();
+
+  const std::size_t chunks = (blocks.size() + chunk_size - 1) / chunk_size;
+  std::vector<TelemetrySummary> summaries(chunks);
+  std::mutex errors_mutex;
+  std::vector<std::string> errors;
+  for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+    pool.submit([&, chunk] {
+      try {
+        const std::size_t end = std::min(blocks.size(), (chunk + 1) * chunk_size);
+        for (std::size_t i = chunk * chunk_size; i < end; ++i) { summaries[chunk].add(blocks[i]); }
+      } catch (const std::exception &e) {
+        const std::scoped_lock lock{ errors_mutex };
+        errors.emplace_back(e.what());
+      }
+    });
+  }
+  pool.wait();
+  if (!errors.empty()) { throw std::runtime_error(errors.front()); }
+
+  for (const auto &summary : summaries) { total.summary.merge(summary); }
+  return total;
+}
+
+void report(const TelemetryScan &scan, std::size_t files, std::size_t threads, double seconds)
+{
+  const TelemetrySummary &summary = scan.summary;
+  const auto per = [](auto part, auto whole) {
+    return static_cast<double>(part) / static_cast<double>(std::max<decltype(whole)>(whole, 1));
+  };
+
+  fmt::print("smoothlife_telemetry: {} files, {} sessions, {} levels, {} moves, {} threads\n",
+    files,
+    summary.sessions,
+    summary.levels,
+    summary.moves,
+    threads);
+  fmt::print("  time       {:>12.3f} s\n", seconds);
+  fmt::print("  scanned    {:>12.1f} MB in {} blocks, {:.1f} bytes per row\n",
+    static_cast<double>(scan.bytes) / 1e6,
+    scan.blocks,
+    per(scan.bytes, summary.sessions + summary.levels + summary.moves));
+  fmt::print("  rows/sec   {:>12.0f}\n",
+    static_cast<double>(summary.sessions + summary.levels + summary.moves) / seconds);
+  fmt::print("  score      {:>12.1f} mean per session\n", per(summary.score, summary.sessions));
+  fmt::print("  moves      {:>12.1f} mean per session\n", per(summary.session_moves, summary.sessions));
+
+  static constexpr std::array<std::string_view, 6> field_names{ "empty", "exit", "add", "sub", "mul", "div" };
+  fmt::print("  fields    ");
+  for (std::size_t type = 0; type < field_names.size(); ++type) {
+    fmt::print(" {} {:.1f} %", field_names.at(type), 100.0 * per(summary.fields.at(type), summary.moves));
+  }
+  fmt::print("\n");
+
+  fmt::print("  {:>6} {:>12} {:>8} {:>10} {:>8} {:>8} {:>10}\n",
+    "level",
+    "played",
+    "failed",
+    "roundness",
+    "steps",
+    "energy",
+    "score");
+  for (std::size_t number = 0; number < summary.per_level.size(); ++number) {
+    const TelemetrySummary::Level &level = summary.per_level[number];
+    if (level.played == 0) { continue; }
+    fmt::print("  {:>6} {:>12} {:>6.1f} % {:>10.2f} {:>8.1f} {:>8.1f} {:>10.1f}\n",
+      number,
+      level.played,
+      100.0 * per(level.failed, level.played),
+      per(level.roundness, level.played),
+      per(level.steps, level.played),
+      per(level.energy, level.played),
+      per(level.score, level.played));
+  }
+}
+
+}// namespace smoothlife
+
+int main(int argc, const char **argv)
+{
+  try {
+    static constexpr auto USAGE =
+      R"(
+    Usage:
+          smoothlife_telemetry <files>... [--threads=<t>]
+          smoothlife_telemetry --version
+          smoothlife_telemetry (-h | --help)
+    Options:
+          -h --help        Show this screen.
+          --version        Show version.
+          --threads=<t>    Worker threads, 0 uses every core [default: 0].
+    Files are written by smoothlife --telemetry or smoothlife_sim --telemetry.
+)";
+
+    auto args = docopt::docopt(USAGE,
+      { std::next(argv), std::next(argv, argc) },
+      true,
+      fmt::format("{} {}", smoothlife::cmake::project_name, smoothlife::cmake::project_version));
+
+    std::vector<std::filesystem::path> files;
+    for (const auto &file : args["<files>"].asStringList()) { files.emplace_back(file); }
+    smoothlife::ThreadPool pool{ static_cast<std::size_t>(args["--threads"].asLong()) };
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto scan = smoothlife::scan(pool, files);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    smoothlife::report(scan, files.size(), pool.size(), elapsed.count());
+    return 0;
+
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("Unhandled exception in main: {}", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,597 @@
+#ifndef SMOOTHLIFE_TELEMETRY_HPP
+#define SMOOTHLIFE_TELEMETRY_HPP
+
+#include "field.hpp"
+#include "gameboard.hpp"
+#include "lockfree_queue.hpp"
+#include "surface.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace smoothlife {
+
+/*
+ * Telemetry files log what happened in many sessions as three tables: one row per session, per level played
+ * and per move. A file is a header followed by blocks, each holding up to a few thousand rows of one table
+ * stored column by column. A column is the differences between neighbouring values as varints, level
+ * numbers, steps or energy shrink to a byte per row. Blocks are only ever appended, a session crashing in
+ * the middle of a write loses its last block and nothing before it.
+ */
+
+enum struct TelemetryTable : std::uint8_t { sessions = 0, levels = 1, moves = 2 };
+
+inline constexpr std::size_t telemetry_tables = 3;
+inline constexpr std::size_t max_telemetry_columns = 8;
+
+// the columns of every table in the order they are stored, all of them 64 bit integers
+struct SessionColumns
+{
+  enum : std::uint8_t { session, score, level, moves, count };
+  static constexpr std::array<std::string_view, count> names{ "session", "score", "level", "moves" };
+};
+
+struct LevelColumns
+{
+  enum : std::uint8_t { session, level, start_surface, roundness, steps, energy, lives, score, count };
+  static constexpr std::array<std::string_view, count> names{
+    "session", "level", "start_surface", "roundness", "steps", "energy", "lives", "score"
+  };
+};
+
+struct MoveColumns
+{
+  // field is the Field::Type entered, before and after the surface around applying it
+  enum : std::uint8_t { session, level, field, before, after, count };
+  static constexpr std::array<std::string_view, count> names{ "session", "level", "field", "before", "after" };
+};
+
+[[nodiscard]] constexpr std::size_t telemetry_columns(TelemetryTable table)
+{
+  switch (table) {
+  case TelemetryTable::sessions:
+    return SessionColumns::count;
+  case TelemetryTable::levels:
+    return LevelColumns::count;
+  case TelemetryTable::moves:
+    return MoveColumns::count;
+  }
+  return 0;
+}
+
+// a surface that outgrew a long is stored as this
+inline constexpr std::int64_t wide_surface = std::numeric_limits<std::int64_t>::min();
+
+[[nodiscard]] inline std::int64_t telemetry_surface(const Surface &surface)
+{
+  return surface.representation() == Surface::Representation::small ? surface.to_long() : wide_surface;
+}
+
+struct TelemetryRow
+{
+  TelemetryTable table = TelemetryTable::sessions;
+  // the first telemetry_columns(table) are used
+  std::array<std::int64_t, max_telemetry_columns> values{};
+};
+
+/**
+ * @brief file header of a telemetry file, followed by blocks
+ *
+ * Integers are little endian.
+ */
+struct TelemetryHeader
+{
+  static constexpr std::array<char, 8> signature{ 'S', 'M', 'L', 'T', 'E', 'L', 'E', 'M' };
+  static constexpr std::uint32_t current_version = 1;
+
+  std::array<char, 8> magic = signature;
+  std::uint32_t version = current_version;
+  std::uint32_t reserved = 0;
+};
+
+// header of a block, followed by the encoded size of each column as uint32 and then the columns
+struct TelemetryBlockHeader
+{
+  static constexpr std::array<char, 4> signature{ 'B', 'L', 'C', 'K' };
+
+  std::array<char, 4> magic = signature;
+  std::uint8_t table = 0;
+  std::uint8_t columns = 0;
+  std::uint16_t reserved = 0;
+  std::uint32_t rows = 0;
+  // everything following this header up to the next block
+  std::uint32_t bytes = 0;
+};
+
+static_assert(sizeof(TelemetryHeader) == 16 && sizeof(TelemetryBlockHeader) == 16);
+static_assert(std::is_trivially_copyable_v<TelemetryHeader> && std::is_trivially_copyable_v<TelemetryBlockHeader>);
+
+namespace detail {
+
+  // differences to the previous value, zigzagged so small negative ones stay short, as LEB128 varints
+  inline void encode_column(std::span<const std::int64_t> values, std::vector<std::uint8_t> &out)
+  {
+    std::uint64_t previous = 0;
+    for (const std::int64_t value : values) {
+      const auto current = static_cast<std::uint64_t>(value);
+      const std::uint64_t delta = current - previous;
+      std::uint64_t zigzag = (delta << 1U) ^ (0 - (delta >> 63U));
+      while (zigzag >= 0x80U) {
+        out.push_back(static_cast<std::uint8_t>(zigzag | 0x80U));
+        zigzag >>= 7U;
+      }
+      out.push_back(static_cast<std::uint8_t>(zigzag));
+      previous = current;
+    }
+  }
+
+  // throws std::runtime_error unless the bytes hold exactly rows values
+  inline void decode_column(std::span<const std::uint8_t> bytes, std::size_t rows, std::vector<std::int64_t> &values)
+  {
+    // every value takes at least a byte, checked before a corrupt count can allocate
+    if (rows > bytes.size()) { throw std::runtime_error("corrupt telemetry column"); }
+    values.resize(rows);
+    std::uint64_t previous = 0;
+    std::size_t at = 0;
+    for (std::size_t row = 0; row < rows; ++row) {
+      std::uint64_t zigzag = 0;
+      for (unsigned shift = 0;; shift += 7) {
+        if (at == bytes.size() || shift > 63) { throw std::runtime_error("corrupt telemetry column"); }
+        const std::uint8_t byte = bytes[at++];
+        zigzag |= std::uint64_t{ byte & 0x7FU } << shift;
+        if ((byte & 0x80U) == 0) { break; }
+      }
+      previous += (zigzag >> 1U) ^ (0 - (zigzag & 1U));
+      values[row] = static_cast<std::int64_t>(previous);
+    }
+    if (at != bytes.size()) { throw std::runtime_error("corrupt telemetry column"); }
+  }
+
+}// namespace detail
+
+/**
+ * @brief appends rows to a telemetry file from a thread of its own
+ *
+ * record() hands a row to the writer over a lock-free queue, the thread recording never touches the file
+ * and only waits if the queue is full. The writer collects rows per table and appends a block whenever one
+ * is full or nothing was recorded for a moment, so an idle game has everything on disk. If writing fails
+ * the rows are dropped from then on and finish() reports the error.
+ */
+class TelemetryWriter
+{
+public:
+  static constexpr std::size_t default_block_rows = 4096;
+
+  // appends to the file, which is created if it does not exist
+  explicit TelemetryWriter(const std::filesystem::path &path,
+    std::size_t block_rows = default_block_rows,
+    std::size_t queue_capacity = std::size_t{ 1 } << 16U)
+    : rows_per_block{ block_rows }, queue{ queue_capacity }
+  {
+    if (block_rows == 0 || block_rows > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::invalid_argument("invalid telemetry block size");
+    }
+
+    std::error_code status;
+    const bool empty = !std::filesystem::exists(path, status) || std::filesystem::file_size(path, status) == 0;
+    if (!empty) {
+      std::ifstream in{ path, std::ios::binary };
+      TelemetryHeader header;
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      in.read(reinterpret_cast<char *>(&header), sizeof(header));
+      if (!in || header.magic != TelemetryHeader::signature) {
+        throw std::runtime_error(path.string() + " is not a telemetry file");
+      }
+      if (header.version != TelemetryHeader::current_version) {
+        throw std::runtime_error(fmt::format("unsupported telemetry version {}", header.version));
+      }
+      // a block cut off by a crash would end up in front of the ones appended now
+      const std::uintmax_t size = std::filesystem::file_size(path);
+      const std::uintmax_t complete = complete_blocks(in, size);
+      in.close();
+      if (complete != size) { std::filesystem::resize_file(path, complete); }
+    }
+
+    out.open(path, std::ios::binary | std::ios::app);
+    if (!out) { throw std::runtime_error("cannot open " + path.string()); }
+    if (empty) {
+      const TelemetryHeader header;
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+    worker = std::jthread{ [this](const std::stop_token &stop) { work(stop); } };
+  }
+
+  TelemetryWriter(const TelemetryWriter &) = delete;
+  TelemetryWriter(TelemetryWriter &&) = delete;
+  TelemetryWriter &operator=(const TelemetryWriter &) = delete;
+  TelemetryWriter &operator=(TelemetryWriter &&) = delete;
+
+  // writes what was recorded, errors are lost, call finish() to see them
+  ~TelemetryWriter() = default;
+
+  // safe to call from any number of threads
+  void record(const TelemetryRow &row)
+  {
+    while (!queue.try_push(row)) {
+      if (failed.load(std::memory_order_relaxed)) { return; }
+      std::this_thread::yield();
+    }
+  }
+
+  // writes every row recorded so far and stops the writer, throws std::runtime_error if writing failed
+  void finish()
+  {
+    if (worker.joinable()) {
+      worker.request_stop();
+      worker.join();
+    }
+    if (error) { std::rethrow_exception(error); }
+  }
+
+  // rows in the blocks written so far
+  [[nodiscard]] std::uint64_t written() const { return rows_written.load(std::memory_order_relaxed); }
+
+private:
+  // how long the writer sleeps once it caught up, finish() wakes it right away
+  static constexpr auto idle_wait = std::chrono::milliseconds{ 20 };
+
+  // the size of the file up to the end of its last complete block, reading only the block headers
+  static std::uintmax_t complete_blocks(std::ifstream &in, std::uintmax_t size)
+  {
+    std::uintmax_t at = sizeof(TelemetryHeader);
+    while (size - at >= sizeof(TelemetryBlockHeader)) {
+      TelemetryBlockHeader header;
+      in.seekg(static_cast<std::streamoff>(at));
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      in.read(reinterpret_cast<char *>(&header), sizeof(header));
+      if (!in || header.magic != TelemetryBlockHeader::signature) {
+        throw std::runtime_error("corrupt telemetry block");
+      }
+      if (size - at - sizeof(header) < header.bytes) { break; }
+      at += sizeof(header) + header.bytes;
+    }
+    return at;
+  }
+
+  void work(const std::stop_token &stop)
+  {
+    trace::name_thread("telemetry");
+    std::mutex mutex;
+    std::condition_variable_any wake;
+    try {
+      while (true) {
+        // read before draining, every row recorded before finish() is drained then
+        const bool stopping = stop.stop_requested();
+        bool drained = false;
+        while (const auto row = queue.try_pop()) {
+          add(*row);
+          drained = true;
+        }
+        if (drained) { continue; }
+
+        write_pending();
+        if (stopping) { return; }
+        std::unique_lock lock{ mutex };
+        wake.wait_for(lock, stop, idle_wait, [] { return false; });
+      }
+    } catch (const std::exception &) {
+      error = std::current_exception();
+      failed.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  void add(const TelemetryRow &row)
+  {
+    const auto table = static_cast<std::size_t>(row.table);
+    auto &columns = pending.at(table);
+    for (std::size_t column = 0; column < telemetry_columns(row.table); ++column) {
+      columns[column].push_back(row.values[column]);
+    }
+    if (columns[0].size() == rows_per_block) { write_block(row.table); }
+  }
+
+  void write_pending()
+  {
+    bool wrote = false;
+    for (std::size_t table = 0; table < telemetry_tables; ++table) {
+      if (!pending[table][0].empty()) {
+        write_block(static_cast<TelemetryTable>(table));
+        wrote = true;
+      }
+    }
+    if (wrote && !out.flush()) { throw std::runtime_error("cannot write telemetry"); }
+  }
+
+  // the whole block goes out in one write, a crash can only cut off its end
+  void write_block(TelemetryTable table)
+  {
+    const trace::Span span{ "telemetry block" };
+    auto &columns = pending.at(static_cast<std::size_t>(table));
+    const std::size_t count = telemetry_columns(table);
+
+    TelemetryBlockHeader header;
+    header.table = static_cast<std::uint8_t>(table);
+    header.columns = static_cast<std::uint8_t>(count);
+    header.rows = static_cast<std::uint32_t>(columns[0].size());
+
+    block.assign(sizeof(header) + count * sizeof(std::uint32_t), 0);
+    for (std::size_t column = 0; column < count; ++column) {
+      const std::size_t start = block.size();
+      detail::encode_column(columns[column], block);
+      const auto size = static_cast<std::uint32_t>(block.size() - start);
+      std::memcpy(block.data() + sizeof(header) + column * sizeof(size), &size, sizeof(size));
+      columns[column].clear();
+    }
+    header.bytes = static_cast<std::uint32_t>(block.size() - sizeof(header));
+    std::memcpy(block.data(), &header, sizeof(header));
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    out.write(reinterpret_cast<const char *>(block.data()), static_cast<std::streamsize>(block.size()));
+    if (!out) { throw std::runtime_error("cannot write telemetry"); }
+    rows_written.fetch_add(header.rows, std::memory_order_relaxed);
+  }
+
+  std::size_t rows_per_block;
+  LockFreeQueue<TelemetryRow> queue;
+  std::atomic<bool> failed = false;
+  std::atomic<std::uint64_t> rows_written = 0;
+  std::exception_ptr error;
+
+  // only used by the writer
+  std::ofstream out;
+  std::array<std::array<std::vector<std::int64_t>, max_telemetry_columns>, telemetry_tables> pending;
+  std::vector<std::uint8_t> block;
+
+  // drains the queue into blocks of the file, declared last so that it is joined, writing the rows still
+  // queued, while the queue and the file are open
+  std::jthread worker;
+};
+
+/**
+ * @brief records the games of one board into a TelemetryWriter
+ *
+ * Takes over the events of the board, which must not outlive this. The rows carry the id given to begin(),
+ * the seed of the game for example.
+ */
+class TelemetrySession
+{
+public:
+  template<class Board> TelemetrySession(TelemetryWriter &telemetry, Board &board) : writer{ &telemetry }
+  {
+    board.events.level_started = [this](int, const Surface &surface) { start_surface = telemetry_surface(surface); };
+    board.events.moved = [this, &board](Field::Type type, const Surface &before) {
+      writer->record({ TelemetryTable::moves,
+        { id, board.level, static_cast<std::int64_t>(type), telemetry_surface(before),
+          telemetry_surface(board.player.surface) } });
+    };
+    board.events.level_finished = [this, &board](int level, int roundness, int score) {
+      const Player &player = board.player;
+      writer->record({ TelemetryTable::levels,
+        { id, level, start_surface, roundness, player.steps, player.energy, player.lives, score } });
+    };
+  }
+
+  // the hooks point to this object
+  TelemetrySession(const TelemetrySession &) = delete;
+  TelemetrySession(TelemetrySession &&) = delete;
+  TelemetrySession &operator=(const TelemetrySession &) = delete;
+  TelemetrySession &operator=(TelemetrySession &&) = delete;
+  ~TelemetrySession() = default;
+
+  // before the first level of a game is set up
+  void begin(std::uint64_t session) { id = static_cast<std::int64_t>(session); }
+
+  // the row of the session with what the game reached
+  void end(int score, int level, int moves)
+  {
+    writer->record({ TelemetryTable::sessions, { id, score, level, moves } });
+  }
+
+private:
+  TelemetryWriter *writer;
+  std::int64_t id = 0;
+  std::int64_t start_surface = 0;
+};
+
+// a block as it lies in a mapped file, the columns point into its bytes
+struct TelemetryBlock
+{
+  TelemetryTable table = TelemetryTable::sessions;
+  std::size_t rows = 0;
+  std::array<std::span<const std::uint8_t>, max_telemetry_columns> columns{};
+
+  // reads only the bytes of that column
+  void decode(std::size_t column, std::vector<std::int64_t> &values) const
+  {
+    detail::decode_column(columns.at(column), rows, values);
+  }
+};
+
+struct TelemetryView
+{
+  std::vector<TelemetryBlock> blocks;
+  // the file ends inside a block, which is left out
+  bool truncated = false;
+};
+
+// finds the blocks by hopping from header to header, no column is decoded
+inline TelemetryView parse_telemetry(std::span<const std::byte> bytes)
+{
+  TelemetryHeader header;
+  if (bytes.size() < sizeof(header)) { throw std::runtime_error("not a telemetry file"); }
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  if (header.magic != TelemetryHeader::signature) { throw std::runtime_error("not a telemetry file"); }
+  if (header.version != TelemetryHeader::current_version) {
+    throw std::runtime_error(fmt::format("unsupported telemetry version {}", header.version));
+  }
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto *data = reinterpret_cast<const std::uint8_t *>(bytes.data());
+  TelemetryView view;
+  std::size_t at = sizeof(header);
+  while (at < bytes.size()) {
+    TelemetryBlockHeader block_header;
+    if (bytes.size() - at < sizeof(block_header)) {
+      view.truncated = true;
+      break;
+    }
+    std::memcpy(&block_header, data + at, sizeof(block_header));
+    at += sizeof(block_header);
+    if (block_header.magic != TelemetryBlockHeader::signature || block_header.table >= telemetry_tables
+        || block_header.columns != telemetry_columns(static_cast<TelemetryTable>(block_header.table))) {
+      throw std::runtime_error("corrupt telemetry block");
+    }
+    if (bytes.size() - at < block_header.bytes) {
+      view.truncated = true;
+      break;
+    }
+
+    TelemetryBlock block;
+    block.table = static_cast<TelemetryTable>(block_header.table);
+    block.rows = block_header.rows;
+    std::size_t column_at = block_header.columns * sizeof(std::uint32_t);
+    if (column_at > block_header.bytes) { throw std::runtime_error("corrupt telemetry block"); }
+    for (std::size_t column = 0; column < block_header.columns; ++column) {
+      std::uint32_t size = 0;
+      std::memcpy(&size, data + at + column * sizeof(size), sizeof(size));
+      if (size > block_header.bytes - column_at) { throw std::runtime_error("corrupt telemetry block"); }
+      block.columns[column] = { data + at + column_at, size };
+      column_at += size;
+    }
+    if (column_at != block_header.bytes) { throw std::runtime_error("corrupt telemetry block"); }
+    view.blocks.push_back(block);
+    at += block_header.bytes;
+  }
+  return view;
+}
+
+/**
+ * @brief aggregates of the sessions, levels and moves of telemetry files
+ *
+ * Each table only decodes the columns it counts, the ids of sessions are never read.
+ */
+struct TelemetrySummary
+{
+  struct Level
+  {
+    std::uint64_t played = 0;
+    std::uint64_t failed = 0;
+    std::uint64_t roundness = 0;
+    std::uint64_t steps = 0;
+    std::int64_t energy = 0;
+    std::int64_t score = 0;
+  };
+
+  std::uint64_t sessions = 0;
+  std::uint64_t levels = 0;
+  std::uint64_t moves = 0;
+  std::int64_t score = 0;
+  std::int64_t session_moves = 0;
+  // indexed by the level number
+  std::vector<Level> per_level;
+  // moves onto each Field::Type
+  std::array<std::uint64_t, 6> fields{};
+
+  void add(const TelemetryBlock &block)
+  {
+    switch (block.table) {
+    case TelemetryTable::sessions:
+      sessions += block.rows;
+      block.decode(SessionColumns::score, column(0));
+      block.decode(SessionColumns::moves, column(1));
+      for (std::size_t row = 0; row < block.rows; ++row) {
+        score += column(0)[row];
+        session_moves += column(1)[row];
+      }
+      break;
+    case TelemetryTable::levels:
+      add_levels(block);
+      break;
+    case TelemetryTable::moves:
+      moves += block.rows;
+      block.decode(MoveColumns::field, column(0));
+      for (const std::int64_t type : column(0)) {
+        if (type >= 0 && static_cast<std::size_t>(type) < fields.size()) { ++fields[static_cast<std::size_t>(type)]; }
+      }
+      break;
+    }
+  }
+
+  void merge(const TelemetrySummary &other)
+  {
+    sessions += other.sessions;
+    levels += other.levels;
+    moves += other.moves;
+    score += other.score;
+    session_moves += other.session_moves;
+    if (other.per_level.size() > per_level.size()) { per_level.resize(other.per_level.size()); }
+    for (std::size_t i = 0; i < other.per_level.size(); ++i) {
+      Level &level = per_level[i];
+      const Level &other_level = other.per_level[i];
+      level.played += other_level.played;
+      level.failed += other_level.failed;
+      level.roundness += other_level.roundness;
+      level.steps += other_level.steps;
+      level.energy += other_level.energy;
+      level.score += other_level.score;
+    }
+    for (std::size_t i = 0; i < fields.size(); ++i) { fields[i] += other.fields[i]; }
+  }
+
+private:
+  // levels beyond are counted in the totals only, a corrupt file cannot make the table huge
+  static constexpr std::int64_t max_level = 10000;
+
+  void add_levels(const TelemetryBlock &block)
+  {
+    levels += block.rows;
+    block.decode(LevelColumns::level, column(0));
+    block.decode(LevelColumns::roundness, column(1));
+    block.decode(LevelColumns::steps, column(2));
+    block.decode(LevelColumns::energy, column(3));
+    block.decode(LevelColumns::score, column(4));
+    for (std::size_t row = 0; row < block.rows; ++row) {
+      const std::int64_t number = column(0)[row];
+      if (number < 0 || number >= max_level) { continue; }
+      const auto index = static_cast<std::size_t>(number);
+      if (index >= per_level.size()) { per_level.resize(index + 1); }
+      Level &level = per_level[index];
+      ++level.played;
+      if (column(1)[row] == 0) { ++level.failed; }
+      level.roundness += static_cast<std::uint64_t>(std::max<std::int64_t>(column(1)[row], 0));
+      level.steps += static_cast<std::uint64_t>(std::max<std::int64_t>(column(2)[row], 0));
+      level.energy += column(3)[row];
+      level.score += column(4)[row];
+    }
+  }
+
+  std::vector<std::int64_t> &column(std::size_t index) { return scratch.at(index); }
+
+  // decoded columns, kept to reuse their memory
+  std::array<std::vector<std::int64_t>, 5> scratch;
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_TELEMETRY_HPP
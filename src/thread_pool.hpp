@@ -0,0 +1,176 @@
+#ifndef SMOOTHLIFE_THREAD_POOL_HPP
+#define SMOOTHLIFE_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace smoothlife {
+
+/**
+ * @brief work-stealing thread pool
+ *
+ * Every worker owns a task queue. Workers pop their newest task first and steal the oldest task of
+ * another worker once their own queue runs dry, so uneven batches still keep all cores busy.
+ */
+class ThreadPool
+{
+public:
+  using Task = std::function<void()>;
+
+  explicit ThreadPool(std::size_t threads = 0)
+  {
+    if (threads == 0) { threads = std::max<std::size_t>(1, std::thread::hardware_concurrency()); }
+
+    queues.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) { queues.push_back(std::make_unique<Queue>()); }
+
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+      workers.emplace_back([this, i](const std::stop_token &stop) { work(i, stop); });
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool(ThreadPool &&) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  ThreadPool &operator=(ThreadPool &&) = delete;
+
+  ~ThreadPool()
+  {
+    for (auto &worker : workers) { worker.request_stop(); }
+    {
+      std::lock_guard lock{ sleep_mutex };
+      sleeping.notify_all();
+    }
+  }
+
+  [[nodiscard]] std::size_t size() const { return queues.size(); }
+
+  // index of the calling worker, or size() when called from outside the pool
+  [[nodiscard]] std::size_t worker_index() const { return current_pool == this ? current_index : size(); }
+
+  void submit(Task task)
+  {
+    // tasks spawned by a worker stay local, others are spread round robin
+    std::size_t index = worker_index();
+    if (index == size()) { index = next_queue.fetch_add(1, std::memory_order_relaxed) % size(); }
+
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+      std::lock_guard lock{ queues[index]->mutex };
+      queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+      std::lock_guard lock{ sleep_mutex };
+      ++generation;
+    }
+    sleeping.notify_one();
+  }
+
+  // block until every submitted task has finished, rethrows the first exception a task threw since the last wait
+  void wait()
+  {
+    std::unique_lock lock{ sleep_mutex };
+    finished.wait(lock, [this] { return pending.load(std::memory_order_acquire) == 0; });
+    if (failure) { std::rethrow_exception(std::exchange(failure, nullptr)); }
+  }
+
+private:
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::optional<Task> pop(std::size_t index)
+  {
+    // own queue: newest first
+    {
+      Queue &own = *queues[index];
+      std::lock_guard lock{ own.mutex };
+      if (!own.tasks.empty()) {
+        Task task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+        return task;
+      }
+    }
+
+    // steal: oldest first, starting with the right neighbour
+    for (std::size_t offset = 1; offset < size(); ++offset) {
+      Queue &victim = *queues[(index + offset) % size()];
+      std::lock_guard lock{ victim.mutex };
+      if (!victim.tasks.empty()) {
+        Task task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return task;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  void work(std::size_t index, const std::stop_token &stop)
+  {
+    current_pool = this;
+    current_index = index;
+
+    while (!stop.stop_requested()) {
+      std::size_t seen = 0;
+      {
+        std::lock_guard lock{ sleep_mutex };
+        seen = generation;
+      }
+
+      if (auto task = pop(index)) {
+        try {
+          (*task)();
+        } catch (...) {
+          // the worker goes on with the next task, the first failure is kept for wait()
+          std::lock_guard lock{ sleep_mutex };
+          if (!failure) { failure = std::current_exception(); }
+        }
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          std::lock_guard lock{ sleep_mutex };
+          finished.notify_all();
+        }
+        continue;
+      }
+
+      // nothing to run or steal, sleep until new work arrives
+      std::unique_lock lock{ sleep_mutex };
+      sleeping.wait(lock, [&] { return generation != seen || stop.stop_requested(); });
+    }
+  }
+
+  static inline thread_local const ThreadPool *current_pool = nullptr;
+  static inline thread_local std::size_t current_index = 0;
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::atomic<std::size_t> next_queue = 0;
+  std::atomic<std::size_t> pending = 0;
+
+  std::mutex sleep_mutex;
+  std::condition_variable sleeping;
+  std::condition_variable finished;
+  std::size_t generation = 0;
+  std::exception_ptr failure;
+
+  // declared last, members are destroyed in reverse order: the workers are joined before the queues they take
+  // tasks from and the condition variables they sleep on are gone
+  std::vector<std::jthread> workers;
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_THREAD_POOL_HPP
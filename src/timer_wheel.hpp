@@ -0,0 +1,103 @@
+#ifndef SMOOTHLIFE_TIMER_WHEEL_HPP
+#define SMOOTHLIFE_TIMER_WHEEL_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace smoothlife {
+
+/**
+ * @brief timers of any number of sessions on one thread, hashed into the slots of a wheel
+ *
+ * Time is counted in ticks of the resolution and a timer goes into the slot of the tick it is due at,
+ * modulo the number of slots. Scheduling is a push onto a slot and advancing only looks at the slots of the
+ * ticks that passed, so thousands of timers cost nothing while they wait, unlike a sleeping thread each.
+ * Timers fire at most one resolution late and never early. There is no cancel: the id should tell the
+ * callback whether the timer still matters, e.g. by a generation that is counted up when its session ends.
+ */
+template<class Id> class TimerWheel
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  TimerWheel(Clock::duration tick_length, std::size_t slot_count, Clock::time_point start = Clock::now())
+    : resolution{ tick_length }, slots(slot_count), origin{ start }
+  {
+    if (resolution <= Clock::duration::zero() || slot_count == 0) {
+      throw std::invalid_argument("a timer wheel needs a resolution and slots");
+    }
+  }
+
+  // fires once delay after the last advance(), at the earliest
+  void schedule(Id id, Clock::duration delay)
+  {
+    const Clock::rep ticks = (delay + resolution - Clock::duration{ 1 }) / resolution;
+    const std::uint64_t due = now_tick + static_cast<std::uint64_t>(std::max<Clock::rep>(ticks, 1));
+    slots[due % slots.size()].push_back({ due, std::move(id) });
+    ++count;
+  }
+
+  // calls fire(id) for every timer due by now, tick by tick: a timer that fire schedules again counts from the tick
+  // it was due at, so a periodic timer that fell behind catches up
+  template<class Fire> std::size_t advance(Clock::time_point now, Fire &&fire)
+  {
+    const auto target = static_cast<std::uint64_t>(std::max<Clock::rep>((now - origin) / resolution, 0));
+    std::size_t fired = 0;
+    while (now_tick < target && count > 0) {
+      ++now_tick;
+      std::vector<Entry> &slot = slots[now_tick % slots.size()];
+      if (slot.empty()) { continue; }
+      // timers scheduled by fire go into a slot of a later tick, never into this one
+      std::swap(slot, firing);
+      for (auto &entry : firing) {
+        if (entry.due <= now_tick) {
+          --count;
+          ++fired;
+          fire(std::move(entry.id));
+        } else {
+          slots[entry.due % slots.size()].push_back(std::move(entry));
+        }
+      }
+      firing.clear();
+    }
+    now_tick = std::max(now_tick, target);
+    return fired;
+  }
+
+  // how long a thread can wait before the next timer is due, far from exact for timers more than a lap away
+  [[nodiscard]] Clock::duration until_next(Clock::time_point now) const
+  {
+    if (count == 0) { return Clock::duration::max(); }
+    for (std::uint64_t tick = now_tick + 1; tick <= now_tick + slots.size(); ++tick) {
+      if (!slots[tick % slots.size()].empty()) {
+        return std::max(origin + static_cast<Clock::rep>(tick) * resolution - now, Clock::duration::zero());
+      }
+    }
+    return Clock::duration::zero();
+  }
+
+  [[nodiscard]] std::size_t size() const { return count; }
+
+private:
+  struct Entry
+  {
+    std::uint64_t due;
+    Id id;
+  };
+
+  Clock::duration resolution;
+  std::vector<std::vector<Entry>> slots;
+  std::vector<Entry> firing;
+  Clock::time_point origin;
+  std::uint64_t now_tick = 0;
+  std::size_t count = 0;
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_TIMER_WHEEL_HPP
@@ -0,0 +1,206 @@
+#ifndef SMOOTHLIFE_TRACE_HPP
+#define SMOOTHLIFE_TRACE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace smoothlife::trace {
+
+/*
+ * Spans of a session in the Chrome trace format, to be opened in chrome://tracing or ui.perfetto.dev.
+ *
+ * Every thread appends its spans to a buffer of its own, nothing is shared while recording: a chunk of the
+ * buffer is filled and its count published with a release store, write() reads the counts and the spans
+ * below them. While tracing is off a span costs the load of a flag and a branch that is never taken.
+ */
+
+namespace detail {
+
+  struct Event
+  {
+    // a string literal, names are never copied
+    const char *name;
+    std::int64_t start;
+    std::int64_t end;
+  };
+
+  struct Chunk
+  {
+    static constexpr std::size_t capacity = 4096;
+
+    // only the first count are written, a new chunk is not zeroed
+    std::array<Event, capacity> events;
+    std::atomic<std::size_t> count = 0;
+    std::unique_ptr<Chunk> next_owner;
+    std::atomic<Chunk *> next = nullptr;
+  };
+
+  // the spans of one thread, kept after the thread ended until the process exits
+  struct ThreadBuffer
+  {
+    std::size_t id = 0;
+    std::atomic<const char *> name = nullptr;
+    Chunk first;
+    // only used by the owning thread
+    Chunk *last = &first;
+
+    void add(const Event &event)
+    {
+      std::size_t count = last->count.load(std::memory_order_relaxed);
+      if (count == Chunk::capacity) {
+        last->next_owner = std::make_unique_for_overwrite<Chunk>();
+        last->next.store(last->next_owner.get(), std::memory_order_release);
+        last = last->next_owner.get();
+        count = 0;
+      }
+      last->events[count] = event;
+      last->count.store(count + 1, std::memory_order_release);
+    }
+  };
+
+  struct Registry
+  {
+    std::atomic<bool> enabled = false;
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads;
+  };
+
+  inline Registry registry;
+
+  // registers the calling thread the first time it records, the only time a lock is taken
+  inline ThreadBuffer &local_buffer()
+  {
+    static thread_local ThreadBuffer *buffer = nullptr;
+    if (buffer == nullptr) {
+      const std::scoped_lock lock{ registry.mutex };
+      registry.threads.push_back(std::make_unique<ThreadBuffer>());
+      buffer = registry.threads.back().get();
+      buffer->id = registry.threads.size();
+    }
+    return *buffer;
+  }
+
+  inline std::int64_t now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - registry.epoch)
+      .count();
+  }
+
+}// namespace detail
+
+[[nodiscard]] inline bool enabled() { return detail::registry.enabled.load(std::memory_order_relaxed); }
+
+// starts recording spans of every thread
+inline void start() { detail::registry.enabled.store(true, std::memory_order_relaxed); }
+
+// stops recording, the spans so far are kept for write()
+inline void stop() { detail::registry.enabled.store(false, std::memory_order_relaxed); }
+
+// the name the calling thread is shown with, a string literal
+inline void name_thread(const char *name)
+{
+  if (enabled()) { detail::local_buffer().name.store(name, std::memory_order_relaxed); }
+}
+
+/**
+ * @brief measures the time until the end of its scope
+ *
+ * The name has to be a string literal. Spans of a thread nest like the scopes they measure.
+ */
+class Span
+{
+public:
+  explicit Span(const char *span_name)
+  {
+    if (enabled()) [[unlikely]] {
+      name = span_name;
+      start = detail::now();
+    }
+  }
+
+  Span(const Span &) = delete;
+  Span(Span &&) = delete;
+  Span &operator=(const Span &) = delete;
+  Span &operator=(Span &&) = delete;
+
+  ~Span()
+  {
+    if (name != nullptr) [[unlikely]] { detail::local_buffer().add({ name, start, detail::now() }); }
+  }
+
+private:
+  const char *name = nullptr;
+  std::int64_t start = 0;
+};
+
+// spans recorded so far by all threads
+[[nodiscard]] inline std::size_t recorded()
+{
+  const std::scoped_lock lock{ detail::registry.mutex };
+  std::size_t total = 0;
+  for (const auto &thread : detail::registry.threads) {
+    for (const detail::Chunk *chunk = &thread->first; chunk != nullptr;
+         chunk = chunk->next.load(std::memory_order_acquire)) {
+      total += chunk->count.load(std::memory_order_acquire);
+    }
+  }
+  return total;
+}
+
+/**
+ * @brief writes every span recorded so far as a Chrome trace
+ *
+ * Threads may keep recording meanwhile, their spans published before are written, later ones are not.
+ */
+inline void write(const std::filesystem::path &path)
+{
+  std::ofstream out{ path, std::ios::trunc };
+  if (!out) { throw std::runtime_error("cannot open " + path.string()); }
+
+  const std::scoped_lock lock{ detail::registry.mutex };
+  out << R"({"displayTimeUnit":"ms","traceEvents":[)";
+  const char *separator = "\n";
+  for (const auto &thread : detail::registry.threads) {
+    if (const char *name = thread->name.load(std::memory_order_relaxed); name != nullptr) {
+      out << separator
+          << fmt::format(
+               R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})", thread->id, name);
+      separator = ",\n";
+    }
+    for (const detail::Chunk *chunk = &thread->first; chunk != nullptr;
+         chunk = chunk->next.load(std::memory_order_acquire)) {
+      const std::size_t count = chunk->count.load(std::memory_order_acquire);
+      for (std::size_t i = 0; i < count; ++i) {
+        // microseconds, the unit of the format
+        const detail::Event &event = chunk->events[i];
+        out << separator
+            << fmt::format(R"({{"name":"{}","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+                 event.name,
+                 thread->id,
+                 static_cast<double>(event.start) / 1e3,
+                 static_cast<double>(event.end - event.start) / 1e3);
+        separator = ",\n";
+      }
+    }
+  }
+  out << "\n]}\n";
+  if (!out.flush()) { throw std::runtime_error("cannot write " + path.string()); }
+}
+
+}// namespace smoothlife::trace
+
+#endif// SMOOTHLIFE_TRACE_HPP
@@ -0,0 +1,369 @@
+#ifndef SMOOTHLIFE_UI_HPP
+#define SMOOTHLIFE_UI_HPP
+
+#include "config.hpp"
+#include "field.hpp"
+#include "gameboard.hpp"
+#include "hints.hpp"
+#include "log.hpp"
+#include "player.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/component/screen_interactive.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <ftxui/dom/node.hpp>
+#include <ftxui/screen/screen.hpp>
+
+namespace smoothlife {
+
+// ftxui frontend of the headless game core
+
+[[nodiscard]] inline ftxui::Element render(const Log &log)
+{
+  using enum ftxui::Color::Palette16;
+  using enum Log::Type;
+
+  ftxui::Elements events;
+  std::array<ftxui::Color, 3> shades{ White, GrayLight, GrayDark };
+
+  for (std::size_t i = 0; i < log.size(); ++i) {
+    ftxui::Decorator color = ftxui::color(shades.at(std::min(i, shades.size() - 1)));
+    if (i == 0 && log[i].type() == amazing) {
+      color = ftxui::color(GreenLight);
+    } else if (i == 0 && log[i].type() == good) {
+      color = ftxui::color(BlueLight);
+    } else if (i == 0 && log[i].type() == bad) {
+      color = ftxui::color(RedLight);
+    }
+    events.push_back(ftxui::paragraph(log[i].text()) | color);
+  }
+
+  return ftxui::vbox(std::move(events)) | ftxui::border | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, config::panel_width)
+         | ftxui::size(ftxui::HEIGHT, ftxui::EQUAL, config::panel_height);
+}
+
+// the suggested move as the arrow of its button, dimmed while the search is still improving it
+[[nodiscard]] inline ftxui::Element render(const Hint &hint)
+{
+  using enum ftxui::Color::Palette16;
+  static constexpr std::array<const char *, 4> arrows{ "ᐃ", "ᐊ", "ᐁ", "ᐅ" };
+
+  switch (hint.status) {
+  case Hint::Status::searching:
+    return ftxui::text(" hint: …") | ftxui::color(GrayDark);
+  case Hint::Status::improving:
+    return ftxui::text(fmt::format(" hint: {} …", arrows.at(hint.move))) | ftxui::color(GrayLight);
+  case Hint::Status::optimal:
+    return ftxui::text(fmt::format(" hint: {}", arrows.at(hint.move))) | ftxui::color(Cyan);
+  case Hint::Status::none:
+    break;
+  }
+  return ftxui::text(" hint: none") | ftxui::color(GrayDark);
+}
+
+// one cell of the board, the player is drawn on top of the field
+[[nodiscard]] inline ftxui::Element render(const Field &field, bool player)
+{
+  using enum ftxui::Color::Palette16;
+  using enum Field::Type;
+
+  // labels of all field values, formatted once, as digits of the largest base
+  static const auto labels = [] {
+    std::array<std::string, config::bases.back()> result;
+    for (std::size_t value = 0; value < result.size(); ++value) { result[value] = fmt::format(" {:x} ", value); }
+    return result;
+  }();
+
+  std::string repr = "   ";
+  ftxui::Color color = White;
+
+  if (field.type != empty && field.type != exit) {
+    repr = field.value >= 0 && static_cast<std::size_t>(field.value) < labels.size()
+             ? labels[static_cast<std::size_t>(field.value)]
+             : fmt::format(" {} ", field.value);
+    switch (field.type) {
+    case add:
+      color = RedLight;
+      break;
+    case sub:
+      color = BlueLight;
+      break;
+    case mul:
+      color = GreenLight;
+      break;
+    case div:
+      color = YellowLight;
+      break;
+    default:
+      break;
+    }
+  } else if (field.type == exit) {
+    repr = " ⋒ ";
+  }
+  if (player) { repr = " 🯅 "; }
+  return ftxui::text(std::move(repr)) | ftxui::border | ftxui::color(color);
+}
+
+// builds every cell of the whole board anew, BoardView reuses the unchanged ones and clips to a viewport
+template<class Grid, class Prng, int Base>
+[[nodiscard]] ftxui::Element render(const BasicGameBoard<Grid, Prng, Base> &board)
+{
+  ftxui::Elements rows;
+
+  for (int y = static_cast<int>(board.height()) - 1; y >= 0; --y) {
+    ftxui::Elements row;
+
+    for (int x = 0; x < static_cast<int>(board.width()); ++x) {
+      row.push_back(render(board.get_field(x, y), x == board.player.x && y == board.player.y));
+    }
+    rows.push_back(ftxui::hbox(std::move(row)));
+  }
+
+  return ftxui::vbox(std::move(rows));
+}
+
+// the part of a board that is shown, in board coordinates
+struct Viewport
+{
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+};
+
+/**
+ * @brief board renderer that keeps the elements of the previous frame
+ *
+ * Shows at most width x height cells and scrolls along when the player comes close to an edge, boards of any
+ * size cost the same per frame. A cell is rebuilt only if its field or the player marker on it changed, rows
+ * without a rebuilt cell and the board itself are reused as they are. After a move that is two cells, a frame
+ * caused by anything else, like the energy timer, builds nothing.
+ */
+class BoardView
+{
+public:
+  // cells kept between the player and the edge of the viewport while scrolling
+  static constexpr int scroll_margin = 2;
+
+  BoardView(std::size_t width, std::size_t height)
+    : max_width{ static_cast<int>(width) }, max_height{ static_cast<int>(height) }
+  {}
+
+  template<class Grid, class Prng, int Base>
+  [[nodiscard]] ftxui::Element render(const BasicGameBoard<Grid, Prng, Base> &board)
+  {
+    follow(board);
+    bool board_changed = !element;
+
+    for (int y = 0; y < visible.height; ++y) {
+      auto &row_element = rows[static_cast<std::size_t>(y)];
+      bool row_changed = !row_element;
+      for (int x = 0; x < visible.width; ++x) {
+        const int board_x = visible.x + x;
+        const int board_y = visible.y + y;
+        const Field &field = board.get_field(board_x, board_y);
+        const bool player = board_x == board.player.x && board_y == board.player.y;
+
+        // a cell shows nothing but the field and the marker, after scrolling most of them stay the same
+        Cell &cell = cells[slot(x, y)];
+        if (cell.element && cell.field == field && cell.player == player) { continue; }
+        cell = { field, player, smoothlife::render(field, player) };
+        ++rebuilt;
+        row_changed = true;
+      }
+
+      if (row_changed) {
+        ftxui::Elements row;
+        row.reserve(static_cast<std::size_t>(visible.width));
+        for (int x = 0; x < visible.width; ++x) { row.push_back(cells[slot(x, y)].element); }
+        row_element = ftxui::hbox(std::move(row));
+        board_changed = true;
+      }
+    }
+
+    if (board_changed) {
+      // the first row is drawn at the bottom
+      element = ftxui::vbox(ftxui::Elements(rows.rbegin(), rows.rend()));
+    }
+    return element;
+  }
+
+  // the part of the board shown by the last frame
+  [[nodiscard]] const Viewport &viewport() const { return visible; }
+
+  // cells built since the view was created
+  [[nodiscard]] std::size_t rebuilt_cells() const { return rebuilt; }
+
+private:
+  struct Cell
+  {
+    Field field;
+    bool player = false;
+    ftxui::Element element;
+  };
+
+  int max_width;
+  int max_height;
+  Viewport visible;
+  std::vector<Cell> cells;
+  std::vector<ftxui::Element> rows;
+  ftxui::Element element;
+  std::size_t rebuilt = 0;
+
+  [[nodiscard]] std::size_t slot(int x, int y) const
+  {
+    return static_cast<std::size_t>(x) + static_cast<std::size_t>(visible.width) * static_cast<std::size_t>(y);
+  }
+
+  // moves the viewport so the player stays visible, starts over when the board size changed
+  template<class Board> void follow(const Board &board)
+  {
+    const int width = std::min(max_width, static_cast<int>(board.width()));
+    const int height = std::min(max_height, static_cast<int>(board.height()));
+    if (width != visible.width || height != visible.height) {
+      visible = { 0, 0, width, height };
+      cells.assign(static_cast<std::size_t>(width) * static_cast<std::size_t>(height), {});
+      rows.assign(static_cast<std::size_t>(height), nullptr);
+      element = nullptr;
+    }
+
+    const auto scroll = [](int origin, int size, int position, int limit) {
+      const int margin = std::min(scroll_margin, (size - 1) / 2);
+      origin = std::min(origin, position - margin);
+      origin = std::max(origin, position + margin - size + 1);
+      return std::clamp(origin, 0, limit - size);
+    };
+    visible.x = scroll(visible.x, width, board.player.x, static_cast<int>(board.width()));
+    visible.y = scroll(visible.y, height, board.player.y, static_cast<int>(board.height()));
+  }
+};
+
+// an element rebuilt only when the state it shows, the key, changed
+template<class Key> class CachedElement
+{
+public:
+  template<class Build> [[nodiscard]] ftxui::Element get(const Key &current, Build &&build)
+  {
+    if (!element || current != key) {
+      key = current;
+      element = std::forward<Build>(build)();
+    }
+    return element;
+  }
+
+private:
+  Key key{};
+  ftxui::Element element;
+};
+
+// lays out and draws its child like ftxui would, measuring both
+class TracedNode : public ftxui::Node
+{
+public:
+  explicit TracedNode(ftxui::Element child) : ftxui::Node{ ftxui::Elements{ std::move(child) } } {}
+
+  void ComputeRequirement() override
+  {
+    const trace::Span span{ "layout" };
+    ftxui::Node::ComputeRequirement();
+    requirement_ = children_[0]->requirement();
+  }
+
+  void SetBox(ftxui::Box box) override
+  {
+    ftxui::Node::SetBox(box);
+    children_[0]->SetBox(box);
+  }
+
+  void Render(ftxui::Screen &screen) override
+  {
+    const trace::Span span{ "draw" };
+    ftxui::Node::Render(screen);
+  }
+};
+
+// the element with the time ftxui spends on it traced, unchanged while tracing is off
+[[nodiscard]] inline ftxui::Element traced(ftxui::Element element)
+{
+  if (!trace::enabled()) { return element; }
+  return std::make_shared<TracedNode>(std::move(element));
+}
+
+// arrow buttons moving the player
+struct PlayerControls
+{
+  std::function<void(Direction)> move;
+  // called for the u and r keys, if set
+  std::function<void()> undo;
+  std::function<void()> redo;
+  ftxui::Components buttons;
+  ftxui::Component move_ui;
+
+  // every button press calls move with its direction
+  explicit PlayerControls(std::function<void(Direction)> move_player) : move{ std::move(move_player) }
+  {
+    buttons.push_back(ftxui::Button(" ᐃ ", [this] { move(Direction::up); }));
+    buttons.push_back(ftxui::Button(" ᐊ ", [this] { move(Direction::left); }));
+    buttons.push_back(ftxui::Button(" ᐁ ", [this] { move(Direction::down); }));
+    buttons.push_back(ftxui::Button(" ᐅ ", [this] { move(Direction::right); }));
+
+    move_ui = ftxui::Container::Vertical({
+      ftxui::Renderer(buttons[0],
+        [&] {
+          return ftxui::hbox({
+            ftxui::filler(),
+            buttons[0]->Render(),
+            ftxui::filler(),
+          });
+        }),
+      ftxui::Container::Horizontal({
+        buttons[1],
+        buttons[2],
+        buttons[3],
+      }),
+    });
+
+    // use arrow keys as hotkeys for movement, u and r for undo and redo
+    move_ui = ftxui::CatchEvent(move_ui, [&](const ftxui::Event &event) {
+      const trace::Span span{ "input" };
+      if (event == ftxui::Event::ArrowUp) {
+        buttons[0]->TakeFocus();
+        buttons[0]->OnEvent(ftxui::Event::Return);
+        return true;
+      } else if (event == ftxui::Event::ArrowLeft) {
+        buttons[1]->TakeFocus();
+        buttons[1]->OnEvent(ftxui::Event::Return);
+        return true;
+      } else if (event == ftxui::Event::ArrowDown) {
+        buttons[2]->TakeFocus();
+        buttons[2]->OnEvent(ftxui::Event::Return);
+        return true;
+      } else if (event == ftxui::Event::ArrowRight) {
+        buttons[3]->TakeFocus();
+        buttons[3]->OnEvent(ftxui::Event::Return);
+        return true;
+      } else if (event == ftxui::Event::Character('u') && undo) {
+        undo();
+        return true;
+      } else if (event == ftxui::Event::Character('r') && redo) {
+        redo();
+        return true;
+      }
+      return false;
+    });
+  }
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_UI_HPP
@@ -2,6 +2,14 @@
 #define SMOOTHLIFE_UTIL_HPP
 
 #include "config.hpp"
+#include "roundness.hpp"
+#include "surface.hpp"
+
+#include <array>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 
 namespace smoothlife {
 
@@ -16,27 +24,45 @@ namespace smoothlife {
  *  roundness(100) -> 2
  *  roundness(318) -> 0
  *  roundness(20)  -> 1
+ *  roundness(0)   -> 1
  *
  * @param number integer to determine the roundness of.
  * @return int
  */
-int roundness(long number)
+constexpr int roundness(long number) { return roundness<config::base>(number); }
+
+// roundness(long) for surfaces of any width, a long one costs the same
+inline int roundness(const Surface &surface) { return roundness<config::base>(surface); }
+
+// batch version of roundness(long), see roundness<Base>(std::span<const long>, std::span<int>)
+constexpr void roundness(std::span<const long> numbers, std::span<int> result)
 {
-  if (number == 0) { return 1; }
-
-  int roundness = 0;
-  int places = config::base;
-
-  while (true) {
-    if (number % places == 0) {
-      ++roundness;
-    } else {
-      break;
-    }
-    places *= config::base;
-  }
+  roundness<config::base>(numbers, result);
+}
 
-  return roundness;
+/**
+ * @brief calls visit(std::integral_constant<int, base>{}) for one of config::bases
+ *
+ * The base is looked at once, everything visit runs is compiled for that base and no rule pays for a
+ * runtime modulus. Throws std::invalid_argument for any other base.
+ */
+template<class Visit> decltype(auto) with_base(int base, Visit &&visit)
+{
+  static_assert(config::bases == std::array{ 2, 8, 10, 12, 16 }, "with_base needs a case for every base");
+  switch (base) {
+  case 2:
+    return visit(std::integral_constant<int, 2>{});
+  case 8:
+    return visit(std::integral_constant<int, 8>{});
+  case 10:
+    return visit(std::integral_constant<int, 10>{});
+  case 12:
+    return visit(std::integral_constant<int, 12>{});
+  case 16:
+    return visit(std::integral_constant<int, 16>{});
+  default:
+    throw std::invalid_argument("unsupported base " + std::to_string(base));
+  }
 }
 
 }// namespace smoothlife
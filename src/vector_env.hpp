@@ -0,0 +1,283 @@
+#ifndef SMOOTHLIFE_VECTOR_ENV_HPP
+#define SMOOTHLIFE_VECTOR_ENV_HPP
+
+#include "config.hpp"
+#include "field.hpp"
+#include "packed_grid.hpp"
+#include "player.hpp"
+#include "random.hpp"
+#include "roundness.hpp"
+#include "rules.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace smoothlife {
+
+struct EnvOptions
+{
+  // game i of n plays the seeds first_seed + i, first_seed + i + n, ... one after the other
+  std::uint64_t first_seed = 1;
+  // lose one energy every n steps to stand in for the energy thread, 0 disables it
+  int tick_every = 0;
+  // a game is cut off after this many steps
+  int max_moves = 100000;
+};
+
+enum struct EnvStatus : std::uint8_t {
+  running = 0,
+  // out of lives or energy
+  game_over = 1,
+  // cut off by max_moves, or the surface would leave the long the environments play on
+  truncated = 2
+};
+
+/**
+ * @brief many independent games of the board stepped at once, for training move policies
+ *
+ * The state of every game lives in arrays of its own, one entry per game (structure of arrays), the boards
+ * are PackedGrids. A step moves every player, applies the field it enters like BasicGameBoard does, scores
+ * exits and starts the next game of a finished one right away, without a Player, its std::function or a
+ * Log in the way. The levels are those of a GameBoard with the same engine and seed.
+ *
+ * Unlike the board the surface stays a long: a move that would leave it ends the game as truncated.
+ * step() allocates nothing, its results are views of buffers the environment keeps until the next step.
+ */
+template<std::size_t Width = config::board_width,
+  std::size_t Height = config::board_height,
+  class Prng = Xoshiro256,
+  int Base = config::base>
+class VectorEnv
+{
+public:
+  using Grid = PackedGrid<Width, Height>;
+  static constexpr std::size_t cells = Width * Height;
+  static constexpr int base = Base;
+
+  explicit VectorEnv(std::size_t count, EnvOptions opts = {})
+    : options{ opts }, xs(count), ys(count), surface_values(count), energies(count), life_counts(count),
+      score_values(count), level_values(count), level_steps(count), moves(count), episodes(count),
+      seed_values(count), engines(count), boards(count), observation_bytes(count * cells), reward_values(count),
+      statuses(count)
+  {
+    if (count == 0) { throw std::invalid_argument("an environment needs at least one game"); }
+    if (options.tick_every < 0 || options.max_moves <= 0) { throw std::invalid_argument("invalid env options"); }
+    for (std::size_t i = 0; i < count; ++i) {
+      reset(i);
+      observe(i);
+    }
+  }
+
+  [[nodiscard]] std::size_t size() const { return xs.size(); }
+
+  /**
+   * @brief moves player i in direction actions[i], for every game
+   *
+   * A move into a wall or without energy does nothing but count as a step. A finished game reports its last
+   * reward and status and is replaced by the next game of its seeds, the observation is already the new one.
+   * With a pool the games are split into one chunk per worker.
+   *
+   * @param actions a Direction per game, as its number.
+   */
+  void step(std::span<const std::uint8_t> actions, ThreadPool *pool = nullptr)
+  {
+    if (actions.size() != size()) { throw std::invalid_argument("step needs one action per game"); }
+    const auto invalid = [](std::uint8_t a) { return a > static_cast<std::uint8_t>(Direction::right); };
+    if (std::any_of(actions.begin(), actions.end(), invalid)) { throw std::out_of_range("unknown action"); }
+
+    if (pool == nullptr || pool->size() == 1) {
+      step_range(actions.data(), 0, size());
+      return;
+    }
+    // a chunk captures two words, small enough for std::function to keep it without allocating
+    pending_actions = actions.data();
+    pending_chunk = (size() + pool->size() - 1) / pool->size();
+    for (std::size_t begin = 0; begin < size(); begin += pending_chunk) {
+      pool->submit([this, begin] { step_range(pending_actions, begin, std::min(size(), begin + pending_chunk)); });
+    }
+    pool->wait();
+  }
+
+  // the fields of game i in observations()[i * cells, (i + 1) * cells), row by row, type * 16 + value
+  [[nodiscard]] std::span<const std::uint8_t> observations() const { return observation_bytes; }
+
+  // score gained by the last step
+  [[nodiscard]] std::span<const float> rewards() const { return reward_values; }
+
+  [[nodiscard]] std::span<const EnvStatus> dones() const { return statuses; }
+
+  [[nodiscard]] std::span<const std::int32_t> x() const { return xs; }
+
+  [[nodiscard]] std::span<const std::int32_t> y() const { return ys; }
+
+  [[nodiscard]] std::span<const long> surfaces() const { return surface_values; }
+
+  [[nodiscard]] std::span<const std::int32_t> energy() const { return energies; }
+
+  [[nodiscard]] std::span<const std::int32_t> lives() const { return life_counts; }
+
+  [[nodiscard]] std::span<const std::int32_t> scores() const { return score_values; }
+
+  [[nodiscard]] std::span<const std::int32_t> levels() const { return level_values; }
+
+  // steps taken in the running level
+  [[nodiscard]] std::span<const std::int32_t> steps() const { return level_steps; }
+
+  // seed of the running game
+  [[nodiscard]] std::span<const std::uint64_t> seeds() const { return seed_values; }
+
+  [[nodiscard]] const Grid &board(std::size_t i) const { return boards[i]; }
+
+private:
+  EnvOptions options;
+
+  std::vector<std::int32_t> xs;
+  std::vector<std::int32_t> ys;
+  std::vector<long> surface_values;
+  std::vector<std::int32_t> energies;
+  std::vector<std::int32_t> life_counts;
+  std::vector<std::int32_t> score_values;
+  std::vector<std::int32_t> level_values;
+  std::vector<std::int32_t> level_steps;
+  std::vector<std::int32_t> moves;
+  std::vector<std::uint64_t> episodes;
+  std::vector<std::uint64_t> seed_values;
+  std::vector<Prng> engines;
+  std::vector<Grid> boards;
+
+  std::vector<std::uint8_t> observation_bytes;
+  std::vector<float> reward_values;
+  std::vector<EnvStatus> statuses;
+
+  // the step the workers are on
+  const std::uint8_t *pending_actions = nullptr;
+  std::size_t pending_chunk = 0;
+
+  void step_range(const std::uint8_t *actions, std::size_t begin, std::size_t end)
+  {
+    for (std::size_t i = begin; i < end; ++i) {
+      reward_values[i] = 0.0F;
+      statuses[i] = advance(i, static_cast<Direction>(actions[i]));
+      if (statuses[i] != EnvStatus::running) { reset(i); }
+      observe(i);
+    }
+  }
+
+  // one step of game i, the interaction of BasicGameBoard on the arrays
+  EnvStatus advance(std::size_t i, Direction dir)
+  {
+    EnvStatus status = move(i, dir);
+    if (status == EnvStatus::running && options.tick_every > 0 && moves[i] % options.tick_every == 0) {
+      energies[i] -= 1;
+      if (energies[i] <= 0) { status = EnvStatus::game_over; }
+    }
+    if (status == EnvStatus::running && moves[i] >= options.max_moves) { status = EnvStatus::truncated; }
+    return status;
+  }
+
+  EnvStatus move(std::size_t i, Direction dir)
+  {
+    ++moves[i];
+    int x = xs[i];
+    int y = ys[i];
+    switch (dir) {
+    case Direction::up:
+      ++y;
+      break;
+    case Direction::left:
+      --x;
+      break;
+    case Direction::down:
+      --y;
+      break;
+    case Direction::right:
+      ++x;
+      break;
+    }
+    if (energies[i] <= 0 || x < 0 || y < 0 || x >= static_cast<int>(Width) || y >= static_cast<int>(Height)) {
+      return EnvStatus::running;
+    }
+    xs[i] = x;
+    ys[i] = y;
+    // the last energy is spent on the way, the field is never entered
+    if (--energies[i] == 0) { return EnvStatus::game_over; }
+
+    const std::size_t cell = Grid::index(x, y);
+    Field field = boards[i][cell];
+    ++level_steps[i];
+    if (field.type == Field::Type::empty) { return EnvStatus::running; }
+    if (field.type == Field::Type::exit) { return leave(i); }
+
+    if (!field.fits(surface_values[i])) { return EnvStatus::truncated; }
+    field.template apply<Base>(surface_values[i]);
+    boards[i].set(x, y, field);
+    return EnvStatus::running;
+  }
+
+  EnvStatus leave(std::size_t i)
+  {
+    const int r = roundness<Base>(surface_values[i]);
+    if (r == 0) {
+      --life_counts[i];
+    } else {
+      const int score = rules::exit_score(r, level_values[i], level_steps[i]);
+      energies[i] += rules::energy_gain(r);
+      score_values[i] += score;
+      reward_values[i] = static_cast<float>(score);
+      ++level_values[i];
+    }
+    if (life_counts[i] == 0) { return EnvStatus::game_over; }
+    level_steps[i] = 0;
+    // a failed level is replaced by a fresh one of the same level
+    generate_level(i);
+    return EnvStatus::running;
+  }
+
+  // the next game of the seeds of game i, like a fresh Player on a board at level 0
+  void reset(std::size_t i)
+  {
+    seed_values[i] = options.first_seed + i + episodes[i]++ * size();
+    seed_prng(engines[i], seed_values[i]);
+    score_values[i] = 0;
+    level_steps[i] = 0;
+    energies[i] = config::player_energy;
+    life_counts[i] = config::player_lives;
+    level_values[i] = 0;
+    moves[i] = 0;
+    generate_level(i);
+  }
+
+  void generate_level(std::size_t i)
+  {
+    Prng &prng = engines[i];
+    // the draws of BasicGameBoard, so the levels are the ones of a board with the same engine
+    surface_values[i] = rules::generate_level<Base>(boards[i], level_values[i], [&prng](auto lo, auto hi) {
+      return std::uniform_int_distribution<decltype(lo)>{ lo, hi }(prng);
+    });
+    xs[i] = 0;
+    ys[i] = 0;
+  }
+
+  void observe(std::size_t i)
+  {
+    std::uint8_t *out = observation_bytes.data() + i * cells;
+    if constexpr (std::endian::native == std::endian::little) {
+      // byte j of the words is cell j already
+      std::memcpy(out, boards[i].words.data(), cells);
+    } else {
+      for (std::size_t cell = 0; cell < cells; ++cell) { out[cell] = boards[i].byte(cell); }
+    }
+  }
+};
+
+}// namespace smoothlife
+
+#endif// SMOOTHLIFE_VECTOR_ENV_HPP
@@ -1,14 +1,156 @@
 #include <catch2/catch.hpp>
 
-constexpr unsigned int Factorial(unsigned int number)// NOLINT(misc-no-recursion)
+#include <builtin_levels.hpp>
+#include <field.hpp>
+#include <grid.hpp>
+#include <log.hpp>
+#include <packed_grid.hpp>
+#include <random.hpp>
+#include <rules.hpp>
+#include <util.hpp>
+
+#include <limits>
+
+TEST_CASE("Roundness is computed with constexpr", "[roundness]")
+{
+  STATIC_REQUIRE(smoothlife::roundness(100) == 2);
+  STATIC_REQUIRE(smoothlife::roundness(318) == 0);
+  STATIC_REQUIRE(smoothlife::roundness(-20) == 1);
+  STATIC_REQUIRE(smoothlife::roundness(0) == 1);
+  STATIC_REQUIRE(smoothlife::roundness(1'000'000'000) == 9);
+  STATIC_REQUIRE(smoothlife::roundness<2>(96) == 5);
+  STATIC_REQUIRE(smoothlife::roundness<12>(288) == 2);
+  STATIC_REQUIRE(smoothlife::roundness<8>(-512) == 3);
+  STATIC_REQUIRE(smoothlife::roundness<16>(0x1200) == 2);
+  STATIC_REQUIRE(smoothlife::roundness<16>(0) == 1);
+  STATIC_REQUIRE(smoothlife::max_roundness<10> == std::numeric_limits<long>::digits10);
+}
+
+TEST_CASE("Fields are applied with constexpr", "[field]")
+{
+  using smoothlife::Field;
+  STATIC_REQUIRE(Field{ Field::Type::add, 3 }.inverse() == Field{ Field::Type::sub, 3 });
+  STATIC_REQUIRE(Field{ Field::Type::div, 4 }.inverse().inverse() == Field{ Field::Type::div, 4 });
+  STATIC_REQUIRE(Field{ Field::Type::exit }.inverse() == Field{});
+  STATIC_REQUIRE_FALSE(Field{ Field::Type::div, 0 }.fits(10));
+  STATIC_REQUIRE_FALSE(Field{ Field::Type::mul, 2 }.fits(std::numeric_limits<long>::max()));
+  STATIC_REQUIRE(Field{ Field::Type::mul, -2 }.fits(std::numeric_limits<long>::max() / 2));
+
+  struct Applied
+  {
+    long surface;
+    Field field;
+    std::size_t events;
+    smoothlife::Log::Message last;
+  };
+  // an applied field is used up and the log tells how much rounder the surface got
+  constexpr auto applied = [] {
+    long surface = 95;
+    Field field{ Field::Type::add, 5 };
+    smoothlife::Log log{ smoothlife::config::log_length };
+    field.apply(surface, &log);
+    return Applied{ surface, field, log.size(), log[0].message };
+  }();
+  STATIC_REQUIRE(applied.surface == 100);
+  STATIC_REQUIRE(applied.field == Field{});
+  STATIC_REQUIRE(applied.events == 2);
+  STATIC_REQUIRE(applied.last == smoothlife::Log::Message::smooth_and_shiny);
+}
+
+TEST_CASE("The rules of the game are constexpr", "[rules]")
 {
-  return number <= 1 ? number : Factorial(number - 1) * number;
+  using smoothlife::GameStage;
+  constexpr auto next = [](GameStage stage) { return ++stage; };
+  STATIC_REQUIRE(next(GameStage::tutorial_2) == GameStage::game);
+  STATIC_REQUIRE(next(GameStage::ending) == GameStage::ending);
+
+  STATIC_REQUIRE(smoothlife::rules::exit_score(2, 3, 40) == 5 * (smoothlife::config::player_energy - 40));
+  STATIC_REQUIRE(smoothlife::rules::energy_gain(0) == 0);
+  STATIC_REQUIRE(smoothlife::rules::energy_gain(1) == smoothlife::config::ok_energy_gain);
+  STATIC_REQUIRE(smoothlife::rules::energy_gain(7) == smoothlife::config::master_energy_gain);
+  STATIC_REQUIRE(smoothlife::rules::exit_message(0) == smoothlife::Log::Message::failed);
+  STATIC_REQUIRE(smoothlife::rules::exit_message(2) == smoothlife::Log::Message::fine_polish);
+  STATIC_REQUIRE(smoothlife::rules::chain_length(0, 35) == smoothlife::config::chain_length);
+  STATIC_REQUIRE(smoothlife::rules::chain_length(1000, 35) == 33);
+
+  // draws stay in their range and hit both ends
+  constexpr auto draws_in_range = [] {
+    smoothlife::Pcg32 prng{ 3 };
+    bool low = false;
+    bool high = false;
+    for (int i = 0; i < 1000; ++i) {
+      const int value = smoothlife::uniform_int(prng, -2, 6);
+      if (value < -2 || value > 6) { return false; }
+      low = low || value == -2;
+      high = high || value == 6;
+    }
+    return low && high;
+  }();
+  STATIC_REQUIRE(draws_in_range);
 }
 
-TEST_CASE("Factorials are computed with constexpr", "[factorial]")
+TEST_CASE("Levels are generated and verified with constexpr", "[builtin_levels]")
 {
-  STATIC_REQUIRE(Factorial(1) == 1);
-  STATIC_REQUIRE(Factorial(2) == 2);
-  STATIC_REQUIRE(Factorial(3) == 6);
-  STATIC_REQUIRE(Factorial(10) == 3628800);
+  using Grid = smoothlife::FixedGrid<4, 3>;
+  // a level of a small board generated by another engine holds the exit and its chain
+  constexpr auto level = [] {
+    smoothlife::Xoshiro256 prng{ 11 };
+    Grid grid;
+    const long surface = smoothlife::rules::generate_level<smoothlife::config::base>(
+      grid, 2, [&prng](auto lo, auto hi) { return smoothlife::uniform_int(prng, lo, hi); });
+    return std::pair{ grid, surface };
+  }();
+  constexpr auto operations = [&] {
+    std::size_t count = 0;
+    level.first.for_each_field([&](int /*x*/, int /*y*/, const smoothlife::Field &field) {
+      if (field.type != smoothlife::Field::Type::exit) { ++count; }
+    });
+    return count;
+  }();
+  STATIC_REQUIRE(level.first.get(3, 2).type == smoothlife::Field::Type::exit);
+  STATIC_REQUIRE(level.first.get(0, 0).type == smoothlife::Field::Type::empty);
+  STATIC_REQUIRE(operations == smoothlife::rules::chain_length(2, Grid::size()));
+  STATIC_REQUIRE(smoothlife::roundness(level.second) == 0);
+
+  constexpr auto record = smoothlife::builtin_record<5, 4>(42, 3);
+  STATIC_REQUIRE(smoothlife::verify_level(record));
+  STATIC_REQUIRE(record.level == 3);
+  STATIC_REQUIRE(smoothlife::builtin_record<5, 4>(42, 3).surface == record.surface);
+  STATIC_REQUIRE(smoothlife::builtin_record<5, 4>(42, 2).surface != record.surface);
+
+  constexpr auto tampered = [](auto broken) {
+    broken.surface *= smoothlife::config::base;
+    return smoothlife::verify_level(broken);
+  };
+  STATIC_REQUIRE_FALSE(tampered(record));
+
+  STATIC_REQUIRE(smoothlife::levels_verified<smoothlife::tutorial_levels>());
+  STATIC_REQUIRE(smoothlife::levels_verified<smoothlife::daily_levels>());
+  STATIC_REQUIRE(smoothlife::tutorial_levels.find(smoothlife::tutorial_levels.first_seed, 1) != nullptr);
+  STATIC_REQUIRE(smoothlife::tutorial_levels.find(smoothlife::tutorial_levels.first_seed, 2) == nullptr);
+  STATIC_REQUIRE(smoothlife::daily_levels.find(smoothlife::daily_levels.first_seed + 7, 0) == nullptr);
+}
+
+TEST_CASE("Packed grids are queried with constexpr", "[packed_grid]")
+{
+  using smoothlife::Field;
+  STATIC_REQUIRE(smoothlife::pack_field({ Field::Type::div, 9 }) == 0x59);
+  STATIC_REQUIRE(smoothlife::pack_field({ Field::Type::empty, 3 }) == 0);
+  STATIC_REQUIRE(smoothlife::unpack_field(0x3f) == Field{ Field::Type::sub, 15 });
+
+  // a board of 5x3 cells with the exit and two operations, nine bytes across two words
+  constexpr auto grid = [] {
+    smoothlife::PackedGrid<5, 3> packed;
+    packed.set(4, 2, { Field::Type::exit });
+    packed.set(1, 0, { Field::Type::add, 3 });
+    packed.set(3, 2, { Field::Type::mul, 2 });
+    return packed;
+  }();
+  STATIC_REQUIRE(grid.get(3, 2) == Field{ Field::Type::mul, 2 });
+  STATIC_REQUIRE(grid.count(Field::Type::empty) == 12);
+  STATIC_REQUIRE(grid.count(Field::Type::exit) == 1);
+  STATIC_REQUIRE(grid.operations()[0] == ((1U << 1U) | (1U << 13U)));
+  STATIC_REQUIRE(grid.nearest(4, 2, grid.operations()) == 13);
+  STATIC_REQUIRE(grid.nearest(0, 0, grid.operations()) == 1);
+  STATIC_REQUIRE(grid.checksum() != smoothlife::PackedGrid<5, 3>{}.checksum());
 }
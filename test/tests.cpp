@@ -1,5 +1,53 @@
 #include <catch2/catch.hpp>
 
+#include <bots.hpp>
+#include <bounded_queue.hpp>
+#include <builtin_levels.hpp>
+#include <calibration.hpp>
+#include <gameboard.hpp>
+#include <hints.hpp>
+#include <history.hpp>
+#include <level_pack.hpp>
+#include <lockfree_queue.hpp>
+#include <mapped_file.hpp>
+#include <prefetch.hpp>
+#include <protocol.hpp>
+#include <random.hpp>
+#include <replay.hpp>
+#include <ui.hpp>
+#include <simulation.hpp>
+#include <snapshot.hpp>
+#include <solver.hpp>
+#include <telemetry.hpp>
+#include <thread_pool.hpp>
+#include <timer_wheel.hpp>
+#include <trace.hpp>
+#include <util.hpp>
+#include <vector_env.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <server.hpp>
+#endif
+
 unsigned int Factorial(unsigned int number)// NOLINT(misc-no-recursion)
 {
   return number <= 1 ? number : Factorial(number - 1) * number;
@@ -12,3 +60,1728 @@ TEST_CASE("Factorials are computed", "[factorial]")
   REQUIRE(Factorial(3) == 6);
   REQUIRE(Factorial(10) == 3628800);
 }
+
+// the digit by digit definition, with a divisor that cannot overflow
+template<long Base> int reference_roundness(long number)
+{
+  if (number == 0) { return 1; }
+  int zeros = 0;
+  while (number % Base == 0) {
+    number /= Base;
+    ++zeros;
+  }
+  return zeros;
+}
+
+template<int Base> void check_roundness()
+{
+  std::mt19937_64 rnd{ Base };
+  std::vector<long> numbers{
+    0, 1, -1, Base, -Base, std::numeric_limits<long>::max(), std::numeric_limits<long>::min()
+  };
+  for (long power = Base; power <= std::numeric_limits<long>::max() / Base; power *= Base) {
+    numbers.push_back(power);
+    numbers.push_back(-power);
+    numbers.push_back(power + 1);
+  }
+  for (int i = 0; i < 10000; ++i) {
+    auto number = static_cast<long>(rnd() >> 1);
+    for (auto zeros = rnd() % 8; zeros > 0 && number <= std::numeric_limits<long>::max() / Base; --zeros) {
+      number *= Base;
+    }
+    numbers.push_back(i % 2 == 0 ? number : -number);
+  }
+
+  std::vector<int> batch(numbers.size());
+  smoothlife::roundness<Base>(numbers, batch);
+  for (std::size_t i = 0; i < numbers.size(); ++i) {
+    INFO(numbers[i]);
+    REQUIRE(smoothlife::roundness<Base>(numbers[i]) == reference_roundness<Base>(numbers[i]));
+    REQUIRE(batch[i] == reference_roundness<Base>(numbers[i]));
+  }
+}
+
+TEST_CASE("Roundness matches the digit by digit definition", "[roundness]")
+{
+  check_roundness<10>();
+  check_roundness<2>();
+  check_roundness<3>();
+  check_roundness<12>();
+  check_roundness<16>();
+
+  REQUIRE(smoothlife::roundness(std::numeric_limits<long>::min()) == 0);
+
+  std::vector<int> too_short(1);
+  REQUIRE_THROWS_AS(smoothlife::roundness(std::vector<long>{ 10, 20 }, too_short), std::out_of_range);
+}
+
+TEST_CASE("Surfaces widen instead of overflowing", "[surface]")
+{
+  using Representation = smoothlife::Surface::Representation;
+  constexpr long max = std::numeric_limits<long>::max();
+
+  smoothlife::Surface surface = max;
+  surface += 1;
+  REQUIRE(surface.representation() == Representation::wide);
+  // a power of two
+  REQUIRE(smoothlife::roundness(surface) == 0);
+  surface -= 1;
+  REQUIRE(surface.representation() == Representation::small);
+  REQUIRE(surface == smoothlife::Surface{ max });
+
+  // 7 * 10^540, far beyond any builtin type
+  smoothlife::Surface big = 7;
+  for (int i = 0; i < 60; ++i) { big *= 1'000'000'000; }
+  REQUIRE(big.representation() == Representation::big);
+  REQUIRE(smoothlife::roundness(big) == 540);
+  REQUIRE(big.to_string() == "7" + std::string(540, '0'));
+  REQUIRE_THROWS_AS(big.to_long(), std::overflow_error);
+
+  // division truncates towards zero like the builtin one
+  smoothlife::Surface negative = big;
+  negative *= -1;
+  negative -= 5;
+  negative /= 10;
+  REQUIRE(negative.to_string() == "-7" + std::string(539, '0'));
+  big += 5;
+  REQUIRE(smoothlife::roundness(big) == 0);
+  big /= 10;
+  negative *= -1;
+  REQUIRE(big == negative);
+
+  // the way back ends in the long again
+  for (int i = 0; i < 60; ++i) { big /= 1'000'000'000; }
+  REQUIRE(big.representation() == Representation::small);
+  REQUIRE(big.to_long() == 0);
+
+  smoothlife::Surface huge = 1;
+  REQUIRE_THROWS_AS([&] {
+    for (int i = 0; i < 100; ++i) { huge *= 1 << 30; }
+  }(),
+    std::overflow_error);
+  REQUIRE_THROWS_AS(huge /= 0, std::domain_error);
+
+  // fields apply to surfaces like to longs
+  smoothlife::Field field{ smoothlife::Field::mul, 9 };
+  smoothlife::Surface applied = max;
+  field.apply(applied);
+  REQUIRE(field.type == smoothlife::Field::empty);
+  REQUIRE(applied.representation() == Representation::wide);
+  smoothlife::Field{ smoothlife::Field::div, 9 }.apply(applied);
+  REQUIRE(applied == smoothlife::Surface{ max });
+}
+
+TEST_CASE("Player moves inside its bounds and pays energy", "[player]")
+{
+  using smoothlife::Direction;
+  smoothlife::Player player;
+  player.bounds = { 0, 1, 0, 1 };
+  int interactions = 0;
+  player.interaction = [&] { ++interactions; };
+
+  REQUIRE_FALSE(player.move(Direction::left));
+  REQUIRE_FALSE(player.move(Direction::down));
+  REQUIRE(player.move(Direction::up));
+  REQUIRE(player.move(Direction::right));
+  REQUIRE_FALSE(player.move(Direction::right));
+  REQUIRE(player.x == 1);
+  REQUIRE(player.y == 1);
+  REQUIRE(player.energy == smoothlife::config::player_energy - 2);
+  REQUIRE(interactions == 2);
+
+  player.energy = 0;
+  REQUIRE_FALSE(player.move(Direction::down));
+}
+
+TEST_CASE("Headless games are reproducible by seed", "[simulation]")
+{
+  smoothlife::Simulator<smoothlife::bots::GreedyBot> first;
+  smoothlife::Simulator<smoothlife::bots::GreedyBot> second;
+
+  for (std::uint64_t seed = 0; seed < 20; ++seed) {
+    const auto a = first.play(seed);
+    const auto b = second.play(seed);
+    REQUIRE(a.score == b.score);
+    REQUIRE(a.level == b.level);
+    REQUIRE(a.moves == b.moves);
+    REQUIRE(first.game().stage != smoothlife::GameStage::game);
+  }
+}
+
+TEST_CASE("Parallel simulation matches a sequential run", "[simulation]")
+{
+  static constexpr std::uint64_t games = 3000;
+
+  smoothlife::ThreadPool pool{ 4 };
+  const auto parallel = smoothlife::simulate<smoothlife::bots::RandomBot>(pool, games, 7);
+
+  smoothlife::SimulationStats sequential;
+  smoothlife::Simulator<smoothlife::bots::RandomBot> simulator;
+  for (std::uint64_t game = 0; game < games; ++game) { sequential.add(simulator.play(7 + game)); }
+
+  REQUIRE(parallel.games == games);
+  REQUIRE(parallel.moves == sequential.moves);
+  REQUIRE(parallel.histogram == sequential.histogram);
+  REQUIRE(parallel.max_score == sequential.max_score);
+}
+
+TEST_CASE("Thread pools hand the failure of a task to wait", "[simulation]")
+{
+  smoothlife::ThreadPool pool{ 2 };
+  std::atomic<int> ran = 0;
+  for (int i = 0; i < 20; ++i) {
+    pool.submit([&ran, i] {
+      ++ran;
+      if (i % 7 == 3) { throw std::runtime_error("task failed"); }
+    });
+  }
+  REQUIRE_THROWS_AS(pool.wait(), std::runtime_error);
+  // the workers go on, the failure is only reported once
+  REQUIRE(ran == 20);
+  pool.submit([&ran] { ++ran; });
+  pool.wait();
+  REQUIRE(ran == 21);
+}
+
+TEST_CASE("Generated levels are rough and fill at most the whole board", "[generator]")
+{
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  std::ranlux24 prng;
+  smoothlife::GameBoard<4, 3, std::ranlux24> board{ prng, player, log };
+
+  for (int level : { 0, 6, 18, 1000 }) {
+    const auto chain = std::min(smoothlife::config::chain_length + level / 2, 4 * 3 - 2);
+    for (unsigned seed = 0; seed < 200; ++seed) {
+      prng.seed(seed);
+      board.level = level;
+      board.generate_level();
+
+      REQUIRE(smoothlife::roundness(player.surface) == 0);
+      REQUIRE(player.x == 0);
+      REQUIRE(player.y == 0);
+      REQUIRE(board.get_field(0, 0).type == smoothlife::Field::empty);
+      REQUIRE(board.get_field(3, 2).type == smoothlife::Field::exit);
+
+      const auto operations = std::count_if(board.state.begin(), board.state.end(), [](const smoothlife::Field &f) {
+        return f.type != smoothlife::Field::empty && f.type != smoothlife::Field::exit;
+      });
+      REQUIRE(operations == chain);
+    }
+  }
+}
+
+TEST_CASE("Every base generates rough levels of its own digits", "[generator]")
+{
+  for (const int base : smoothlife::config::bases) {
+    smoothlife::with_base(base, [](auto b) {
+      constexpr int Base = decltype(b)::value;
+      smoothlife::Player player;
+      smoothlife::Log log{ smoothlife::config::log_length };
+      std::ranlux24 prng;
+      smoothlife::GameBoard<4, 3, std::ranlux24, Base> board{ prng, player, log };
+
+      for (unsigned seed = 0; seed < 200; ++seed) {
+        prng.seed(seed);
+        board.level = static_cast<int>(seed % 10);
+        board.generate_level();
+        INFO(Base);
+        REQUIRE(smoothlife::roundness<Base>(player.surface) == 0);
+        board.for_each_field([&](int, int, const smoothlife::Field &field) {
+          REQUIRE(field.value >= 0);
+          REQUIRE(field.value < Base);
+        });
+      }
+    });
+  }
+
+  REQUIRE_THROWS_AS(smoothlife::with_base(7, [](auto) {}), std::invalid_argument);
+
+  smoothlife::Surface surface = -0x1f00;
+  REQUIRE(surface.to_string(16) == "-1f00");
+  REQUIRE(surface.to_string(2) == "-1111100000000");
+  REQUIRE_THROWS_AS(surface.to_string(17), std::invalid_argument);
+}
+
+TEST_CASE("Chunked grids only keep the tiles holding fields", "[grid]")
+{
+  smoothlife::ChunkedGrid grid{ 1000, 300 };
+  REQUIRE(grid.allocated_tiles() == 0);
+  REQUIRE(grid.get(999, 299).type == smoothlife::Field::empty);
+  REQUIRE_THROWS_AS(grid.get(1000, 0), std::out_of_range);
+  REQUIRE_THROWS_AS(smoothlife::ChunkedGrid(0, 5), std::invalid_argument);
+
+  grid.set(3, 4, { smoothlife::Field::add, 2 });
+  grid.set(5, 4, { smoothlife::Field::sub, 3 });
+  grid.set(999, 299, { smoothlife::Field::exit });
+  grid.set(500, 100, {});
+  REQUIRE(grid.allocated_tiles() == 2);
+  REQUIRE(grid.get(5, 4) == smoothlife::Field{ smoothlife::Field::sub, 3 });
+
+  std::vector<std::pair<int, int>> visited;
+  grid.for_each_field([&](int x, int y, const smoothlife::Field &) { visited.emplace_back(x, y); });
+  std::sort(visited.begin(), visited.end());
+  REQUIRE(visited == std::vector<std::pair<int, int>>{ { 3, 4 }, { 5, 4 }, { 999, 299 } });
+
+  // emptying the last field of a tile releases it
+  grid.set(3, 4, {});
+  REQUIRE(grid.allocated_tiles() == 2);
+  grid.set(5, 4, {});
+  REQUIRE(grid.allocated_tiles() == 1);
+  REQUIRE(grid.get(999, 299).type == smoothlife::Field::exit);
+
+  grid.clear();
+  REQUIRE(grid.allocated_tiles() == 0);
+  REQUIRE(grid.get(999, 299).type == smoothlife::Field::empty);
+}
+
+TEST_CASE("Packed grids hold the levels and answer queries like a scan", "[packed_grid]")
+{
+  using smoothlife::Field;
+  // more cells than a mask word and a last word of padding
+  static constexpr std::size_t width = 9;
+  static constexpr std::size_t height = 8;
+
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  std::ranlux24 prng;
+  smoothlife::GameBoard<width, height, std::ranlux24> board{ prng, player, log };
+  smoothlife::Player packed_player;
+  std::ranlux24 packed_prng;
+  smoothlife::PackedGameBoard<width, height, std::ranlux24> packed{ packed_prng, packed_player, log };
+  auto &grid = packed.state;
+
+  for (int level : { 0, 10, 40, 200 }) {
+    for (unsigned seed = 0; seed < 50; ++seed) {
+      prng.seed(seed);
+      packed_prng.seed(seed);
+      board.level = level;
+      packed.level = level;
+      board.generate_level();
+      packed.generate_level();
+      REQUIRE(packed_player.surface == player.surface);
+      for (std::size_t i = 0; i < grid.size(); ++i) { REQUIRE(grid[i] == board.state[i]); }
+
+      for (const auto type : { Field::empty, Field::add, Field::sub, Field::mul, Field::div, Field::exit }) {
+        const auto cells = grid.cells_of(type);
+        for (std::size_t i = 0; i < grid.size(); ++i) {
+          REQUIRE(((cells[i / 64] >> (i % 64)) & 1U) == (board.state[i].type == type ? 1U : 0U));
+        }
+        const auto count = std::count_if(
+          board.state.begin(), board.state.end(), [type](const Field &f) { return f.type == type; });
+        REQUIRE(grid.count(type) == static_cast<std::size_t>(count));
+      }
+      // the nearest operation of a scan from a few cells, the first one of a tie
+      const auto operations = grid.operations();
+      std::size_t operation_count = 0;
+      grid.for_each_cell(operations, [&](std::size_t) { ++operation_count; });
+      REQUIRE(grid.count(Field::empty) + grid.count(Field::exit) + operation_count == grid.size());
+      for (const auto &[x, y] : { std::pair{ 0, 0 }, std::pair{ 4, 3 }, std::pair{ 8, 7 }, std::pair{ 8, 0 } }) {
+        std::size_t nearest = grid.size();
+        int best = std::numeric_limits<int>::max();
+        for (std::size_t i = 0; i < grid.size(); ++i) {
+          const Field::Type type = board.state[i].type;
+          if (type == Field::empty || type == Field::exit) { continue; }
+          const int steps = std::abs(static_cast<int>(i % width) - x) + std::abs(static_cast<int>(i / width) - y);
+          if (steps < best) {
+            best = steps;
+            nearest = i;
+          }
+        }
+        REQUIRE(grid.nearest(x, y, operations) == nearest);
+      }
+    }
+  }
+
+  // equal fields hash equal, one changed field does not
+  const auto checksum = grid.checksum();
+  const Field last = grid.get(8, 7);
+  grid.set(8, 7, {});
+  REQUIRE(grid.checksum() != checksum);
+  REQUIRE(grid.nearest(0, 0, grid.cells_of(Field::exit)) == grid.size());
+  grid.set(8, 7, last);
+  REQUIRE(grid.checksum() == checksum);
+
+  REQUIRE_THROWS_AS(grid.set(0, 0, { Field::add, 16 }), std::out_of_range);
+  REQUIRE_THROWS_AS(grid.get(9, 0), std::out_of_range);
+  REQUIRE_THROWS_AS((smoothlife::PackedGrid<width, height>{ width, 3 }), std::invalid_argument);
+  // 72 fields in 9 words
+  REQUIRE(sizeof(grid) == 72);
+}
+
+TEST_CASE("Packed boards play and solve the games of the game board", "[packed_grid]")
+{
+  using Packed =
+    smoothlife::PackedGameBoard<smoothlife::config::board_width, smoothlife::config::board_height, std::ranlux24>;
+  smoothlife::Simulator<smoothlife::bots::GreedyBot> game;
+  smoothlife::Simulator<smoothlife::bots::GreedyBot, std::ranlux24, Packed> packed;
+
+  for (std::uint64_t seed = 0; seed < 30; ++seed) {
+    const auto a = game.play(seed);
+    const auto b = packed.play(seed);
+    REQUIRE(a.score == b.score);
+    REQUIRE(a.level == b.level);
+    REQUIRE(a.moves == b.moves);
+  }
+
+  smoothlife::SimulationOptions options;
+  options.record = "replays";
+  REQUIRE_THROWS_AS(
+    (smoothlife::Simulator<smoothlife::bots::GreedyBot, std::ranlux24, Packed>{ {}, options }), std::invalid_argument);
+
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  std::ranlux24 prng;
+  Packed board{ prng, player, log };
+  smoothlife::Player fixed_player;
+  std::ranlux24 fixed_prng;
+  smoothlife::GameBoard<smoothlife::config::board_width, smoothlife::config::board_height, std::ranlux24> fixed{
+    fixed_prng, fixed_player, log
+  };
+  for (unsigned seed = 0; seed < 10; ++seed) {
+    prng.seed(seed);
+    fixed_prng.seed(seed);
+    board.level = 4;
+    fixed.level = 4;
+    board.generate_level();
+    fixed.generate_level();
+    const auto solution = smoothlife::solve(board);
+    REQUIRE(solution.solved == smoothlife::solve(fixed).solved);
+    REQUIRE(solution.score == smoothlife::solve(fixed).score);
+  }
+}
+
+TEST_CASE("Huge sparse boards generate levels in little memory", "[generator]")
+{
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  std::ranlux24 prng{ 3 };
+  smoothlife::SparseGameBoard<std::ranlux24> board{ prng, player, log, 10000, 10000 };
+
+  for (int level : { 0, 40 }) {
+    board.level = level;
+    board.generate_level();
+    const auto chain = smoothlife::config::chain_length + level / 2;
+
+    REQUIRE(smoothlife::roundness(player.surface) == 0);
+    REQUIRE(board.get_field(9999, 9999).type == smoothlife::Field::exit);
+    int operations = 0;
+    board.for_each_field([&](int, int, const smoothlife::Field &f) {
+      if (f.type != smoothlife::Field::exit) { ++operations; }
+    });
+    REQUIRE(operations == chain);
+    REQUIRE(board.state.allocated_tiles() <= static_cast<std::size_t>(chain) + 1);
+    REQUIRE(board.state.memory() < 4U * 1024U * 1024U);
+  }
+
+  REQUIRE_THROWS_AS(smoothlife::SparseGameBoard<std::ranlux24>(prng, player, log, 1, 2).generate_level(),
+    std::invalid_argument);
+}
+
+TEST_CASE("Vector environments play the games of the board", "[vector_env]")
+{
+  using smoothlife::config::board_width;
+  using smoothlife::config::board_height;
+  static constexpr std::size_t games = 64;
+  smoothlife::EnvOptions options;
+  options.first_seed = 5;
+  options.max_moves = 300;
+  smoothlife::VectorEnv<> env{ games, options };
+  smoothlife::ThreadPool pool{ 3 };
+
+  // a board per game following the same moves, restarted like Simulator::play when its game ends
+  struct Reference
+  {
+    smoothlife::Player player;
+    smoothlife::Log log{ smoothlife::config::log_length };
+    smoothlife::Xoshiro256 prng;
+    smoothlife::GameBoard<board_width, board_height, smoothlife::Xoshiro256> board{ prng, player, log };
+  };
+  std::vector<std::unique_ptr<Reference>> references;
+  const auto start = [](Reference &ref, std::uint64_t seed) {
+    smoothlife::seed_prng(ref.prng, seed);
+    ref.player.reset();
+    ref.board.level = 0;
+    ref.board.stage = smoothlife::GameStage::game;
+    ref.board.next_level();
+  };
+  for (std::size_t i = 0; i < games; ++i) {
+    references.push_back(std::make_unique<Reference>());
+    start(*references.back(), env.seeds()[i]);
+  }
+
+  std::minstd_rand rnd{ 9 };
+  std::vector<std::uint8_t> actions(games);
+  int finished = 0;
+  for (int step = 0; step < 2000; ++step) {
+    for (auto &action : actions) { action = static_cast<std::uint8_t>(rnd() % 4); }
+    env.step(actions, step % 2 == 0 ? &pool : nullptr);
+
+    for (std::size_t i = 0; i < games; ++i) {
+      Reference &ref = *references[i];
+      const int score = ref.player.score;
+      ref.player.move(static_cast<smoothlife::Direction>(actions[i]));
+      INFO("game " << i << " step " << step);
+      REQUIRE(env.rewards()[i] == static_cast<float>(ref.player.score - score));
+
+      const bool over = ref.board.stage != smoothlife::GameStage::game;
+      if (env.dones()[i] == smoothlife::EnvStatus::game_over) { REQUIRE(over); }
+      if (env.dones()[i] != smoothlife::EnvStatus::running) {
+        ++finished;
+        start(ref, env.seeds()[i]);
+        continue;
+      }
+      REQUIRE_FALSE(over);
+      REQUIRE(env.x()[i] == ref.player.x);
+      REQUIRE(env.y()[i] == ref.player.y);
+      REQUIRE(env.surfaces()[i] == ref.player.surface.to_long());
+      REQUIRE(env.energy()[i] == ref.player.energy);
+      REQUIRE(env.lives()[i] == ref.player.lives);
+      REQUIRE(env.scores()[i] == ref.player.score);
+      REQUIRE(env.levels()[i] == ref.board.level);
+      REQUIRE(env.steps()[i] == ref.player.steps);
+      for (std::size_t cell = 0; cell < env.cells; ++cell) {
+        REQUIRE(env.observations()[i * env.cells + cell] == smoothlife::pack_field(ref.board.state[cell]));
+      }
+    }
+  }
+  REQUIRE(finished > static_cast<int>(games));
+
+  REQUIRE_THROWS_AS(env.step(std::vector<std::uint8_t>(games - 1)), std::invalid_argument);
+  REQUIRE_THROWS_AS(env.step(std::vector<std::uint8_t>(games, 4)), std::out_of_range);
+  REQUIRE_THROWS_AS(smoothlife::VectorEnv<>{ 0 }, std::invalid_argument);
+}
+
+TEST_CASE("Prefetched levels are the levels the board builds", "[prefetch]")
+{
+  const auto play_both = [](auto &plain, auto &prefetched, smoothlife::Player &a, smoothlife::Player &b) {
+    using Board = std::remove_reference_t<decltype(prefetched)>;
+    plain.stage = smoothlife::GameStage::game;
+    prefetched.stage = smoothlife::GameStage::game;
+    plain.next_level();
+    prefetched.next_level();
+    smoothlife::LevelPrefetcher<Board> prefetcher{ prefetched };
+
+    std::minstd_rand rnd{ 3 };
+    int exits = 0;
+    for (int move = 0; move < 3000 && plain.stage == smoothlife::GameStage::game; ++move) {
+      // most levels are ready by the exit, some are still being built or not started yet
+      if (move % 4 != 0) { prefetcher.wait(); }
+      const auto dir = smoothlife::bots::GreedyBot{}(plain, rnd);
+      const int level = plain.level;
+      const int steps = a.steps;
+      REQUIRE(a.move(dir) == b.move(dir));
+      if (plain.level != level || a.steps < steps) { ++exits; }
+      // kept alive, so the game lasts for many exits
+      a.energy = std::max(a.energy, 20);
+      b.energy = a.energy;
+      a.lives = std::max(a.lives, 2);
+      b.lives = a.lives;
+
+      REQUIRE(prefetched.stage == plain.stage);
+      REQUIRE(b.score == a.score);
+      REQUIRE(prefetched.level == plain.level);
+      REQUIRE(b.surface == a.surface);
+      REQUIRE(prefetched.rnd == plain.rnd);
+      for (int y = 0; y < static_cast<int>(plain.height()); ++y) {
+        for (int x = 0; x < static_cast<int>(plain.width()); ++x) {
+          REQUIRE(prefetched.get_field(x, y) == plain.get_field(x, y));
+        }
+      }
+    }
+    const auto stats = prefetcher.stats();
+    REQUIRE(exits > 20);
+    REQUIRE(stats.hits + stats.misses >= static_cast<std::uint64_t>(exits));
+    REQUIRE(stats.hits > stats.misses);
+  };
+
+  smoothlife::Log log{ smoothlife::config::log_length };
+  {
+    smoothlife::Player a;
+    smoothlife::Player b;
+    std::ranlux24 prng_a{ 8 };
+    std::ranlux24 prng_b{ 8 };
+    smoothlife::GameBoard<smoothlife::config::board_width, smoothlife::config::board_height, std::ranlux24> plain{
+      prng_a, a, log
+    };
+    smoothlife::GameBoard<smoothlife::config::board_width, smoothlife::config::board_height, std::ranlux24> prefetched{
+      prng_b, b, log
+    };
+    play_both(plain, prefetched, a, b);
+    REQUIRE_FALSE(prefetched.level_source);
+  }
+  {
+    smoothlife::Player a;
+    smoothlife::Player b;
+    smoothlife::Xoshiro256 prng_a{ 8 };
+    smoothlife::Xoshiro256 prng_b{ 8 };
+    smoothlife::SparseGameBoard<smoothlife::Xoshiro256> plain{ prng_a, a, log, 40, 30 };
+    smoothlife::SparseGameBoard<smoothlife::Xoshiro256> prefetched{ prng_b, b, log, 40, 30 };
+    play_both(plain, prefetched, a, b);
+  }
+}
+
+TEST_CASE("Level packs hand out the generated levels", "[level_pack]")
+{
+  using Board = smoothlife::GameBoard<5, 4, std::ranlux24>;
+  const auto path = std::filesystem::temp_directory_path() / "smoothlife_tests.pack";
+
+  smoothlife::ThreadPool pool{ 3 };
+  smoothlife::write_level_pack<5, 4>(path, pool, 100, 600, 2, 5);
+
+  {
+    const smoothlife::LevelPack pack{ path };
+    REQUIRE(pack.holds<5, 4>());
+    REQUIRE_FALSE(pack.holds<7, 5>());
+    REQUIRE(pack.find<5, 4>(99, 2) == nullptr);
+    REQUIRE(pack.find<5, 4>(700, 2) == nullptr);
+    REQUIRE(pack.find<5, 4>(100, 1) == nullptr);
+    REQUIRE(pack.find<5, 4>(100, 7) == nullptr);
+    REQUIRE(pack.find<5, 4>(100, std::numeric_limits<int>::min()) == nullptr);
+
+    smoothlife::Player player;
+    smoothlife::Log log{ smoothlife::config::log_length };
+    std::ranlux24 prng;
+    Board generated{ prng, player, log };
+    Board loaded{ prng, player, log };
+
+    for (std::uint64_t seed : { 100U, 371U, 699U }) {
+      for (int level = 2; level < 7; ++level) {
+        const auto *record = pack.find<5, 4>(seed, level);
+        REQUIRE(record != nullptr);
+        REQUIRE(record->seed == seed);
+
+        smoothlife::generate_record(generated, seed, level);
+        const smoothlife::Surface surface = player.surface;
+        smoothlife::load_record(loaded, *record);
+        REQUIRE(player.surface == surface);
+        REQUIRE(loaded.level == level);
+        for (std::size_t i = 0; i < generated.state.size(); ++i) {
+          REQUIRE(loaded.state[i].type == generated.state[i].type);
+          REQUIRE(loaded.state[i].value == generated.state[i].value);
+        }
+      }
+    }
+
+    // records are checked like snapshots before they reach the board
+    auto corrupt = *pack.find<5, 4>(100, 2);
+    const auto operation = std::find_if(corrupt.fields.begin(), corrupt.fields.end(), [](const auto &field) {
+      return field.type >= static_cast<std::uint8_t>(smoothlife::Field::Type::add);
+    });
+    REQUIRE(operation != corrupt.fields.end());
+    operation->value = 0;
+    REQUIRE_THROWS_AS(smoothlife::load_record(loaded, corrupt), std::runtime_error);
+    operation->value = 1;
+    operation->type = 6;
+    REQUIRE_THROWS_AS(smoothlife::load_record(loaded, corrupt), std::runtime_error);
+    operation->type = static_cast<std::uint8_t>(smoothlife::Field::Type::exit);
+    REQUIRE_THROWS_AS(smoothlife::load_record(loaded, corrupt), std::runtime_error);
+
+    // reaching a level loads it, levels beyond the pack are generated
+    smoothlife::use_level_pack(loaded, pack, 371);
+    loaded.level = 3;
+    loaded.next_level();
+    REQUIRE(player.surface.to_long() == pack.find<5, 4>(371, 3)->surface);
+    loaded.level = 9;
+    loaded.next_level();
+    REQUIRE(loaded.level == 9);
+  }
+
+  // the pack is unmapped by now, windows does not let anyone write to a mapped file
+  {
+    std::ofstream corrupt{ path, std::ios::binary | std::ios::in | std::ios::out };
+    corrupt.write("NOTAPACK", 8);
+  }
+  REQUIRE_THROWS_AS(smoothlife::LevelPack{ path }, std::runtime_error);
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Built-in levels are winnable and replay like generated ones", "[builtin_levels]")
+{
+  using Board = smoothlife::GameBoard<smoothlife::config::board_width, smoothlife::config::board_height, std::ranlux24>;
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  std::ranlux24 prng;
+  Board board{ prng, player, log };
+
+  // the compile time check agrees with the exact solver on generated levels
+  for (int level = 0; level < 4; ++level) {
+    for (std::uint64_t seed = 0; seed < 100; ++seed) {
+      const auto record = smoothlife::generate_record(board, seed, level);
+      player.reset();
+      REQUIRE(smoothlife::verify_level(record) == smoothlife::solve(board).solved);
+    }
+  }
+
+  auto broken = smoothlife::daily_levels.records[0];
+  REQUIRE(smoothlife::verify_level(broken));
+  broken.surface = 1000;
+  REQUIRE_FALSE(smoothlife::verify_level(broken));
+  broken = smoothlife::daily_levels.records[0];
+  broken.fields.back() = {};
+  REQUIRE_FALSE(smoothlife::verify_level(broken));
+
+  // every daily level is the record it was built from, the levels after them are generated
+  const std::uint64_t seed = smoothlife::daily_seed();
+  REQUIRE(smoothlife::daily_levels.find(seed, 0) != nullptr);
+  smoothlife::use_builtin_levels(board, smoothlife::daily_levels, seed);
+  for (int level = 0; level < 4; ++level) {
+    const auto &record = *smoothlife::daily_levels.find(seed, level);
+    board.level = level;
+    board.next_level();
+    REQUIRE(player.surface.to_long() == record.surface);
+    for (std::size_t i = 0; i < board.state.size(); ++i) {
+      REQUIRE(static_cast<int>(board.state[i].type) == record.fields[i].type);
+      REQUIRE(board.state[i].value == record.fields[i].value);
+    }
+  }
+  REQUIRE(smoothlife::daily_levels.find(seed, 4) == nullptr);
+
+  // a game through the tutorial levels replays with them
+  const auto path = std::filesystem::temp_directory_path() / "smoothlife_tests_tutorial.replay";
+  prng.seed(7);
+  player.reset();
+  smoothlife::use_builtin_levels(board, smoothlife::tutorial_levels, smoothlife::tutorial_levels.first_seed);
+  board.level = 0;
+  board.stage = smoothlife::GameStage::game;
+  board.next_level();
+  REQUIRE(player.surface.to_long() == smoothlife::tutorial_levels.records[0].surface);
+
+  // the same moves without the flag replay on generated levels
+  smoothlife::ReplayRecorder recording{ 7, smoothlife::ReplayHeader::skip_tutorial };
+  smoothlife::ReplayRecorder tutorial{ 7,
+    smoothlife::ReplayHeader::skip_tutorial | smoothlife::ReplayHeader::tutorial_levels };
+  for (int level = 0; level < 2; ++level) {
+    const auto solution = smoothlife::solve(board);
+    REQUIRE(solution.solved);
+    for (auto dir : solution.path) {
+      REQUIRE(player.move(dir));
+      recording.record(smoothlife::replay_event(dir));
+      tutorial.record(smoothlife::replay_event(dir));
+    }
+  }
+  REQUIRE(board.level == 2);
+
+  smoothlife::Replayer replayer;
+  for (const auto &[replay, valid] : { std::pair{ &tutorial, true }, std::pair{ &recording, false } }) {
+    replay->save(path, player.score, board.level);
+    std::vector<std::byte> bytes;
+    {
+      const smoothlife::MappedFile file{ path };
+      bytes.assign(file.bytes().begin(), file.bytes().end());
+    }
+    REQUIRE(replayer.run(smoothlife::parse_replay(bytes)).valid == valid);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Replays of recorded games verify and catch tampering", "[replay]")
+{
+  const auto directory = std::filesystem::temp_directory_path() / "smoothlife_tests_replays";
+  std::filesystem::create_directories(directory);
+
+  smoothlife::SimulationOptions options;
+  options.tick_every = 3;
+  options.record = directory;
+  smoothlife::Simulator<smoothlife::bots::GreedyBot> simulator{ {}, options };
+
+  smoothlife::Replayer replayer;
+  for (std::uint64_t seed = 0; seed < 30; ++seed) {
+    const auto played = simulator.play(seed);
+
+    std::vector<std::byte> bytes;
+    {
+      const smoothlife::MappedFile file{ directory / fmt::format("{}.replay", seed) };
+      bytes.assign(file.bytes().begin(), file.bytes().end());
+    }
+    auto replay = smoothlife::parse_replay(bytes);
+    auto result = replayer.run(replay);
+    REQUIRE(result.valid);
+    REQUIRE(result.score == played.score);
+    REQUIRE(result.level == played.level);
+    REQUIRE(result.moves == static_cast<std::uint64_t>(played.moves));
+
+    replay.header.score += 10;
+    REQUIRE_FALSE(replayer.run(replay).valid);
+    replay.header.score -= 10;
+
+    // the player starts in a corner, moving out of the board is impossible
+    bytes.back() = std::byte{ static_cast<std::uint8_t>(smoothlife::ReplayEvent::advance) + 1 };
+    REQUIRE_FALSE(replayer.run(smoothlife::parse_replay(bytes)).valid);
+    bytes[sizeof(smoothlife::ReplayHeader)] = std::byte{ static_cast<std::uint8_t>(smoothlife::ReplayEvent::down) };
+    REQUIRE_FALSE(replayer.run(smoothlife::parse_replay(bytes)).valid);
+  }
+
+  REQUIRE_THROWS_AS(smoothlife::parse_replay(std::vector<std::byte>(10)), std::runtime_error);
+  std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("Optimal paths replay to the predicted score", "[solver]")
+{
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  std::ranlux24 prng;
+  smoothlife::GameBoard<smoothlife::config::board_width, smoothlife::config::board_height, std::ranlux24> board{
+    prng, player, log
+  };
+
+  for (int level : { 0, 4, 8 }) {
+    for (unsigned seed = 0; seed < 10; ++seed) {
+      prng.seed(seed);
+      player.reset();
+      board.level = level;
+      board.stage = smoothlife::GameStage::game;
+      board.generate_level();
+
+      const auto solution = smoothlife::solve(board);
+      if (!solution.solved) { continue; }
+
+      const int score = player.score;
+      for (auto dir : solution.path) { REQUIRE(player.move(dir)); }
+      REQUIRE(player.score - score == solution.score);
+      REQUIRE(board.level == level + 1);
+    }
+  }
+}
+
+TEST_CASE("Parallel solving finds the same optimum", "[solver]")
+{
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  std::ranlux24 prng{ 3 };
+  smoothlife::GameBoard<16, 16, std::ranlux24> board{ prng, player, log };
+  board.level = 20;
+  board.generate_level();
+
+  smoothlife::ThreadPool pool{ 4 };
+  const auto sequential = smoothlife::solve(board);
+  const auto parallel = smoothlife::solve(board, &pool);
+  REQUIRE(sequential.solved == parallel.solved);
+  REQUIRE(sequential.score == parallel.score);
+  REQUIRE(sequential.steps == parallel.steps);
+}
+
+TEST_CASE("Solving improves step by step and stops on request", "[solver]")
+{
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  std::ranlux24 prng{ 3 };
+  smoothlife::GameBoard<16, 16, std::ranlux24> board{ prng, player, log };
+  board.level = 20;
+  board.generate_level();
+
+  std::vector<smoothlife::Solution> found;
+  smoothlife::Solver solver{ smoothlife::Solver::capture(board) };
+  const auto solution = solver.solve(nullptr, { nullptr, [&](const auto &better) { found.push_back(better); } });
+  REQUIRE(solution.solved);
+  REQUIRE(!found.empty());
+  for (std::size_t i = 1; i < found.size(); ++i) { REQUIRE(found[i].score > found[i - 1].score); }
+  REQUIRE(found.back().score == solution.score);
+  REQUIRE(found.back().path == solution.path);
+
+  const std::atomic<bool> stop = true;
+  const auto stopped = solver.solve(nullptr, { &stop, {} });
+  REQUIRE(!stopped.solved);
+  REQUIRE(solver.states_explored() == 1);
+}
+
+TEST_CASE("Hints suggest the first move of an optimal path", "[hints]")
+{
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  std::ranlux24 prng{ 5 };
+  smoothlife::GameBoard<smoothlife::config::board_width, smoothlife::config::board_height, std::ranlux24> board{
+    prng, player, log
+  };
+  board.stage = smoothlife::GameStage::game;
+  board.level = 4;
+  board.generate_level();
+
+  std::mutex mutex;
+  std::condition_variable published;
+  smoothlife::HintEngine hints{ [&] {
+    const std::scoped_lock lock{ mutex };
+    published.notify_all();
+  } };
+  const auto wait_for_search = [&] {
+    std::unique_lock lock{ mutex };
+    REQUIRE(published.wait_for(lock, std::chrono::seconds{ 10 }, [&] {
+      const auto status = hints.hint().status;
+      return status == smoothlife::Hint::Status::optimal || status == smoothlife::Hint::Status::none;
+    }));
+    return hints.hint();
+  };
+
+  // follow the hints through the level, every one is the next move of a fresh optimal path
+  const int level = board.level;
+  for (int moves = 0; board.level == level && moves < smoothlife::config::player_energy; ++moves) {
+    const auto solution = smoothlife::solve(board);
+    const auto revision = hints.update(board);
+    const auto hint = wait_for_search();
+    REQUIRE(hint.revision == revision);
+    if (!solution.solved) {
+      REQUIRE(hint.status == smoothlife::Hint::Status::none);
+      break;
+    }
+    REQUIRE(hint.status == smoothlife::Hint::Status::optimal);
+    REQUIRE(hint.direction() == solution.path.front());
+    REQUIRE(player.move(hint.direction()));
+  }
+  REQUIRE(board.level == level + 1);
+
+  // a newer position replaces the hint of the old one right away
+  const auto revision = hints.update(board);
+  REQUIRE(hints.hint().revision == revision);
+}
+
+TEST_CASE("Bounded queues hand items over in order until closed", "[calibration]")
+{
+  smoothlife::BoundedQueue<int> queue{ 2 };
+  // catch assertions are only made on the test's thread
+  std::atomic<int> pushed = 0;
+  std::jthread producer{ [&] {
+    for (int i = 0; i < 100 && queue.push(i); ++i) { ++pushed; }
+    queue.close();
+  } };
+
+  for (int expected = 0; expected < 100; ++expected) { REQUIRE(queue.pop() == expected); }
+  REQUIRE(!queue.pop());
+  REQUIRE(pushed == 100);
+  REQUIRE(!queue.push(100));
+  REQUIRE_THROWS_AS(smoothlife::BoundedQueue<int>{ 0 }, std::invalid_argument);
+}
+
+TEST_CASE("Calibration keeps the first levels inside the band", "[calibration]")
+{
+  static constexpr std::size_t width = smoothlife::config::board_width;
+  static constexpr std::size_t height = smoothlife::config::board_height;
+
+  for (int level : { 0, 6 }) {
+    const auto band = smoothlife::DifficultyBand::for_level<width, height>(level);
+    const auto calibration = smoothlife::calibrate_levels(level, 20, 1, 3);
+    REQUIRE(calibration.levels.size() == 20);
+
+    // the same levels a sequential filter over the seeds finds
+    smoothlife::Player player;
+    smoothlife::Log log{ smoothlife::config::log_length };
+    std::ranlux24 prng;
+    smoothlife::GameBoard<width, height, std::ranlux24> board{ prng, player, log };
+    std::size_t accepted = 0;
+    for (std::uint64_t seed = 1; seed < 1 + calibration.candidates; ++seed) {
+      player.reset();
+      const auto record = smoothlife::generate_record(board, seed, level);
+      const auto difficulty = smoothlife::evaluate_difficulty(smoothlife::Solver::capture(board));
+      if (!band.contains(difficulty)) { continue; }
+
+      const auto &calibrated = calibration.levels.at(accepted++);
+      REQUIRE(calibrated.record.seed == record.seed);
+      REQUIRE(calibrated.difficulty.steps == difficulty.steps);
+      REQUIRE(calibrated.difficulty.ways == difficulty.ways);
+    }
+    REQUIRE(accepted == calibration.levels.size());
+  }
+
+  // nothing is that easy, the search gives up after the candidates
+  smoothlife::DifficultyBand impossible;
+  impossible.max_steps = 1;
+  const auto none = smoothlife::calibrate_levels<width, height>(0, 5, 1, 50, impossible, 2);
+  REQUIRE(none.levels.empty());
+  REQUIRE(none.candidates == 50);
+}
+
+TEST_CASE("Winning ways are counted up to the limit", "[solver]")
+{
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  std::ranlux24 prng{ 7 };
+  smoothlife::GameBoard<smoothlife::config::board_width, smoothlife::config::board_height, std::ranlux24> board{
+    prng, player, log
+  };
+  board.generate_level();
+
+  smoothlife::Solver solver{ smoothlife::Solver::capture(board) };
+  const std::size_t all = solver.winning_ways(1000);
+  REQUIRE(all >= 1);
+  REQUIRE(solver.winning_ways(1) == 1);
+  REQUIRE(solver.winning_ways(all) == all);
+  // counting leaves the optimum untouched
+  REQUIRE(solver.solve().score == smoothlife::solve(board).score);
+
+  player.energy = 1;
+  REQUIRE(smoothlife::Solver{ smoothlife::Solver::capture(board) }.winning_ways(1000) == 0);
+}
+
+TEST_CASE("Traces hold the spans of every thread", "[trace]")
+{
+  namespace trace = smoothlife::trace;
+  const std::size_t before = trace::recorded();
+  { const trace::Span ignored{ "off" }; }
+  REQUIRE(trace::recorded() == before);
+
+  // more spans than fit into one chunk of a buffer
+  static constexpr std::size_t spans = 5000;
+  trace::start();
+  trace::name_thread("test");
+  for (std::size_t i = 0; i < spans; ++i) {
+    const trace::Span outer{ "outer" };
+    const trace::Span inner{ "inner" };
+  }
+  std::jthread{ [] {
+    trace::name_thread("worker");
+    const trace::Span span{ "worker span" };
+  } }.join();
+  trace::stop();
+  REQUIRE(trace::recorded() == before + 2 * spans + 1);
+
+  const auto path = std::filesystem::temp_directory_path() / "smoothlife_tests_trace.json";
+  trace::write(path);
+  std::ifstream in{ path };
+  std::ostringstream text;
+  text << in.rdbuf();
+  const std::string json = text.str();
+  const auto count = [&](const std::string &needle) {
+    std::size_t found = 0;
+    for (auto at = json.find(needle); at != std::string::npos; at = json.find(needle, at + 1)) { ++found; }
+    return found;
+  };
+  REQUIRE(json.starts_with(R"({"displayTimeUnit":"ms","traceEvents":[)"));
+  REQUIRE(json.ends_with("]}\n"));
+  REQUIRE(count(R"("ph":"X")") == before + 2 * spans + 1);
+  REQUIRE(count(R"("name":"inner")") == spans);
+  REQUIRE(count(R"("name":"worker span")") == 1);
+  REQUIRE(count(R"("args":{"name":"worker"})") == 1);
+  REQUIRE(count(R"("args":{"name":"test"})") == 1);
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Lock-free queues hand every item over exactly once", "[telemetry]")
+{
+  smoothlife::LockFreeQueue<int> queue{ 3 };
+  REQUIRE(queue.capacity() == 4);
+  REQUIRE_THROWS_AS(smoothlife::LockFreeQueue<int>{ 0 }, std::invalid_argument);
+  for (int i = 0; i < 4; ++i) { REQUIRE(queue.try_push(i)); }
+  REQUIRE(!queue.try_push(4));
+  for (int i = 0; i < 4; ++i) { REQUIRE(queue.try_pop() == i); }
+  REQUIRE(!queue.try_pop());
+
+  static constexpr int producers = 4;
+  static constexpr int items = 20000;
+  std::vector<int> seen(producers * items);
+  {
+    std::vector<std::jthread> threads;
+    for (int producer = 0; producer < producers; ++producer) {
+      threads.emplace_back([&, producer] {
+        for (int i = 0; i < items; ++i) {
+          while (!queue.try_push(producer * items + i)) { std::this_thread::yield(); }
+        }
+      });
+    }
+    for (int popped = 0; popped < producers * items;) {
+      if (const auto item = queue.try_pop()) {
+        ++seen.at(static_cast<std::size_t>(*item));
+        ++popped;
+      }
+    }
+  }
+  REQUIRE(std::all_of(seen.begin(), seen.end(), [](int count) { return count == 1; }));
+}
+
+TEST_CASE("Telemetry records every session, level and move", "[telemetry]")
+{
+  const std::vector<std::int64_t> values{ 0, -1, 1, 5, std::numeric_limits<std::int64_t>::min(),
+    std::numeric_limits<std::int64_t>::max(), 3, 3, -700 };
+  std::vector<std::uint8_t> encoded;
+  smoothlife::detail::encode_column(values, encoded);
+  std::vector<std::int64_t> decoded;
+  smoothlife::detail::decode_column(encoded, values.size(), decoded);
+  REQUIRE(decoded == values);
+  REQUIRE_THROWS_AS(smoothlife::detail::decode_column(encoded, values.size() + 1, decoded), std::runtime_error);
+  // a corrupt row count must not allocate
+  REQUIRE_THROWS_AS(smoothlife::detail::decode_column(encoded, std::size_t{ 1 } << 60U, decoded), std::runtime_error);
+
+  static constexpr std::uint64_t games = 300;
+  const auto path = std::filesystem::temp_directory_path() / "smoothlife_tests.telemetry";
+  std::filesystem::remove(path);
+
+  smoothlife::SimulationStats stats;
+  {
+    // small blocks and a small queue, games on several threads fill both
+    smoothlife::TelemetryWriter writer{ path, 64, 256 };
+    smoothlife::SimulationOptions options;
+    options.tick_every = 3;
+    options.telemetry = &writer;
+    smoothlife::ThreadPool pool{ 4 };
+    stats = smoothlife::simulate<smoothlife::bots::GreedyBot>(pool, games, 11, {}, options);
+    writer.finish();
+  }
+
+  const auto summarize = [&] {
+    const smoothlife::MappedFile file{ path };
+    const auto view = smoothlife::parse_telemetry(file.bytes());
+    REQUIRE(!view.truncated);
+    smoothlife::TelemetrySummary summary;
+    std::vector<std::int64_t> field;
+    std::vector<std::int64_t> before;
+    std::vector<std::int64_t> after;
+    for (const auto &block : view.blocks) {
+      summary.add(block);
+      if (block.table != smoothlife::TelemetryTable::moves) { continue; }
+      // only operations change the surface
+      block.decode(smoothlife::MoveColumns::field, field);
+      block.decode(smoothlife::MoveColumns::before, before);
+      block.decode(smoothlife::MoveColumns::after, after);
+      for (std::size_t row = 0; row < block.rows; ++row) {
+        const bool operation = field[row] > static_cast<std::int64_t>(smoothlife::Field::Type::exit);
+        if (!operation) { REQUIRE(before[row] == after[row]); }
+      }
+    }
+    return summary;
+  };
+
+  auto summary = summarize();
+  REQUIRE(summary.sessions == games);
+  REQUIRE(static_cast<std::uint64_t>(summary.session_moves) == stats.moves);
+  // the move of a game out of energy ends it without entering the field
+  REQUIRE(summary.moves <= stats.moves);
+  REQUIRE(summary.moves + games >= stats.moves);
+  REQUIRE(static_cast<double>(summary.score) == stats.score_sum);
+  std::uint64_t finished = 0;
+  std::int64_t level_score = 0;
+  for (const auto &level : summary.per_level) {
+    finished += level.played - level.failed;
+    level_score += level.score;
+  }
+  REQUIRE(finished == stats.levels);
+  REQUIRE(level_score == summary.score);
+
+  // a second session appends to the file
+  {
+    smoothlife::TelemetryWriter writer{ path };
+    smoothlife::SimulationOptions options;
+    options.telemetry = &writer;
+    smoothlife::Simulator<smoothlife::bots::GreedyBot> simulator{ {}, options };
+    simulator.play(1);
+  }
+  summary = summarize();
+  REQUIRE(summary.sessions == games + 1);
+
+  // a write cut off by a crash loses its last block only
+  const auto size = std::filesystem::file_size(path);
+  std::filesystem::resize_file(path, size - 3);
+  {
+    const smoothlife::MappedFile file{ path };
+    const auto view = smoothlife::parse_telemetry(file.bytes());
+    REQUIRE(view.truncated);
+    REQUIRE(!view.blocks.empty());
+  }
+  // and appending to it again drops the part of the block that is left
+  {
+    smoothlife::TelemetryWriter writer{ path };
+    smoothlife::SimulationOptions options;
+    options.telemetry = &writer;
+    smoothlife::Simulator<smoothlife::bots::GreedyBot> simulator{ {}, options };
+    simulator.play(1);
+  }
+  summary = summarize();
+  // the block cut off held moves, written after the sessions
+  REQUIRE(summary.sessions == games + 2);
+  std::filesystem::resize_file(path, 10);
+  REQUIRE_THROWS_AS(smoothlife::TelemetryWriter{ path }, std::runtime_error);
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Snapshots resume a game exactly where it was", "[snapshot]")
+{
+  using Board = smoothlife::GameBoard<smoothlife::config::board_width, smoothlife::config::board_height, std::ranlux24>;
+  struct Game
+  {
+    smoothlife::Player player;
+    smoothlife::Log log{ smoothlife::config::log_length };
+    std::ranlux24 prng;
+    Board board{ prng, player, log };
+  };
+  const auto play = [](Game &game, std::minstd_rand &bot_rnd, int moves) {
+    for (int i = 0; i < moves && game.board.stage == smoothlife::GameStage::game; ++i) {
+      if (!game.player.move(smoothlife::bots::GreedyBot{}(game.board, bot_rnd))) { break; }
+    }
+  };
+
+  Game saved;
+  saved.prng.seed(5);
+  saved.board.next_level();
+  saved.board.stage = smoothlife::GameStage::game;
+  std::minstd_rand bot_rnd{ 3 };
+  play(saved, bot_rnd, 40);
+  const auto snapshot = smoothlife::save_snapshot(saved.board);
+
+  Game resumed;
+  resumed.board.next_level();
+  smoothlife::load_snapshot(resumed.board, snapshot);
+  REQUIRE(smoothlife::save_snapshot(resumed.board) == snapshot);
+  REQUIRE(resumed.player.surface == saved.player.surface);
+  REQUIRE(resumed.log.size() == saved.log.size());
+  REQUIRE(resumed.log[0].text() == saved.log[0].text());
+
+  // the random engine goes on with the same levels
+  std::minstd_rand resumed_bot_rnd = bot_rnd;
+  play(saved, bot_rnd, 200);
+  play(resumed, resumed_bot_rnd, 200);
+  REQUIRE(resumed.board.level == saved.board.level);
+  REQUIRE(resumed.player.score == saved.player.score);
+  REQUIRE(smoothlife::save_snapshot(resumed.board) == smoothlife::save_snapshot(saved.board));
+
+  // surfaces in every representation
+  for (int i = 0; i < 40; ++i) {
+    saved.player.surface *= -999999;
+    const auto wide = smoothlife::save_snapshot(saved.board);
+    smoothlife::load_snapshot(resumed.board, wide);
+    REQUIRE(resumed.player.surface == saved.player.surface);
+  }
+
+  // a rejected snapshot leaves the game as it was
+  const auto before = smoothlife::save_snapshot(resumed.board);
+  auto corrupt = snapshot;
+  corrupt.resize(corrupt.size() - 1);
+  REQUIRE_THROWS_AS(smoothlife::load_snapshot(resumed.board, corrupt), std::runtime_error);
+  corrupt = snapshot;
+  corrupt[sizeof(smoothlife::SnapshotHeader)] = std::byte{ 0xff };
+  REQUIRE_THROWS_AS(smoothlife::load_snapshot(resumed.board, corrupt), std::runtime_error);
+  // well formed snapshots of games the rules never make
+  const auto played = smoothlife::save_snapshot(saved.board);
+  const auto tampered = [&](const auto &change) {
+    change(saved.board);
+    auto bytes = smoothlife::save_snapshot(saved.board);
+    smoothlife::load_snapshot(saved.board, played);
+    return bytes;
+  };
+  constexpr int last_x = smoothlife::config::board_width - 1;
+  constexpr int last_y = smoothlife::config::board_height - 1;
+  const std::vector<std::vector<std::byte>> impossible{
+    tampered([](Board &b) { b.set_field(1, 0, { smoothlife::Field::Type::div, 0 }); }),
+    tampered([](Board &b) { b.set_field(1, 0, { smoothlife::Field::Type::add, smoothlife::config::base }); }),
+    tampered([](Board &b) { b.set_field(last_x, last_y, {}); }),
+    tampered([](Board &b) { b.set_field(1, 0, { smoothlife::Field::Type::exit }); }),
+    tampered([](Board &b) { b.player.lives = smoothlife::config::player_lives + 1; }),
+    tampered([](Board &b) { b.player.lives = -1; }),
+  };
+  for (const auto &bytes : impossible) {
+    REQUIRE_THROWS_AS(smoothlife::load_snapshot(resumed.board, bytes), std::runtime_error);
+  }
+  REQUIRE(smoothlife::save_snapshot(saved.board) == played);
+  REQUIRE(smoothlife::save_snapshot(resumed.board) == before);
+
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  std::ranlux24 prng;
+  smoothlife::SparseGameBoard<std::ranlux24> sparse{ prng, player, log, 8, 5 };
+  REQUIRE_THROWS_AS(smoothlife::load_snapshot(sparse, snapshot), std::runtime_error);
+  smoothlife::GameBoard<smoothlife::config::board_width, smoothlife::config::board_height, std::ranlux24, 16> hex{
+    prng, player, log
+  };
+  REQUIRE_THROWS_AS(smoothlife::load_snapshot(hex, snapshot), std::runtime_error);
+
+  // the autosaver keeps the newest snapshot
+  const auto path = std::filesystem::temp_directory_path() / "smoothlife_tests.save";
+  {
+    smoothlife::Autosaver autosave{ path };
+    autosave.save(resumed.board);
+    autosave.save(saved.board);
+    autosave.flush();
+  }
+  {
+    const smoothlife::MappedFile file{ path };
+    smoothlife::load_snapshot(resumed.board, file.bytes());
+  }
+  REQUIRE(smoothlife::save_snapshot(resumed.board) == smoothlife::save_snapshot(saved.board));
+  std::filesystem::remove(path);
+}
+
+// a board with the player, log and engine it refers to
+template<class Board> struct HistoryGame
+{
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  typename Board::random_engine prng{ 5 };
+  Board board;
+
+  HistoryGame(std::size_t width, std::size_t height) : board{ prng, player, log, width, height }
+  {
+    board.next_level();
+    board.stage = smoothlife::GameStage::game;
+  }
+};
+
+// plays a game through a history, then goes back and forth in it, branches and searches from the positions
+template<class Board> void check_history(std::size_t width, std::size_t height)
+{
+  HistoryGame<Board> game{ width, height };
+  smoothlife::BoardHistory<Board> history{ game.board };
+  std::vector<std::vector<std::byte>> positions{ smoothlife::save_snapshot(game.board) };
+  std::minstd_rand bot_rnd{ 3 };
+  int exits = 0;
+  while (positions.size() < 300 && game.board.stage == smoothlife::GameStage::game) {
+    const int steps = game.player.steps;
+    REQUIRE(history.move(smoothlife::bots::GreedyBot{}(game.board, bot_rnd)));
+    if (game.player.steps < steps) { ++exits; }
+    // kept alive, so the game lasts for many exits
+    game.player.energy = std::max(game.player.energy, 20);
+    game.player.lives = std::max(game.player.lives, 2);
+    history.amend();
+    positions.push_back(smoothlife::save_snapshot(game.board));
+  }
+  REQUIRE(exits > 2);
+  REQUIRE(history.size() == positions.size());
+
+  // the revision of the log keeps going up, views made of the log before are outdated once it changes
+  const auto events = [&game] {
+    std::vector<std::string> texts;
+    for (std::size_t i = 0; i < game.log.size(); ++i) { texts.push_back(game.log[i].text()); }
+    return texts;
+  };
+  auto shown = events();
+  std::size_t revision = game.log.revision;
+  const auto check_log = [&] {
+    REQUIRE(game.log.revision >= revision);
+    if (events() != shown) { REQUIRE(game.log.revision > revision); }
+    shown = events();
+    revision = game.log.revision;
+  };
+  for (std::size_t v = positions.size() - 1; v > 0; --v) {
+    REQUIRE(history.undo());
+    REQUIRE(smoothlife::save_snapshot(game.board) == positions[v - 1]);
+    check_log();
+  }
+  REQUIRE_FALSE(history.undo());
+  for (std::size_t v = 1; v < positions.size(); ++v) {
+    REQUIRE(history.redo());
+    REQUIRE(smoothlife::save_snapshot(game.board) == positions[v]);
+    check_log();
+  }
+  REQUIRE_FALSE(history.redo());
+
+  std::minstd_rand pick{ 7 };
+  for (int i = 0; i < 100; ++i) {
+    const std::size_t v = pick() % positions.size();
+    history.checkout(v);
+    REQUIRE(smoothlife::save_snapshot(game.board) == positions[v]);
+  }
+  REQUIRE_THROWS_AS(history.checkout(positions.size()), std::out_of_range);
+
+  // branches from an old version keep the versions after it, redo follows the newest one
+  constexpr std::size_t fork = 100;
+  std::vector<std::pair<std::size_t, std::vector<std::byte>>> branches;
+  for (const smoothlife::Direction dir : smoothlife::bots::directions) {
+    history.checkout(fork);
+    check_log();
+    if (history.move(dir)) { branches.emplace_back(history.current(), smoothlife::save_snapshot(game.board)); }
+    check_log();
+  }
+  REQUIRE(branches.size() >= 2);
+  history.checkout(fork);
+  REQUIRE(history.redo());
+  REQUIRE(history.current() == branches.back().first);
+  for (const auto &[v, position] : branches) {
+    REQUIRE(history.parent(v) == fork);
+    history.checkout(v);
+    REQUIRE(smoothlife::save_snapshot(game.board) == position);
+  }
+  history.checkout(positions.size() - 1);
+  REQUIRE(smoothlife::save_snapshot(game.board) == positions.back());
+
+  // a search tries every way of three moves and comes back, each of them is the game a board would play
+  constexpr std::size_t start = 50;
+  history.checkout(start);
+  std::vector<smoothlife::Direction> way;
+  int leaves = 0;
+  const auto search = [&](const auto &self, int depth) -> void {
+    const std::size_t here = history.current();
+    for (const smoothlife::Direction dir : smoothlife::bots::directions) {
+      if (!history.move(dir)) { continue; }
+      way.push_back(dir);
+      if (depth > 1) {
+        self(self, depth - 1);
+      } else {
+        HistoryGame<Board> replayed{ width, height };
+        smoothlife::load_snapshot(replayed.board, positions[start]);
+        for (const smoothlife::Direction step : way) { replayed.player.move(step); }
+        REQUIRE(smoothlife::save_snapshot(game.board) == smoothlife::save_snapshot(replayed.board));
+        ++leaves;
+      }
+      way.pop_back();
+      history.rewind(here);
+    }
+  };
+  search(search, 3);
+  REQUIRE(leaves >= 8);
+  // along with the versions that were made after the start
+  REQUIRE(history.size() == start + 1);
+  REQUIRE(smoothlife::save_snapshot(game.board) == positions[start]);
+  history.checkout(0);
+  REQUIRE(smoothlife::save_snapshot(game.board) == positions[0]);
+}
+
+TEST_CASE("Board histories return to every position of a game", "[history]")
+{
+  using smoothlife::config::board_height;
+  using smoothlife::config::board_width;
+  check_history<smoothlife::GameBoard<board_width, board_height, std::ranlux24>>(board_width, board_height);
+  check_history<smoothlife::SparseGameBoard<smoothlife::Xoshiro256>>(40, 30);
+}
+
+TEST_CASE("Random engines draw their reference sequences", "[random]")
+{
+  // the test vectors of the reference implementations
+  smoothlife::Xoshiro256 xoshiro;
+  std::istringstream{ "xoshiro 1 2 3 4" } >> xoshiro;
+  const std::vector<std::uint64_t> xoshiro_draws{ xoshiro(), xoshiro(), xoshiro(), xoshiro() };
+  REQUIRE(xoshiro_draws == std::vector<std::uint64_t>{ 11520, 0, 1509978240, 1215971899390074240 });
+
+  smoothlife::Pcg32 pcg{ 42, 54 };
+  std::vector<std::uint32_t> pcg_draws(6);
+  for (auto &draw : pcg_draws) { draw = pcg(); }
+  REQUIRE(pcg_draws
+          == std::vector<std::uint32_t>{ 0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e });
+
+  using Block = std::array<std::uint32_t, 4>;
+  REQUIRE(smoothlife::Philox4x32::block({}, {}) == Block{ 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 });
+  REQUIRE(smoothlife::Philox4x32::block({ 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff })
+          == Block{ 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd });
+  REQUIRE(smoothlife::Philox4x32::block({ 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 })
+          == Block{ 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 });
+
+  // discarding lands where drawing does, and the text form resumes in the middle of a block
+  for (const unsigned long long skip : { 0ULL, 1ULL, 3ULL, 4ULL, 5ULL, 17ULL, 1000ULL }) {
+    smoothlife::Philox4x32 drawn{ 7 };
+    smoothlife::Philox4x32 skipped{ 7 };
+    drawn();
+    skipped();
+    for (unsigned long long i = 0; i < skip; ++i) { drawn(); }
+    skipped.discard(skip);
+    REQUIRE(skipped == drawn);
+    REQUIRE(skipped() == drawn());
+
+    std::stringstream text;
+    text << drawn;
+    smoothlife::Philox4x32 read;
+    text >> read;
+    REQUIRE(read == drawn);
+    REQUIRE(read() == drawn());
+  }
+
+  // streams of the same key start apart
+  smoothlife::Philox4x32 first{ 7 };
+  smoothlife::Philox4x32 second{ 7 };
+  second.seek(1);
+  REQUIRE(first() != second());
+
+  // no engine reads another one's state
+  std::stringstream text;
+  text << pcg;
+  smoothlife::Xoshiro256 other;
+  const smoothlife::Xoshiro256 untouched = other;
+  text >> other;
+  REQUIRE(text.fail());
+  REQUIRE(other == untouched);
+  REQUIRE_THROWS_AS(smoothlife::with_prng("mt19937", [](auto) {}), std::invalid_argument);
+}
+
+TEST_CASE("Games play alike on every random engine", "[random]")
+{
+  smoothlife::with_prng(GENERATE(from_range(smoothlife::prng_names)), [](auto engine) {
+    using Prng = typename decltype(engine)::type;
+    using Board = smoothlife::GameBoard<smoothlife::config::board_width, smoothlife::config::board_height, Prng>;
+    smoothlife::ThreadPool pool{ 2 };
+    const auto stats = smoothlife::simulate<smoothlife::bots::GreedyBot, Prng, Board>(pool, 200, 1);
+    smoothlife::Simulator<smoothlife::bots::GreedyBot, Prng, Board> simulator;
+    REQUIRE(simulator.play(7).score == simulator.play(7).score);
+    REQUIRE(stats.games == 200);
+    REQUIRE(stats.levels > 200);
+
+    // snapshots carry the engine along
+    smoothlife::Player player;
+    smoothlife::Log log{ smoothlife::config::log_length };
+    Prng prng;
+    Board board{ prng, player, log };
+    smoothlife::seed_prng(prng, 11);
+    board.next_level();
+    const auto snapshot = smoothlife::save_snapshot(board);
+    Prng resumed_prng;
+    Board resumed{ resumed_prng, player, log };
+    smoothlife::load_snapshot(resumed, snapshot);
+    REQUIRE(resumed_prng == prng);
+
+    std::ranlux24 ranlux;
+    smoothlife::GameBoard<smoothlife::config::board_width, smoothlife::config::board_height, std::ranlux24> other{
+      ranlux, player, log
+    };
+    if constexpr (std::is_same_v<Prng, std::ranlux24>) {
+      REQUIRE_NOTHROW(smoothlife::load_snapshot(other, snapshot));
+    } else {
+      REQUIRE_THROWS_AS(smoothlife::load_snapshot(other, snapshot), std::runtime_error);
+      smoothlife::SimulationOptions options;
+      options.record = std::filesystem::temp_directory_path();
+      const auto record = [&] {
+        return smoothlife::simulate<smoothlife::bots::GreedyBot, Prng, Board>(pool, 1, 1, {}, options);
+      };
+      REQUIRE_THROWS_AS(record(), std::invalid_argument);
+    }
+  });
+}
+
+TEST_CASE("Counter based levels do not depend on the levels before", "[random]")
+{
+  using Board = smoothlife::GameBoard<smoothlife::config::board_width,
+    smoothlife::config::board_height,
+    smoothlife::Philox4x32>;
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  smoothlife::Philox4x32 prng;
+  Board board{ prng, player, log };
+
+  const auto same = [](const auto &a, const auto &b) {
+    return a.surface == b.surface
+           && std::equal(a.fields.begin(), a.fields.end(), b.fields.begin(), [](auto x, auto y) {
+                return x.type == y.type && x.value == y.value;
+              });
+  };
+  const auto record = smoothlife::generate_record(board, 3, 12);
+  prng();
+  smoothlife::generate_record(board, 4, 5);
+  REQUIRE(same(smoothlife::generate_record(board, 3, 12), record));
+  REQUIRE_FALSE(same(smoothlife::generate_record(board, 3, 13), record));
+}
+
+TEST_CASE("Timer wheels fire every timer once it is due", "[server]")
+{
+  using namespace std::chrono_literals;
+  const auto origin = std::chrono::steady_clock::now();
+  smoothlife::TimerWheel<int> wheel{ 1ms, 8, origin };
+  std::vector<int> fired;
+  const auto record = [&](int id) { fired.push_back(id); };
+
+  wheel.schedule(1, 0ms);
+  wheel.schedule(2, 3ms);
+  // more than one lap ahead
+  wheel.schedule(3, 20ms);
+  REQUIRE(wheel.size() == 3);
+  REQUIRE(wheel.until_next(origin) == 1ms);
+
+  wheel.advance(origin + 2ms, record);
+  REQUIRE(fired == std::vector{ 1 });
+  wheel.advance(origin + 3ms, record);
+  REQUIRE(fired == std::vector{ 1, 2 });
+  wheel.advance(origin + 19ms, record);
+  REQUIRE(fired == std::vector{ 1, 2 });
+  wheel.advance(origin + 100ms, record);
+  REQUIRE(fired == std::vector{ 1, 2, 3 });
+  REQUIRE(wheel.size() == 0);
+  REQUIRE(wheel.until_next(origin + 100ms) == std::chrono::steady_clock::duration::max());
+
+  // a periodic timer that fell behind catches up on its own period
+  int periods = 0;
+  wheel.schedule(4, 5ms);
+  wheel.advance(origin + 150ms, [&](int id) {
+    ++periods;
+    wheel.schedule(id, 5ms);
+  });
+  REQUIRE(periods == 10);
+  REQUIRE(wheel.size() == 1);
+}
+
+TEST_CASE("Server games follow the rules of the game", "[server]")
+{
+  smoothlife::ServerGame game;
+  REQUIRE(game.handle({ smoothlife::ClientFrame::Type::move, 3, {}, 0 }).status
+          == smoothlife::ServerFrame::Status::no_game);
+
+  const smoothlife::ServerFrame started = game.handle({ smoothlife::ClientFrame::Type::start, 0, {}, 9 });
+  REQUIRE(started.status == smoothlife::ServerFrame::Status::ok);
+  REQUIRE(started.stage == static_cast<std::uint8_t>(smoothlife::GameStage::game));
+  REQUIRE(started.energy == smoothlife::config::player_energy);
+  REQUIRE(started.fields.back() == static_cast<std::uint8_t>(smoothlife::Field::Type::exit) * 16);
+  REQUIRE(game.handle({ smoothlife::ClientFrame::Type::move, 2, {}, 0 }).status
+          == smoothlife::ServerFrame::Status::rejected);
+  REQUIRE(game.handle({ smoothlife::ClientFrame::Type::move, 7, {}, 0 }).status
+          == smoothlife::ServerFrame::Status::rejected);
+  REQUIRE(game.handle({ static_cast<smoothlife::ClientFrame::Type>(99), 0, {}, 0 }).status
+          == smoothlife::ServerFrame::Status::unknown_request);
+
+  const smoothlife::ServerFrame moved = game.handle({ smoothlife::ClientFrame::Type::move, 3, {}, 0 });
+  REQUIRE(moved.x == 1);
+  REQUIRE(moved.energy == smoothlife::config::player_energy - 1);
+  game.tick();
+  REQUIRE(game.state().energy == smoothlife::config::player_energy - 2);
+
+  // the same seed starts the same level again
+  REQUIRE(game.handle({ smoothlife::ClientFrame::Type::start, 0, {}, 9 }) == started);
+}
+
+#ifdef __linux__
+TEST_CASE("The server plays a game for every connection", "[server]")
+{
+  using namespace std::chrono_literals;
+  const auto socket = std::filesystem::temp_directory_path() / "smoothlife_tests.sock";
+  std::minstd_rand rnd{ 4 };
+  const auto direction = [&](const smoothlife::ServerFrame &state) {
+    while (true) {
+      const auto dir = static_cast<smoothlife::Direction>(std::uniform_int_distribution<int>{ 0, 3 }(rnd));
+      const auto [x, y] = smoothlife::bots::step(state.x, state.y, dir);
+      if (x >= 0 && y >= 0 && x < static_cast<int>(smoothlife::config::board_width)
+          && y < static_cast<int>(smoothlife::config::board_height)) {
+        return dir;
+      }
+    }
+  };
+
+  {
+    smoothlife::GameServer server{ { socket, 2, 1h } };
+
+    // every connection plays the game a local one plays
+    std::vector<std::unique_ptr<smoothlife::GameClient>> clients;
+    for (int i = 0; i < 20; ++i) { clients.push_back(std::make_unique<smoothlife::GameClient>(socket)); }
+    REQUIRE(clients.front()->state().status == smoothlife::ServerFrame::Status::no_game);
+    std::uint64_t moves = 0;
+    for (std::size_t i = 0; i < clients.size(); ++i) {
+      smoothlife::ServerGame local;
+      smoothlife::ServerFrame state = clients[i]->start(i);
+      REQUIRE(state == local.handle({ smoothlife::ClientFrame::Type::start, 0, {}, i }));
+      for (int step = 0; step < 150 && state.stage == static_cast<std::uint8_t>(smoothlife::GameStage::game); ++step) {
+        const smoothlife::Direction dir = direction(state);
+        state = clients[i]->move(dir);
+        REQUIRE(state == local.handle({ smoothlife::ClientFrame::Type::move, static_cast<std::uint8_t>(dir), {}, 0 }));
+        if (state.status == smoothlife::ServerFrame::Status::ok) { ++moves; }
+      }
+    }
+
+    const smoothlife::ServerStatsFrame stats = clients.front()->stats();
+    REQUIRE(stats.type == smoothlife::ServerFrame::Type::stats);
+    REQUIRE(stats.sessions == clients.size());
+    REQUIRE(stats.games == clients.size());
+    REQUIRE(stats.moves == moves);
+    REQUIRE(stats.threads == 2);
+
+    clients.pop_back();
+    REQUIRE_NOTHROW(clients.front()->state());
+    server.stop();
+    REQUIRE_THROWS(clients.front()->state());
+  }
+  REQUIRE_FALSE(std::filesystem::exists(socket));
+  REQUIRE_THROWS_AS(smoothlife::GameClient{ socket }, std::system_error);
+
+  // a socket nobody listens on any more is taken over
+  {
+    const smoothlife::detail::FileDescriptor stale{ ::socket(AF_UNIX, SOCK_STREAM, 0) };
+    const sockaddr_un address = smoothlife::detail::unix_address(socket);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    REQUIRE(::bind(stale.get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0);
+  }
+  REQUIRE(std::filesystem::is_socket(socket));
+
+  // the timer wheel takes the energy of every game
+  smoothlife::GameServer server{ { socket, 1, 5ms } };
+  smoothlife::GameClient client{ socket };
+  // but not one a server still answers on
+  REQUIRE_THROWS_AS(smoothlife::GameServer({ socket, 1, 5ms }), std::runtime_error);
+  const int energy = client.start(1).energy;
+  std::this_thread::sleep_for(100ms);
+  const int left = client.state().energy;
+  REQUIRE(left < energy - 5);
+  REQUIRE(left >= energy - 100ms / 5ms - 2);
+}
+#endif
+
+TEST_CASE("BoardView rebuilds only the cells that changed", "[ui]")
+{
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  std::ranlux24 prng{ 7 };
+  smoothlife::GameBoard<5, 4, std::ranlux24> board{ prng, player, log };
+  board.generate_level();
+
+  smoothlife::BoardView view{ 5, 4 };
+  const auto first = view.render(board);
+  REQUIRE(view.rebuilt_cells() == 20);
+
+  // nothing changed, the same element is drawn again
+  REQUIRE(view.render(board) == first);
+  REQUIRE(view.rebuilt_cells() == 20);
+
+  // the cell the player left and the one it entered
+  player.x = 1;
+  const auto moved = view.render(board);
+  REQUIRE(moved != first);
+  REQUIRE(view.rebuilt_cells() == 22);
+
+  board.set_field(3, 2, { smoothlife::Field::exit });
+  REQUIRE(view.render(board) != moved);
+  REQUIRE(view.rebuilt_cells() == 23);
+}
+
+TEST_CASE("BoardView scrolls along with the player on large boards", "[ui]")
+{
+  smoothlife::Player player;
+  smoothlife::Log log{ smoothlife::config::log_length };
+  std::ranlux24 prng{ 11 };
+  smoothlife::SparseGameBoard<std::ranlux24> board{ prng, player, log, 500, 200 };
+  board.generate_level();
+
+  smoothlife::BoardView view{ 12, 7 };
+  const auto shows_player = [&] {
+    const auto &v = view.viewport();
+    return v.width == 12 && v.height == 7 && player.x >= v.x && player.x < v.x + v.width && player.y >= v.y
+           && player.y < v.y + v.height;
+  };
+
+  (void)view.render(board);
+  REQUIRE(shows_player());
+  REQUIRE(view.viewport().x == 0);
+  REQUIRE(view.viewport().y == 0);
+
+  for (const auto &[x, y] : { std::pair{ 9, 0 }, std::pair{ 60, 30 }, std::pair{ 499, 199 }, std::pair{ 250, 3 } }) {
+    player.x = x;
+    player.y = y;
+    (void)view.render(board);
+    REQUIRE(shows_player());
+  }
+
+  // the viewport stops at the edges of the board
+  player.x = 499;
+  player.y = 199;
+  (void)view.render(board);
+  REQUIRE(view.viewport().x == 488);
+  REQUIRE(view.viewport().y == 193);
+
+  // one step away from the edge keeps the view where it is
+  const auto rebuilt = view.rebuilt_cells();
+  player.x = 498;
+  (void)view.render(board);
+  REQUIRE(view.viewport().x == 488);
+  REQUIRE(view.rebuilt_cells() == rebuilt + 2);
+}
+
+TEST_CASE("Log keeps the newest events and formats them on demand", "[log]")
+{
+  smoothlife::Log log{ 3 };
+  REQUIRE(log.empty());
+
+  log.post_event(smoothlife::Log::Message::add_paste);
+  log.post_event(smoothlife::Log::Message::mess);
+  log.post_event(smoothlife::Log::Message::remove_burrs);
+  log.post_event(smoothlife::Log::Message::okay_polish, 120, 10);
+  REQUIRE(log.size() == 3);
+  REQUIRE(log.revision == 4);
+
+  REQUIRE(log[0].text() == "An okay polish. score +120, energy +10");
+  REQUIRE(log[0].type() == smoothlife::Log::neutral);
+  REQUIRE(log[1].text() == "Remove burrs.");
+  REQUIRE(log[2].text() == "Damn, what a mess!");
+  REQUIRE(log[2].type() == smoothlife::Log::bad);
+
+  log.clear();
+  REQUIRE(log.empty());
+  log.post_event(smoothlife::Log::Message::masterpiece, 900, 30);
+  REQUIRE(log.size() == 1);
+  REQUIRE(log[0].text() == "Truly a masterpiece *.* score +900, energy +30");
+
+  REQUIRE_THROWS_AS(smoothlife::Log{ smoothlife::Log::capacity + 1 }, std::invalid_argument);
+}